@@ -0,0 +1,854 @@
+//
+// Created by entropy2333 on 2021/3/30.
+//
+
+#include "naivejson.h"
+#include <algorithm>
+#include <chrono>
+#include <string>
+#include <vector>
+#include <cstdint>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/resource.h>
+#endif
+
+// allocation accounting: on glibc malloc and friends are wrapped, so every call the library makes is
+// counted together with the bytes it keeps alive. Elsewhere the counters stay at zero.
+static size_t bench_allocs = 0;
+static size_t bench_live = 0;
+static size_t bench_peak = 0;
+
+#if defined(__GLIBC__)
+#include <malloc.h>
+
+extern "C" {
+void* __libc_malloc(size_t size);
+void* __libc_calloc(size_t count, size_t size);
+void* __libc_realloc(void* p, size_t size);
+void* __libc_memalign(size_t alignment, size_t size);
+void __libc_free(void* p);
+
+static void* bench_track(void* p) {
+    if (p != nullptr) {
+        bench_allocs++;
+        bench_live += malloc_usable_size(p);
+        if (bench_live > bench_peak)
+            bench_peak = bench_live;
+    }
+    return p;
+}
+
+static void bench_untrack(void* p) {
+    if (p != nullptr) {
+        size_t size = malloc_usable_size(p);
+        bench_live -= size < bench_live ? size : bench_live;
+    }
+}
+
+void* malloc(size_t size) {
+    return bench_track(__libc_malloc(size));
+}
+
+void* calloc(size_t count, size_t size) {
+    return bench_track(__libc_calloc(count, size));
+}
+
+void* realloc(void* p, size_t size) {
+    bench_untrack(p);
+    return bench_track(__libc_realloc(p, size));
+}
+
+int posix_memalign(void** p, size_t alignment, size_t size) {
+    *p = bench_track(__libc_memalign(alignment, size));
+    return *p != nullptr ? 0 : ENOMEM;
+}
+
+void free(void* p) {
+    bench_untrack(p);
+    __libc_free(p);
+}
+}
+#endif
+
+static long peak_rss_kb() {
+#if defined(__unix__) || defined(__APPLE__)
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+#if defined(__APPLE__)
+    return usage.ru_maxrss / 1024;
+#else
+    return usage.ru_maxrss;
+#endif
+#else
+    return 0;
+#endif
+}
+
+// xorshift64*, the corpora must come out byte-identical on every run and platform
+static uint64_t bench_seed = 0x9E3779B97F4A7C15ULL;
+
+static uint64_t next_random() {
+    bench_seed ^= bench_seed >> 12;
+    bench_seed ^= bench_seed << 25;
+    bench_seed ^= bench_seed >> 27;
+    return bench_seed * 0x2545F4914F6CDD1DULL;
+}
+
+static uint64_t random_below(uint64_t n) {
+    return next_random() % n;
+}
+
+// a corpus is one text holding one or more documents (one per line for NDJSON)
+struct Corpus {
+    const char* name;
+    std::string text;
+    std::vector<size_t> begins, ends;
+};
+
+static void add_document(Corpus& corpus, const std::string& json) {
+    corpus.begins.push_back(corpus.text.size());
+    corpus.text += json;
+    corpus.ends.push_back(corpus.text.size());
+}
+
+static void append_indent(std::string& out, int indent, int depth) {
+    if (indent > 0) {
+        out += '\n';
+        out.append(static_cast<size_t>(indent * depth), ' ');
+    }
+}
+
+// the same records rendered minified (indent = 0) or pretty-printed with `indent` spaces per level
+static std::string generate_records(size_t count, int indent) {
+    std::string out;
+    const char* sep = indent > 0 ? ": " : ":";
+    out += '[';
+    for (size_t i = 0; i < count; i++) {
+        if (i > 0) out += ',';
+        append_indent(out, indent, 1);
+        out += '{';
+        append_indent(out, indent, 2);
+        out += "\"id\"" + std::string(sep) + std::to_string(i) + ",";
+        append_indent(out, indent, 2);
+        out += "\"name\"" + std::string(sep) + "\"user" + std::to_string(i) + "\",";
+        append_indent(out, indent, 2);
+        out += "\"active\"" + std::string(sep) + (i % 2 ? "true" : "false") + ",";
+        append_indent(out, indent, 2);
+        out += "\"tags\"" + std::string(sep) + "[";
+        append_indent(out, indent, 3);
+        out += "\"a\",";
+        append_indent(out, indent, 3);
+        out += "\"b\"";
+        append_indent(out, indent, 2);
+        out += "],";
+        append_indent(out, indent, 2);
+        out += "\"point\"" + std::string(sep) + "{";
+        append_indent(out, indent, 3);
+        out += "\"x\"" + std::string(sep) + "1.5,";
+        append_indent(out, indent, 3);
+        out += "\"y\"" + std::string(sep) + "-2";
+        append_indent(out, indent, 2);
+        out += '}';
+        append_indent(out, indent, 1);
+        out += '}';
+    }
+    append_indent(out, indent, 0);
+    out += ']';
+    return out;
+}
+
+// integers, short decimals and full-precision doubles in rows of 8
+static std::string generate_numbers(size_t count) {
+    std::string out = "[";
+    char buffer[32];
+    for (size_t i = 0; i < count; i++) {
+        if (i % 8 == 0)
+            out += i > 0 ? ",[" : "[";
+        else
+            out += ',';
+        switch (random_below(3)) {
+            case 0:
+                snprintf(buffer, sizeof(buffer), "%lld", static_cast<long long>(next_random() >> 20) - (1LL << 43));
+                break;
+            case 1:
+                snprintf(buffer, sizeof(buffer), "%.2f", static_cast<double>(random_below(100000000)) / 100.0);
+                break;
+            default:
+                snprintf(buffer, sizeof(buffer), "%.17g",
+                         static_cast<double>(next_random() >> 11) / 9007199254740992.0 * 1e6 - 5e5);
+                break;
+        }
+        out += buffer;
+        if (i % 8 == 7 || i + 1 == count)
+            out += ']';
+    }
+    out += ']';
+    return out;
+}
+
+// ids, nanosecond timestamps and counters in rows of 4, the integers doubles cannot hold exactly
+static std::string generate_integers(size_t count) {
+    std::string out = "[";
+    char buffer[96];
+    for (size_t i = 0; i < count; i++) {
+        if (i > 0) out += ',';
+        snprintf(buffer, sizeof(buffer), "[%llu,%llu,%llu,%lld]",
+                 static_cast<unsigned long long>(next_random()),
+                 static_cast<unsigned long long>(1700000000000000000ULL + random_below(100000000000000000ULL)),
+                 static_cast<unsigned long long>(random_below(100000)),
+                 -static_cast<long long>(random_below(1000)));
+        out += buffer;
+    }
+    out += ']';
+    return out;
+}
+
+// mostly plain text, with escapes and non-ASCII mixed in
+static std::string generate_strings(size_t count) {
+    static const char* const words[] = {
+            "lorem", "ipsum", "dolor", "sit", "amet", "consectetur", "adipiscing", "elit",
+            "\\\"quoted\\\"", "tab\\tseparated", "line\\nbreak", "caf\xC3\xA9", "\\u4f60\\u597d", "\xE2\x82\xAC"
+    };
+    std::string out = "[";
+    for (size_t i = 0; i < count; i++) {
+        if (i > 0) out += ',';
+        out += '"';
+        size_t length = 1 + random_below(40);
+        for (size_t j = 0; j < length; j++) {
+            if (j > 0) out += ' ';
+            out += words[random_below(j % 5 == 4 ? 14 : 8)];
+        }
+        out += '"';
+    }
+    out += ']';
+    return out;
+}
+
+// chains of alternating arrays and objects, `depth` levels each
+static std::string generate_nested(size_t count, size_t depth) {
+    std::string out = "[";
+    for (size_t i = 0; i < count; i++) {
+        if (i > 0) out += ',';
+        for (size_t d = 0; d < depth; d++)
+            out += d % 2 ? "{\"k\":" : "[";
+        out += std::to_string(i);
+        for (size_t d = depth; d-- > 0;)
+            out += d % 2 ? "}" : "]";
+    }
+    out += ']';
+    return out;
+}
+
+// a single object with `count` distinct keys
+static std::string generate_wide(size_t count) {
+    std::string out = "{";
+    for (size_t i = 0; i < count; i++) {
+        if (i > 0) out += ',';
+        out += "\"field_" + std::to_string(random_below(1000000)) + "_" + std::to_string(i) + "\":";
+        out += i % 3 ? std::to_string(i) : "\"value\"";
+    }
+    out += '}';
+    return out;
+}
+
+// one small event per line
+static void generate_ndjson(Corpus& corpus, size_t count) {
+    char latency[32];
+    for (size_t i = 0; i < count; i++) {
+        snprintf(latency, sizeof(latency), "%.3f", static_cast<double>(random_below(100000)) / 1000.0);
+        std::string line = "{\"seq\":" + std::to_string(i) + ",\"type\":\"" +
+                           (random_below(2) ? "click" : "view") + "\",\"user\":\"u" +
+                           std::to_string(random_below(10000)) + "\",\"latency\":" + latency +
+                           ",\"tags\":[\"x\",\"y\"]}";
+        add_document(corpus, line);
+        corpus.text += '\n';
+    }
+}
+
+struct Result {
+    const char* corpus;
+    const char* operation;
+    size_t bytes, documents, iterations;
+    double seconds;
+    size_t allocs, peak_heap;
+    long peak_rss;
+};
+
+typedef std::chrono::steady_clock bench_clock;
+
+static double elapsed(bench_clock::time_point start) {
+    return std::chrono::duration<double>(bench_clock::now() - start).count();
+}
+
+static void parse_corpus(const Corpus& corpus, std::vector<NaiveValue>& values, NaiveArena* arena) {
+    for (size_t i = 0; i < values.size(); i++) {
+        naive_init(&values[i]);
+        if (naive_parse_n(&values[i], corpus.text.data() + corpus.begins[i], corpus.ends[i] - corpus.begins[i],
+                          arena) != NAIVE_PARSE_OK) {
+            fprintf(stderr, "naivebench: %s does not parse\n", corpus.name);
+            exit(1);
+        }
+    }
+}
+
+static void free_corpus(std::vector<NaiveValue>& values) {
+    for (size_t i = 0; i < values.size(); i++)
+        naive_free(&values[i]);
+}
+
+static Result make_result(const Corpus& corpus, const char* operation, size_t iterations, double seconds,
+                          size_t allocs, size_t peak_heap) {
+    Result r;
+    r.corpus = corpus.name;
+    r.operation = operation;
+    r.bytes = corpus.text.size();
+    r.documents = corpus.begins.size();
+    r.iterations = iterations;
+    r.seconds = seconds;
+    r.allocs = iterations ? allocs / iterations : 0;
+    r.peak_heap = peak_heap;
+    r.peak_rss = peak_rss_kb();
+    return r;
+}
+
+// heap held by the operation at its highest point, on top of what was live before it started
+static size_t peak_since(size_t base_live) {
+    return bench_peak > base_live ? bench_peak - base_live : 0;
+}
+
+// parse and free are timed from the same loop, each on its own clock
+static void bench_parse_free(const Corpus& corpus, double min_seconds, std::vector<Result>& results) {
+    std::vector<NaiveValue> values(corpus.begins.size());
+    size_t base_live = bench_live, iterations = 0, parse_allocs = 0, free_allocs = 0;
+    double parse_seconds = 0.0, free_seconds = 0.0;
+    bench_peak = bench_live;
+    do {
+        size_t allocs = bench_allocs;
+        bench_clock::time_point start = bench_clock::now();
+        parse_corpus(corpus, values, nullptr);
+        parse_seconds += elapsed(start);
+        parse_allocs += bench_allocs - allocs;
+        allocs = bench_allocs;
+        start = bench_clock::now();
+        free_corpus(values);
+        free_seconds += elapsed(start);
+        free_allocs += bench_allocs - allocs;
+        iterations++;
+    } while (parse_seconds + free_seconds < min_seconds);
+    results.push_back(make_result(corpus, "parse", iterations, parse_seconds, parse_allocs, peak_since(base_live)));
+    results.push_back(make_result(corpus, "free", iterations, free_seconds, free_allocs, 0));
+}
+
+static void bench_parse_arena(const Corpus& corpus, double min_seconds, std::vector<Result>& results) {
+    std::vector<NaiveValue> values(corpus.begins.size());
+    NaiveArena arena;
+    naive_arena_init(&arena);
+    size_t base_live = bench_live, iterations = 0, allocs = bench_allocs;
+    bench_peak = bench_live;
+    bench_clock::time_point start = bench_clock::now();
+    do {
+        parse_corpus(corpus, values, &arena);
+        free_corpus(values);
+        naive_arena_reset(&arena);
+        iterations++;
+    } while (elapsed(start) < min_seconds);
+    double seconds = elapsed(start);
+    results.push_back(make_result(corpus, "parse_arena", iterations, seconds, bench_allocs - allocs,
+                                  peak_since(base_live)));
+    naive_arena_destroy(&arena);
+}
+
+static bool count_event(void* user) {
+    ++*static_cast<size_t*>(user);
+    return true;
+}
+
+static bool count_number(void* user, double) {
+    return count_event(user);
+}
+
+static bool count_boolean(void* user, bool) {
+    return count_event(user);
+}
+
+static bool count_span(void* user, const char*, size_t) {
+    return count_event(user);
+}
+
+static bool count_end(void* user, size_t) {
+    return count_event(user);
+}
+
+// event parsing with every callback set, so the difference to "parse" is the tree alone
+static void bench_parse_sax(const Corpus& corpus, double min_seconds, std::vector<Result>& results) {
+    size_t events = 0;
+    NaiveHandler handler;
+    memset(&handler, 0, sizeof(handler));
+    handler.user = &events;
+    handler.on_null = count_event;
+    handler.on_boolean = count_boolean;
+    handler.on_number = count_number;
+    handler.on_string = count_span;
+    handler.on_key = count_span;
+    handler.on_start_object = count_event;
+    handler.on_start_array = count_event;
+    handler.on_end_object = count_end;
+    handler.on_end_array = count_end;
+    size_t base_live = bench_live, iterations = 0, allocs = bench_allocs;
+    bench_peak = bench_live;
+    bench_clock::time_point start = bench_clock::now();
+    do {
+        for (size_t i = 0; i < corpus.begins.size(); i++) {
+            if (naive_parse_sax(&handler, corpus.text.data() + corpus.begins[i], corpus.ends[i] - corpus.begins[i])
+                != NAIVE_PARSE_OK) {
+                fprintf(stderr, "naivebench: %s does not parse\n", corpus.name);
+                exit(1);
+            }
+        }
+        iterations++;
+    } while (elapsed(start) < min_seconds);
+    double seconds = elapsed(start);
+    results.push_back(make_result(corpus, "parse_sax", iterations, seconds, bench_allocs - allocs,
+                                  peak_since(base_live)));
+}
+
+// each document arrives in TCP-segment-sized chunks, timed like "parse" without the free
+static void bench_parse_stream(const Corpus& corpus, double min_seconds, std::vector<Result>& results) {
+    const size_t chunk = 1460;
+    std::vector<NaiveValue> values(corpus.begins.size());
+    size_t base_live = bench_live, iterations = 0, allocs = 0;
+    double seconds = 0.0;
+    bench_peak = bench_live;
+    do {
+        size_t before = bench_allocs;
+        bench_clock::time_point start = bench_clock::now();
+        for (size_t i = 0; i < values.size(); i++) {
+            NaiveStream stream;
+            naive_stream_init(&stream, &values[i]);
+            int ret = NAIVE_PARSE_OK;
+            for (size_t p = corpus.begins[i]; p < corpus.ends[i] && ret == NAIVE_PARSE_OK; p += chunk)
+                ret = naive_stream_feed(&stream, corpus.text.data() + p, std::min(chunk, corpus.ends[i] - p));
+            if (ret != NAIVE_PARSE_OK || naive_stream_finish(&stream) != NAIVE_PARSE_OK) {
+                fprintf(stderr, "naivebench: %s does not parse\n", corpus.name);
+                exit(1);
+            }
+            naive_stream_destroy(&stream);
+        }
+        seconds += elapsed(start);
+        allocs += bench_allocs - before;
+        free_corpus(values);
+        iterations++;
+    } while (seconds < min_seconds);
+    results.push_back(make_result(corpus, "parse_stream", iterations, seconds, allocs,
+                                  peak_since(base_live)));
+}
+
+// the two-stage engine on one thread and on every core, timed like "parse" without the free
+static void bench_parse_indexed(const Corpus& corpus, double min_seconds, std::vector<Result>& results) {
+    static const char* operations[] = {"indexed_1t", "indexed_mt"};
+    unsigned threads[] = {1, 0};
+    std::vector<NaiveValue> values(corpus.begins.size());
+    for (size_t t = 0; t < 2; t++) {
+        size_t base_live = bench_live, iterations = 0, allocs = 0;
+        double seconds = 0.0;
+        bench_peak = bench_live;
+        do {
+            size_t before = bench_allocs;
+            bench_clock::time_point start = bench_clock::now();
+            for (size_t i = 0; i < values.size(); i++) {
+                if (naive_parse_indexed(&values[i], corpus.text.data() + corpus.begins[i],
+                                        corpus.ends[i] - corpus.begins[i], threads[t]) != NAIVE_PARSE_OK) {
+                    fprintf(stderr, "naivebench: %s does not parse\n", corpus.name);
+                    exit(1);
+                }
+            }
+            seconds += elapsed(start);
+            allocs += bench_allocs - before;
+            free_corpus(values);
+            iterations++;
+        } while (seconds < min_seconds);
+        results.push_back(make_result(corpus, operations[t], iterations, seconds, allocs, peak_since(base_live)));
+    }
+}
+
+// "a few fields out of a big document": validate lazily, then materialize only the last element of an
+// array root (object roots are materialized whole)
+static void bench_lazy(const Corpus& corpus, double min_seconds, std::vector<Result>& results) {
+    size_t base_live = bench_live, iterations = 0, allocs = bench_allocs;
+    bench_peak = bench_live;
+    bench_clock::time_point start = bench_clock::now();
+    do {
+        for (size_t i = 0; i < corpus.begins.size(); i++) {
+            NaiveLazyValue root, child;
+            NaiveValue value;
+            if (naive_lazy_parse(&root, corpus.text.data() + corpus.begins[i], corpus.ends[i] - corpus.begins[i])
+                != NAIVE_PARSE_OK) {
+                fprintf(stderr, "naivebench: %s does not parse\n", corpus.name);
+                exit(1);
+            }
+            child = root;
+            if (naive_lazy_get_type(&root) == NAIVE_ARRAY) {
+                size_t size = naive_lazy_get_array_size(&root);
+                if (size)
+                    naive_lazy_get_array_element(&root, size - 1, &child);
+            }
+            naive_lazy_materialize(&child, &value);
+            naive_free(&value);
+        }
+        iterations++;
+    } while (elapsed(start) < min_seconds);
+    double seconds = elapsed(start);
+    results.push_back(make_result(corpus, "lazy_last", iterations, seconds, bench_allocs - allocs,
+                                  peak_since(base_live)));
+}
+
+// NDJSON corpora only: the whole text in one call, once on a single thread, once on every core, once on
+// one thread with keys and short strings pooled and once more with an arena as well (a fresh pool and
+// arena per pass, which count as allocations)
+static void bench_parse_ndjson(const Corpus& corpus, double min_seconds, std::vector<Result>& results) {
+    static const char* operations[] = {"ndjson_1t", "ndjson_mt", "ndjson_intern", "ndjson_arena"};
+    unsigned threads[] = {1, 0, 1, 1};
+    if (corpus.begins.size() < 2)
+        return;
+    for (size_t t = 0; t < 4; t++) {
+        size_t base_live = bench_live, iterations = 0, allocs = 0;
+        double seconds = 0.0;
+        bench_peak = bench_live;
+        do {
+            NaiveRecord* records;
+            NaiveInternPool pool;
+            NaiveArena arena;
+            size_t before = bench_allocs;
+            bench_clock::time_point start = bench_clock::now();
+            naive_intern_init(&pool, 32);
+            naive_arena_init(&arena);
+            size_t count = naive_parse_ndjson(corpus.text.data(), corpus.text.size(), &records, threads[t],
+                                              t >= 2 ? &pool : nullptr, t == 3 ? &arena : nullptr);
+            seconds += elapsed(start);
+            allocs += bench_allocs - before;
+            if (count != corpus.begins.size()) {
+                fprintf(stderr, "naivebench: %s does not parse\n", corpus.name);
+                exit(1);
+            }
+            naive_free_records(records, count);
+            naive_arena_destroy(&arena);
+            naive_intern_destroy(&pool);
+            iterations++;
+        } while (seconds < min_seconds);
+        results.push_back(make_result(corpus, operations[t], iterations, seconds, allocs, peak_since(base_live)));
+    }
+}
+
+static void bench_stringify(const Corpus& corpus, double min_seconds, std::vector<Result>& results) {
+    std::vector<NaiveValue> values(corpus.begins.size());
+    parse_corpus(corpus, values, nullptr);
+    size_t base_live = bench_live, iterations = 0, allocs = bench_allocs;
+    bench_peak = bench_live;
+    bench_clock::time_point start = bench_clock::now();
+    do {
+        for (size_t i = 0; i < values.size(); i++)
+            free(naive_stringify(&values[i], nullptr));
+        iterations++;
+    } while (elapsed(start) < min_seconds);
+    double seconds = elapsed(start);
+    results.push_back(make_result(corpus, "stringify", iterations, seconds, bench_allocs - allocs,
+                                  peak_since(base_live)));
+    free_corpus(values);
+}
+
+static bool discard_slices(void* user, const NaiveSlice* slices, size_t count) {
+    for (size_t i = 0; i < count; i++)
+        *static_cast<size_t*>(user) += slices[i].len;
+    return true;
+}
+
+// the same output through naive_stringify_sink, the peak column shows the bounded buffer
+static void bench_stringify_sink(const Corpus& corpus, double min_seconds, std::vector<Result>& results) {
+    std::vector<NaiveValue> values(corpus.begins.size());
+    parse_corpus(corpus, values, nullptr);
+    size_t base_live = bench_live, iterations = 0, allocs = bench_allocs, written = 0;
+    NaiveSink sink = {&written, discard_slices};
+    bench_peak = bench_live;
+    bench_clock::time_point start = bench_clock::now();
+    do {
+        for (size_t i = 0; i < values.size(); i++)
+            naive_stringify_sink(&values[i], &sink);
+        iterations++;
+    } while (elapsed(start) < min_seconds);
+    double seconds = elapsed(start);
+    results.push_back(make_result(corpus, "stringify_sink", iterations, seconds, bench_allocs - allocs,
+                                  peak_since(base_live)));
+    free_corpus(values);
+}
+
+// into buffers sized once up front, as for pre-registered I/O buffers
+static void bench_stringify_into(const Corpus& corpus, double min_seconds, std::vector<Result>& results) {
+    std::vector<NaiveValue> values(corpus.begins.size());
+    std::vector<std::string> buffers(values.size());
+    parse_corpus(corpus, values, nullptr);
+    for (size_t i = 0; i < values.size(); i++)
+        buffers[i].resize(naive_stringify_size(&values[i]));
+    size_t base_live = bench_live, iterations = 0, allocs = bench_allocs;
+    bench_peak = bench_live;
+    bench_clock::time_point start = bench_clock::now();
+    do {
+        for (size_t i = 0; i < values.size(); i++)
+            naive_stringify_into(&values[i], &buffers[i][0], buffers[i].size());
+        iterations++;
+    } while (elapsed(start) < min_seconds);
+    double seconds = elapsed(start);
+    results.push_back(make_result(corpus, "stringify_into", iterations, seconds, bench_allocs - allocs,
+                                  peak_since(base_live)));
+    free_corpus(values);
+}
+
+// touches every value through the public accessors, so it is bound by how many cache lines the tree spans
+static double traverse(const NaiveValue* value) {
+    switch (naive_get_type(value)) {
+        case NAIVE_NUMBER:
+            return naive_get_number(value);
+        case NAIVE_STRING:
+            return static_cast<double>(naive_get_string_length(value));
+        case NAIVE_TRUE:
+            return 1.0;
+        case NAIVE_ARRAY: {
+            double sum = 0.0;
+            for (size_t i = 0, n = naive_get_array_size(value); i < n; i++)
+                sum += traverse(naive_get_array_element(value, i));
+            return sum;
+        }
+        case NAIVE_OBJECT: {
+            double sum = 0.0;
+            for (size_t i = 0, n = naive_get_object_size(value); i < n; i++)
+                sum += naive_get_object_key_length(value, i) + traverse(naive_get_object_value(value, i));
+            return sum;
+        }
+        default:
+            return 0.0;
+    }
+}
+
+static void bench_traverse(const Corpus& corpus, double min_seconds, std::vector<Result>& results) {
+    std::vector<NaiveValue> values(corpus.begins.size());
+    parse_corpus(corpus, values, nullptr);
+    size_t base_live = bench_live, iterations = 0, allocs = bench_allocs;
+    volatile double sink = 0.0;
+    bench_peak = bench_live;
+    bench_clock::time_point start = bench_clock::now();
+    do {
+        for (size_t i = 0; i < values.size(); i++)
+            sink = sink + traverse(&values[i]);
+        iterations++;
+    } while (elapsed(start) < min_seconds);
+    double seconds = elapsed(start);
+    results.push_back(make_result(corpus, "traverse", iterations, seconds, bench_allocs - allocs,
+                                  peak_since(base_live)));
+    free_corpus(values);
+}
+
+// reads the first scalar down the first children of `value`
+static double touch_first(const NaiveValue* value) {
+    while (true) {
+        switch (naive_get_type(value)) {
+            case NAIVE_ARRAY:
+                if (naive_get_array_size(value) == 0)
+                    return 0.0;
+                value = naive_get_array_element(value, 0);
+                break;
+            case NAIVE_OBJECT:
+                if (naive_get_object_size(value) == 0)
+                    return 0.0;
+                value = naive_get_object_value(value, 0);
+                break;
+            case NAIVE_NUMBER:
+                return naive_get_number(value);
+            case NAIVE_STRING:
+                return static_cast<double>(naive_get_string_length(value));
+            default:
+                return 1.0;
+        }
+    }
+}
+
+// parse, read one value, stringify and free: what a proxy rewriting documents pays, with scalars decoded
+// up front or (raw) only where they are read
+static void bench_passthrough(const Corpus& corpus, double min_seconds, std::vector<Result>& results) {
+    for (int raw = 0; raw < 2; raw++) {
+        size_t base_live = bench_live, iterations = 0, allocs = bench_allocs;
+        volatile double sink = 0.0;
+        bench_peak = bench_live;
+        bench_clock::time_point start = bench_clock::now();
+        do {
+            for (size_t i = 0; i < corpus.begins.size(); i++) {
+                NaiveValue value;
+                const char* json = corpus.text.data() + corpus.begins[i];
+                size_t len = corpus.ends[i] - corpus.begins[i];
+                if ((raw ? naive_parse_raw(&value, json, len) : naive_parse_n(&value, json, len)) != NAIVE_PARSE_OK) {
+                    fprintf(stderr, "naivebench: %s does not parse\n", corpus.name);
+                    exit(1);
+                }
+                sink = sink + touch_first(&value);
+                free(naive_stringify(&value, nullptr));
+                naive_free(&value);
+            }
+            iterations++;
+        } while (elapsed(start) < min_seconds);
+        double seconds = elapsed(start);
+        results.push_back(make_result(corpus, raw ? "passthru_raw" : "passthrough", iterations, seconds,
+                                      bench_allocs - allocs, peak_since(base_live)));
+    }
+}
+
+static void bench_copy(const Corpus& corpus, double min_seconds, std::vector<Result>& results) {
+    std::vector<NaiveValue> values(corpus.begins.size()), copies(corpus.begins.size());
+    parse_corpus(corpus, values, nullptr);
+    size_t base_live = bench_live, iterations = 0, copy_allocs = 0;
+    double seconds = 0.0;
+    bench_peak = bench_live;
+    do {
+        size_t allocs = bench_allocs;
+        bench_clock::time_point start = bench_clock::now();
+        for (size_t i = 0; i < values.size(); i++) {
+            naive_init(&copies[i]);
+            naive_copy(&copies[i], &values[i]);
+        }
+        seconds += elapsed(start);
+        copy_allocs += bench_allocs - allocs;
+        free_corpus(copies);
+        iterations++;
+    } while (seconds < min_seconds);
+    results.push_back(make_result(corpus, "copy", iterations, seconds, copy_allocs, peak_since(base_live)));
+    free_corpus(values);
+}
+
+static void bench_is_equal(const Corpus& corpus, double min_seconds, std::vector<Result>& results) {
+    std::vector<NaiveValue> lhs(corpus.begins.size()), rhs(corpus.begins.size());
+    parse_corpus(corpus, lhs, nullptr);
+    parse_corpus(corpus, rhs, nullptr);
+    size_t base_live = bench_live, iterations = 0, allocs = bench_allocs;
+    bench_peak = bench_live;
+    bench_clock::time_point start = bench_clock::now();
+    do {
+        for (size_t i = 0; i < lhs.size(); i++) {
+            if (!naive_is_equal(&lhs[i], &rhs[i])) {
+                fprintf(stderr, "naivebench: %s is not equal to itself\n", corpus.name);
+                exit(1);
+            }
+        }
+        iterations++;
+    } while (elapsed(start) < min_seconds);
+    double seconds = elapsed(start);
+    results.push_back(make_result(corpus, "is_equal", iterations, seconds, bench_allocs - allocs,
+                                  peak_since(base_live)));
+    free_corpus(lhs);
+    free_corpus(rhs);
+}
+
+static double mb_per_second(const Result& r) {
+    return r.seconds > 0 ? r.bytes * static_cast<double>(r.iterations) / r.seconds / (1024.0 * 1024.0) : 0.0;
+}
+
+static double documents_per_second(const Result& r) {
+    return r.seconds > 0 ? r.documents * static_cast<double>(r.iterations) / r.seconds : 0.0;
+}
+
+static const char* simd_path() {
+#if defined(NAIVE_NO_SIMD)
+    return "scalar";
+#elif defined(__AVX2__)
+    return "avx2";
+#elif defined(__SSE2__) || defined(_M_X64)
+    return "sse2";
+#else
+    return "scalar";
+#endif
+}
+
+static void print_table(const std::vector<Result>& results) {
+    printf("simd: %s\n", simd_path());
+    printf("%-15s %-14s %10s %10s %12s %12s %12s %12s\n",
+           "corpus", "operation", "bytes", "MB/s", "docs/s", "allocs/pass", "peak heap KB", "peak rss KB");
+    for (size_t i = 0; i < results.size(); i++) {
+        const Result& r = results[i];
+        printf("%-15s %-14s %10zu %10.1f %12.0f %12zu %12zu %12ld\n", r.corpus, r.operation, r.bytes,
+               mb_per_second(r), documents_per_second(r), r.allocs, r.peak_heap / 1024, r.peak_rss);
+    }
+}
+
+static void print_json(const std::vector<Result>& results) {
+    printf("{\"simd\":\"%s\",\"results\":[", simd_path());
+    for (size_t i = 0; i < results.size(); i++) {
+        const Result& r = results[i];
+        printf("%s\n{\"corpus\":\"%s\",\"operation\":\"%s\",\"bytes\":%zu,\"documents\":%zu,\"iterations\":%zu,"
+               "\"seconds\":%.6f,\"mb_per_s\":%.2f,\"docs_per_s\":%.1f,\"allocs_per_pass\":%zu,"
+               "\"peak_heap_bytes\":%zu,\"peak_rss_kb\":%ld}",
+               i > 0 ? "," : "", r.corpus, r.operation, r.bytes, r.documents, r.iterations, r.seconds,
+               mb_per_second(r), documents_per_second(r), r.allocs, r.peak_heap, r.peak_rss);
+    }
+    printf("\n]}\n");
+}
+
+static void usage() {
+    fprintf(stderr, "usage: naivebench [--json] [--seconds S] [--corpus NAME]\n");
+    exit(2);
+}
+
+int main(int argc, char* argv[]) {
+    bool json = false;
+    double seconds = 0.5;
+    const char* only = nullptr;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--json") == 0)
+            json = true;
+        else if (strcmp(argv[i], "--seconds") == 0 && i + 1 < argc)
+            seconds = atof(argv[++i]);
+        else if (strcmp(argv[i], "--corpus") == 0 && i + 1 < argc)
+            only = argv[++i];
+        else
+            usage();
+    }
+
+    std::vector<Corpus> corpora(8);
+    corpora[0].name = "records";
+    add_document(corpora[0], generate_records(20000, 0));
+    corpora[1].name = "records_indent";
+    add_document(corpora[1], generate_records(20000, 4));
+    corpora[2].name = "numbers";
+    add_document(corpora[2], generate_numbers(200000));
+    corpora[3].name = "strings";
+    add_document(corpora[3], generate_strings(50000));
+    corpora[4].name = "nested";
+    add_document(corpora[4], generate_nested(2000, 64));
+    corpora[5].name = "wide";
+    add_document(corpora[5], generate_wide(50000));
+    corpora[6].name = "ndjson";
+    generate_ndjson(corpora[6], 50000);
+    corpora[7].name = "integers";
+    add_document(corpora[7], generate_integers(100000));
+
+    std::vector<Result> results;
+    for (size_t i = 0; i < corpora.size(); i++) {
+        if (only != nullptr && strcmp(only, corpora[i].name) != 0)
+            continue;
+        bench_parse_free(corpora[i], seconds, results);
+        bench_parse_arena(corpora[i], seconds, results);
+        bench_parse_sax(corpora[i], seconds, results);
+        bench_parse_stream(corpora[i], seconds, results);
+        bench_parse_indexed(corpora[i], seconds, results);
+        bench_lazy(corpora[i], seconds, results);
+        bench_parse_ndjson(corpora[i], seconds, results);
+        bench_traverse(corpora[i], seconds, results);
+        bench_stringify(corpora[i], seconds, results);
+        bench_stringify_sink(corpora[i], seconds, results);
+        bench_stringify_into(corpora[i], seconds, results);
+        bench_passthrough(corpora[i], seconds, results);
+        bench_copy(corpora[i], seconds, results);
+        bench_is_equal(corpora[i], seconds, results);
+    }
+    if (json)
+        print_json(results);
+    else
+        print_table(results);
+    return 0;
+}
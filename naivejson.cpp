@@ -13,11 +13,61 @@
 #endif
 
 #include "naivejson.h"
+#include <cstdint>
+#include <new>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#if !defined(_WIN32)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#else
+#include <io.h>
+#endif
+
+// SIMD support is detected from the compiler target, define NAIVE_NO_SIMD to force the scalar paths
+#if !defined(NAIVE_NO_SIMD)
+#if defined(__AVX2__)
+#define NAIVE_AVX2
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define NAIVE_SSE2
+#include <emmintrin.h>
+#endif
+#endif
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+
+static inline unsigned naive_ctz(unsigned mask) {
+    unsigned long index;
+    _BitScanForward(&index, mask);
+    return index;
+}
+
+static inline unsigned naive_ctz64(uint64_t mask) {
+    unsigned long index;
+    _BitScanForward64(&index, mask);
+    return index;
+}
+#else
+static inline unsigned naive_ctz(unsigned mask) {
+    return __builtin_ctz(mask);
+}
+
+static inline unsigned naive_ctz64(uint64_t mask) {
+    return __builtin_ctzll(mask);
+}
+#endif
 
 // TODO: encapsulate with private function?
 // void* return value can be cast to any type
 // push value in bytes
-static void* naive_context_push(NaiveContext* context, size_t size) {
+void* naive_context_push(NaiveContext* context, size_t size) {
     void* ret;
     assert(size > 0);
     if (context->top + size >= context->size) {
@@ -36,386 +86,3840 @@ static void* naive_context_push(NaiveContext* context, size_t size) {
     return ret;
 }
 
-static void* naive_context_pop(NaiveContext* context, size_t size) {
+void* naive_context_pop(NaiveContext* context, size_t size) {
     assert(context->top >= size);
     return context->stack + (context->top -= size);
 }
 
-static void naive_parse_whitespace(NaiveContext* context) {
-    const char* p = context->json;
-    while (*p == ' ' || *p == '\t' || *p == '\n' || *p == '\r')
-        p++;
-    context->json = p;
+// arena chunks are aligned to their power-of-two size, so the chunk (and the arena) owning a value is
+// found by masking the value's address with its `chunk` bits. Oversized blocks are aligned the same way
+// to the power of two above their size, but only their own pages are mapped
+struct NaiveArenaChunk {
+    NaiveArena* arena;
+    NaiveArenaChunk* next;
+    size_t size;
+    unsigned char shift;
+    bool oversized; // a block of its own, carved for a single allocation
+};
+
+static const size_t NAIVE_PAGE_SIZE = 4096;
+
+static const size_t NAIVE_ARENA_HEADER_SIZE = (sizeof(NaiveArenaChunk) + 15) & ~static_cast<size_t>(15);
+
+// an input buffer the arena's documents point into, released together with them
+struct NaiveArenaMapping {
+    NaiveArenaMapping* next;
+    void* base;
+    size_t size;
+    bool mapped; // munmap rather than free
+};
+
+static unsigned char naive_log2_ceil(size_t size) {
+    unsigned char shift = 0;
+    while ((static_cast<size_t>(1) << shift) < size)
+        shift++;
+    return shift;
 }
 
-int naive_parse(NaiveValue* value, const char* json) {
-    NaiveContext context;
-    assert(value != nullptr);
-    context.json = json;
-    context.stack = nullptr;
-    context.size = context.top = 0;
-    naive_init(value);
-    naive_parse_whitespace(&context);
-    int ret;
-    if ((ret = naive_parse_value(&context, value)) == NAIVE_PARSE_OK) {
-        naive_parse_whitespace(&context);
-        if (*context.json != '\0') {
-            value->type = NAIVE_NULL;
-            ret = NAIVE_PARSE_ROOT_NOT_SINGULAR;
+// `size` bytes at a multiple of `align`. Oversized blocks reserve `align` more address space than they
+// need and give back everything outside the aligned pages, so the alignment costs no memory
+static void* naive_arena_map(size_t size, size_t align, bool oversized) {
+    void* p;
+#if defined(_WIN32)
+    (void) oversized;
+    p = _aligned_malloc(size, align);
+#else
+    if (oversized) {
+        size_t reserve = size + align;
+        char* base = static_cast<char*>(mmap(nullptr, reserve, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0));
+        if (base == MAP_FAILED)
+            return nullptr;
+        uintptr_t start = (reinterpret_cast<uintptr_t>(base) + align - 1) & ~static_cast<uintptr_t>(align - 1);
+        char* aligned = reinterpret_cast<char*>(start);
+        if (aligned != base)
+            munmap(base, aligned - base);
+        if (aligned + size != base + reserve)
+            munmap(aligned + size, base + reserve - (aligned + size));
+        return aligned;
+    }
+    if (posix_memalign(&p, align, size) != 0)
+        p = nullptr;
+#endif
+    return p;
+}
+
+static NaiveArenaChunk* naive_arena_new_chunk(NaiveArena* arena, size_t size, bool oversized) {
+    if (oversized)
+        size = (size + NAIVE_PAGE_SIZE - 1) & ~(NAIVE_PAGE_SIZE - 1);
+    unsigned char shift = naive_log2_ceil(size);
+    NaiveArenaChunk* chunk = static_cast<NaiveArenaChunk*>(naive_arena_map(size, static_cast<size_t>(1) << shift, oversized));
+    if (chunk == nullptr)
+        throw std::bad_alloc();
+    chunk->arena = arena;
+    chunk->next = nullptr;
+    chunk->size = size;
+    chunk->shift = shift;
+    chunk->oversized = oversized;
+    return chunk;
+}
+
+static void naive_arena_free_chunk(NaiveArenaChunk* chunk) {
+#if defined(_WIN32)
+    _aligned_free(chunk);
+#else
+    if (chunk->oversized)
+        munmap(chunk, chunk->size);
+    else
+        free(chunk);
+#endif
+}
+
+void naive_arena_init(NaiveArena* arena, size_t chunk_size) {
+    assert(arena != nullptr);
+    arena->chunks = nullptr;
+    arena->mappings = nullptr;
+    arena->cursor = arena->limit = nullptr;
+    // at least one page, 255 is the largest shift `chunk` can hold
+    arena->chunk_size = static_cast<size_t>(1) << naive_log2_ceil(chunk_size < 4096 ? 4096 : chunk_size);
+}
+
+// `shift` receives the size of the chunk the block was carved from
+static void* naive_arena_alloc(NaiveArena* arena, size_t size, unsigned char* shift) {
+    assert(arena != nullptr && arena->chunk_size > 0);
+    size = (size + 7) & ~static_cast<size_t>(7);
+    if (size > static_cast<size_t>(arena->limit - arena->cursor)) {
+        NaiveArenaChunk* chunk;
+        if (size > arena->chunk_size - NAIVE_ARENA_HEADER_SIZE) {
+            // oversized blocks get a chunk of their own behind the one being carved
+            chunk = naive_arena_new_chunk(arena, size + NAIVE_ARENA_HEADER_SIZE, true);
+            if (arena->chunks != nullptr) {
+                chunk->next = arena->chunks->next;
+                arena->chunks->next = chunk;
+            } else {
+                arena->chunks = chunk;
+            }
+            if (shift)
+                *shift = chunk->shift;
+            return reinterpret_cast<char*>(chunk) + NAIVE_ARENA_HEADER_SIZE;
         }
+        chunk = naive_arena_new_chunk(arena, arena->chunk_size, false);
+        chunk->next = arena->chunks;
+        arena->chunks = chunk;
+        arena->cursor = reinterpret_cast<char*>(chunk) + NAIVE_ARENA_HEADER_SIZE;
+        arena->limit = reinterpret_cast<char*>(chunk) + arena->chunk_size;
     }
-    assert(context.top == 0);
-    free(context.stack);
+    void* ret = arena->cursor;
+    arena->cursor += size;
+    if (shift)
+        *shift = arena->chunks->shift;
     return ret;
 }
 
-void naive_free(NaiveValue* value) {
-    // called before set
-    assert(value != nullptr);
-    switch (value->type) {
-        case NAIVE_STRING:
-            free(value->str);
-            break;
-        case NAIVE_ARRAY:
-            for (size_t i = 0; i < value->arrlen; i++) {
-                naive_free(&value->arr[i]);
-            }
-            free(value->arr);
-            break;
-        case NAIVE_OBJECT:
-            for (size_t i = 0; i < value->maplen; i++) {
-                free(value->map[i].key);
-                naive_free(&value->map[i].value);
-            }
-            free(value->map);
-            break;
-        default:
-            break;
+void* naive_arena_alloc(NaiveArena* arena, size_t size) {
+    return naive_arena_alloc(arena, size, nullptr);
+}
+
+static void naive_arena_attach(NaiveArena* arena, void* base, size_t size, bool mapped) {
+    NaiveArenaMapping* mapping = static_cast<NaiveArenaMapping*>(naive_arena_alloc(arena, sizeof(NaiveArenaMapping)));
+    mapping->base = base;
+    mapping->size = size;
+    mapping->mapped = mapped;
+    mapping->next = arena->mappings;
+    arena->mappings = mapping;
+}
+
+// the records live in the chunks, so this runs before they go
+static void naive_arena_release_mappings(NaiveArena* arena) {
+    for (NaiveArenaMapping* mapping = arena->mappings; mapping != nullptr; mapping = mapping->next) {
+#if !defined(_WIN32)
+        if (mapping->mapped) {
+            munmap(mapping->base, mapping->size);
+            continue;
+        }
+#endif
+        free(mapping->base);
     }
-    value->type = NAIVE_NULL;
+    arena->mappings = nullptr;
 }
 
-static int naive_parse_literal(NaiveContext* context, NaiveValue* value, const char* literal, NaiveType type) {
-    // compare with null、true、false
-    size_t i = 0;
-    // TODO: remove EXPECT?
-    EXPECT(context, literal[0]);
-    // compared with literal value by character
-    for (i = 0; literal[i + 1] != '\0'; ++i) {
-        if (context->json[i] != literal[i + 1])
-            return NAIVE_PARSE_INVALID_VALUE;
+void naive_arena_reset(NaiveArena* arena) {
+    assert(arena != nullptr);
+    naive_arena_release_mappings(arena);
+    // keep one regular chunk around so parsing the next document does not start with a malloc
+    NaiveArenaChunk* keep = nullptr;
+    NaiveArenaChunk* chunk = arena->chunks;
+    while (chunk != nullptr) {
+        NaiveArenaChunk* next = chunk->next;
+        if (keep == nullptr && !chunk->oversized && chunk->size == arena->chunk_size) {
+            keep = chunk;
+            keep->next = nullptr;
+        } else {
+            naive_arena_free_chunk(chunk);
+        }
+        chunk = next;
     }
-    context->json += i;
-    value->type = type;
-    return NAIVE_PARSE_OK;
+    arena->chunks = keep;
+    arena->cursor = keep ? reinterpret_cast<char*>(keep) + NAIVE_ARENA_HEADER_SIZE : nullptr;
+    arena->limit = keep ? reinterpret_cast<char*>(keep) + arena->chunk_size : nullptr;
 }
 
-static int naive_parse_number(NaiveContext* context, NaiveValue* value) {
-    const char* p = context->json;
-    if (*p == '-') p++;
-    // 002 is invalid input: root_not_singular
-    if (*p == '0') p++; // single zero is allowed
-    else {
-        if (!ISDIGIT1TO9((*p)))
-            return NAIVE_PARSE_INVALID_VALUE;
-        while (ISDIGIT(*p)) p++;
+void naive_arena_destroy(NaiveArena* arena) {
+    assert(arena != nullptr);
+    naive_arena_release_mappings(arena);
+    while (arena->chunks != nullptr) {
+        NaiveArenaChunk* next = arena->chunks->next;
+        naive_arena_free_chunk(arena->chunks);
+        arena->chunks = next;
     }
-    if (*p == '.') {
-        p++;
-        if (!ISDIGIT((*p)))
-            return NAIVE_PARSE_INVALID_VALUE;
-        while (ISDIGIT(*p)) p++;
+    arena->cursor = arena->limit = nullptr;
+}
+
+// hands every chunk and mapping of `from` over to `arena`, behind the chunk it is carving; `from` is left
+// empty and the values carved from it now belong to `arena`
+static void naive_arena_adopt(NaiveArena* arena, NaiveArena* from) {
+    NaiveArenaChunk* last = nullptr;
+    for (NaiveArenaChunk* chunk = from->chunks; chunk != nullptr; chunk = chunk->next) {
+        chunk->arena = arena;
+        last = chunk;
     }
-    if (*p == 'e' || *p == 'E') {
-        p++;
-        if (*p == '+' || *p == '-') p++;
-        if (!ISDIGIT1TO9((*p)))
-            return NAIVE_PARSE_INVALID_VALUE;
-        while (ISDIGIT(*p)) p++;
+    if (last != nullptr) {
+        NaiveArenaChunk** tail = arena->chunks != nullptr ? &arena->chunks->next : &arena->chunks;
+        last->next = *tail;
+        *tail = from->chunks;
     }
-    errno = 0;
-    value->number = strtod(context->json, nullptr);
-    if (errno == ERANGE && (value->number == HUGE_VAL || value->number == -HUGE_VAL))
-        return NAIVE_PARSE_NUMBER_TOO_BIG;
-    context->json = p;
-    value->type = NAIVE_NUMBER;
-    return NAIVE_PARSE_OK;
+    if (from->mappings != nullptr) {
+        NaiveArenaMapping* mapping = from->mappings;
+        while (mapping->next != nullptr)
+            mapping = mapping->next;
+        mapping->next = arena->mappings;
+        arena->mappings = from->mappings;
+    }
+    from->chunks = nullptr;
+    from->mappings = nullptr;
+    from->cursor = from->limit = nullptr;
 }
 
-static const char* naive_parse_hex4(const char* p, unsigned* u) {
-    *u = 0;
-    for (int i = 0; i < 4; ++i) {
-        char ch = *p++;
-        *u <<= 4;
-        if (ch >= '0' && ch <= '9') *u |= ch - '0';
-        else if (ch >= 'A' && ch <= 'F') *u |= ch - ('A' - 10);
-        else if (ch >= 'a' && ch <= 'f') *u |= ch - ('a' - 10);
-        else return nullptr;
-    }
-    return p;
+// the arena a value slot lives in, nullptr for stack, heap and root values
+static NaiveArena* naive_value_arena(const NaiveValue* value) {
+    if (value->chunk == 0)
+        return nullptr;
+    uintptr_t base = reinterpret_cast<uintptr_t>(value) & ~((static_cast<uintptr_t>(1) << value->chunk) - 1);
+    return reinterpret_cast<const NaiveArenaChunk*>(base)->arena;
+}
+
+// where new payload of `value` goes: arena-backed containers keep growing inside their arena
+static NaiveArena* naive_payload_arena(const NaiveValue* value) {
+    return (value->flags & NAIVE_VALUE_SHARED) ? naive_value_arena(value) : nullptr;
+}
+
+static void* naive_alloc(NaiveArena* arena, size_t size, unsigned char* shift) {
+    if (arena != nullptr)
+        return naive_arena_alloc(arena, size, shift);
+    if (shift)
+        *shift = 0;
+    return malloc(size);
+}
+
+static char* naive_alloc_string(NaiveArena* arena, const char* str, size_t len) {
+    char* ret = static_cast<char*>(naive_alloc(arena, len + 1, nullptr));
+    memcpy(ret, str, len);
+    ret[len] = '\0';
+    return ret;
+}
+
+static_assert(sizeof(NaiveValue) <= 16, "NaiveValue is a payload word, a 32-bit length and four tag bytes");
+
+static uint32_t naive_hash_key(const char* key, size_t keylen);
+
+// open addressing with linear probing over the pooled strings, kept at most half full
+struct NaiveInternSlot {
+    const char* str; // nullptr for an empty slot
+    size_t len;
+    uint32_t hash;
 };
 
-static void naive_encode_utf8(NaiveContext* c, unsigned u) {
-    if (u <= 0x7F)
-        PUTC(c, u & 0xFF);
-    else if (u <= 0x7FF) {
-        PUTC(c, 0xC0 | ((u >> 6) & 0xFF));
-        PUTC(c, 0x80 | (u & 0x3F));
-    } else if (u <= 0xFFFF) {
-        PUTC(c, 0xE0 | ((u >> 12) & 0xFF));
-        PUTC(c, 0x80 | ((u >> 6) & 0x3F));
-        PUTC(c, 0x80 | (u & 0x3F));
-    } else {
-        assert(u <= 0x10FFFF);
-        PUTC(c, 0xF0 | ((u >> 18) & 0xFF));
-        PUTC(c, 0x80 | ((u >> 12) & 0x3F));
-        PUTC(c, 0x80 | ((u >> 6) & 0x3F));
-        PUTC(c, 0x80 | (u & 0x3F));
-    }
+void naive_intern_init(NaiveInternPool* pool, size_t max_string) {
+    assert(pool != nullptr);
+    naive_arena_init(&pool->arena);
+    pool->slots = nullptr;
+    pool->count = pool->mask = 0;
+    pool->max_string = max_string;
+    pool->base = nullptr;
 }
 
-static int naive_parse_string_raw(NaiveContext* context, char** str, size_t* len) {
-    unsigned unicode1, unicode2;
-    size_t head = context->top;
-    EXPECT(context, '\"'); // string starts with "
-    const char* p = context->json;
-    while (true) {
-        char ch = *p++;
-        switch (ch) {
-            case '\"':
-                // meet end of string
-                *len = context->top - head;
-                *str = static_cast<char*>(naive_context_pop(context, *len));
-                context->json = p;
-                return NAIVE_PARSE_OK;
-            case '\\':
-                switch (*p++) {
-                    case 'u': // parse unicode e.g. \u4f60\u597d
-                        if (!(p = naive_parse_hex4(p, &unicode1))) {
-                            context->top = head;
-                            return NAIVE_PARSE_INVALID_UNICODE_HEX;
-                        }
-                        if (unicode1 >= 0xD800 && unicode1 <= 0xDBFF) {
-                            if (*p++ != '\\') {
-                                context->top = head;
-                                return NAIVE_PARSE_INVALID_UNICODE_SURROGATE;
-                            }
-                            if (*p++ != 'u') {
-                                context->top = head;
-                                return NAIVE_PARSE_INVALID_UNICODE_SURROGATE;
-                            }
-                            if (!(p = naive_parse_hex4(p, &unicode2))) {
-                                context->top = head;
-                                return NAIVE_PARSE_INVALID_UNICODE_HEX;
-                            }
-                            if (unicode2 < 0xDC00 || unicode2 > 0xDFFF) {
-                                context->top = head;
-                                return NAIVE_PARSE_INVALID_UNICODE_SURROGATE;
-                            }
-                            unicode1 = (((unicode1 - 0xD800) << 10) | (unicode2 - 0xDC00)) + 0x10000;
-                        }
-                        naive_encode_utf8(context, unicode1);
-                        break;
-                    case '\"':
-                        PUTC(context, '\"');
-                        break;
-                    case '\\':
-                        PUTC(context, '\\');
-                        break;
-                    case '/':
-                        PUTC(context, '/');
-                        break;
-                    case 'b':
-                        PUTC(context, '\b');
-                        break;
-                    case 'f':
-                        PUTC(context, '\f');
-                        break;
-                    case 'n':
-                        PUTC(context, '\n');
-                        break;
-                    case 'r':
-                        PUTC(context, '\r');
-                        break;
-                    case 't':
-                        PUTC(context, '\t');
-                        break;
-                    default:
-                        context->top = head;
-                        return NAIVE_PARSE_INVALID_STRING_ESCAPE;
-                }
-                break;
-            case '\0':
-                // TODO: inline function?
-                // reset stack top
-                context->top = head;
-                return NAIVE_PARSE_MISS_QUOTATION_MARK;
-            default:
-                if (static_cast<unsigned char>(ch) < 0x20) {
-                    context->top = head;
-                    return NAIVE_PARSE_INVALID_STRING_CHAR;
-                }
-                PUTC(context, ch); // assignment
-        }
+// documents parsed with the pool point into it, they go first
+void naive_intern_destroy(NaiveInternPool* pool) {
+    assert(pool != nullptr);
+    free(pool->slots);
+    naive_arena_destroy(&pool->arena);
+    pool->slots = nullptr;
+    pool->count = pool->mask = 0;
+}
+
+static void naive_intern_grow(NaiveInternPool* pool) {
+    size_t capacity = pool->slots ? (pool->mask + 1) * 2 : 256;
+    NaiveInternSlot* slots = static_cast<NaiveInternSlot*>(calloc(capacity, sizeof(NaiveInternSlot)));
+    if (slots == nullptr)
+        throw std::bad_alloc();
+    for (size_t i = 0; pool->slots && i <= pool->mask; i++) {
+        if (pool->slots[i].str == nullptr)
+            continue;
+        size_t pos = pool->slots[i].hash & (capacity - 1);
+        while (slots[pos].str != nullptr)
+            pos = (pos + 1) & (capacity - 1);
+        slots[pos] = pool->slots[i];
     }
+    free(pool->slots);
+    pool->slots = slots;
+    pool->mask = capacity - 1;
 }
 
-static int naive_parse_string(NaiveContext* context, NaiveValue* value) {
-    int ret = 0;
-    size_t len = 0;
-    char* str;
-    if ((ret = naive_parse_string_raw(context, &str, &len)) == NAIVE_PARSE_OK)
-        naive_set_string(value, str, len);
-    return ret;
+// room for `count` strings without growing
+static void naive_intern_reserve(NaiveInternPool* pool, size_t count) {
+    while (pool->slots == nullptr || count * 2 >= pool->mask)
+        naive_intern_grow(pool);
 }
 
-static int naive_parse_array(NaiveContext* context, NaiveValue* value) {
-    size_t arrlen = 0;
-    size_t size = 0;
-    int ret = 0;
-    EXPECT(context, '[');
-    naive_parse_whitespace(context);
-    // meet end of array
-    if (*context->json == ']') {
-        context->json++;
-        naive_set_array(value, 0);
-        return NAIVE_PARSE_OK;
+// the slot holding [str, str + len), or the empty one it would go to
+static NaiveInternSlot* naive_intern_find(const NaiveInternPool* pool, const char* str, size_t len, uint32_t hash) {
+    for (size_t pos = hash & pool->mask;; pos = (pos + 1) & pool->mask) {
+        NaiveInternSlot* slot = &pool->slots[pos];
+        if (slot->str == nullptr ||
+            (slot->hash == hash && slot->len == len && memcmp(slot->str, str, len) == 0))
+            return slot;
     }
-    while (true) {
-        // TODO: element could be a dangling pointer
-        NaiveValue element;
-        naive_init(&element);
-        if ((ret = naive_parse_value(context, &element)) != NAIVE_PARSE_OK) {
-            break;
-        }
-        memcpy(naive_context_push(context, sizeof(NaiveValue)), &element, sizeof(NaiveValue));
-        arrlen++;
+}
 
-        naive_parse_whitespace(context);
-        if (*context->json == ',') {
-            context->json++;
-            naive_parse_whitespace(context);
-        } else if (*context->json == ']') {
-            context->json++;
-            naive_set_array(value, arrlen);
-            size = arrlen * sizeof(NaiveValue);
-            memcpy(value->arr, naive_context_pop(context, size), size);
-            value->arrlen = arrlen;
-            return NAIVE_PARSE_OK;
-        } else {
-            ret = NAIVE_PARSE_MISS_COMMA_OR_SQUARE_BRACKET;
-            break;
-        }
+// the pooled copy of [str, str + len), terminated like any other key
+static const char* naive_intern(NaiveInternPool* pool, const char* str, size_t len) {
+    uint32_t hash = naive_hash_key(str, len);
+    if (pool->base != nullptr && pool->base->slots != nullptr) {
+        const NaiveInternSlot* slot = naive_intern_find(pool->base, str, len, hash);
+        if (slot->str != nullptr)
+            return slot->str;
     }
-    for (size_t i = 0; i < arrlen; i++) {
-        // FIX: free->naive_free
-        naive_free(static_cast<NaiveValue*>(naive_context_pop(context, sizeof(NaiveValue))));
+    naive_intern_reserve(pool, pool->count);
+    NaiveInternSlot* slot = naive_intern_find(pool, str, len, hash);
+    if (slot->str == nullptr) {
+        slot->str = naive_alloc_string(&pool->arena, str, len);
+        slot->len = len;
+        slot->hash = hash;
+        pool->count++;
     }
-    return ret;
+    return slot->str;
 }
 
-static int naive_parse_object(NaiveContext* context, NaiveValue* value) {
-    size_t maplen = 0;
-    size_t size = 0;
-    int ret = 0;
-    EXPECT(context, '{');
-    naive_parse_whitespace(context);
-    // meet end of object
-    if (*context->json == '}') {
-        context->json++;
-        naive_set_object(value, 0);
-        return NAIVE_PARSE_OK;
-    }
-    NaiveMember member;
-    member.key = nullptr;
-    member.keylen = 0;
-    while (true) {
-        // TODO: element could be a dangling pointer
-        char* str;
-        naive_init(&member.value);
-        // 1. parse key
-        if (*context->json != '"') {
-            ret = NAIVE_PARSE_MISS_KEY;
-            break;
+// moves the strings of `cache` into `pool`, which has room for them; a string both hold keeps its two
+// copies and the pool goes on handing out its own
+static void naive_intern_merge(NaiveInternPool* pool, NaiveInternPool* cache) {
+    naive_arena_adopt(&pool->arena, &cache->arena);
+    for (size_t i = 0; cache->slots && i <= cache->mask; i++) {
+        const NaiveInternSlot* from = &cache->slots[i];
+        if (from->str == nullptr)
+            continue;
+        NaiveInternSlot* slot = naive_intern_find(pool, from->str, from->len, from->hash);
+        if (slot->str == nullptr) {
+            *slot = *from;
+            pool->count++;
         }
-        if ((ret = naive_parse_string_raw(context, &str, &member.keylen)) != NAIVE_PARSE_OK) {
-            break;
-        }
-        member.key = static_cast<char*>(malloc(member.keylen + 1));
-        memcpy(member.key, str, member.keylen);
-        member.key[member.keylen] = '\0';
+    }
+    naive_intern_destroy(cache);
+}
 
-        // 2. parse colon
-        naive_parse_whitespace(context);
-        if (*context->json != ':') {
-            ret = NAIVE_PARSE_MISS_COLON;
-            break;
-        }
-        context->json++;
-        naive_parse_whitespace(context);
+// element and member blocks start with their capacity, which does not fit in a 16-byte NaiveValue;
+// capacity 0 has no block at all
+static const size_t NAIVE_BLOCK_HEADER_SIZE = sizeof(size_t);
 
-        // 3. parse value
-        if ((ret = naive_parse_value(context, &member.value)) != NAIVE_PARSE_OK) {
-            break;
-        }
-        memcpy(naive_context_push(context, sizeof(NaiveMember)), &member, sizeof(NaiveMember));
-        maplen++;
-        member.key = nullptr;
+static inline size_t naive_block_capacity(const void* block) {
+    return block != nullptr ? static_cast<const size_t*>(block)[-1] : 0;
+}
 
-        // 4. parse comma or right-curly-bracket
-        naive_parse_whitespace(context);
-        if (*context->json == ',') {
-            context->json++;
-            naive_parse_whitespace(context);
-        } else if (*context->json == '}') {
-            context->json++;
-            naive_set_object(value, maplen);
-            size = maplen * sizeof(NaiveMember);
-            memcpy(value->map, naive_context_pop(context, size), size);
-            value->maplen = maplen;
-            return NAIVE_PARSE_OK;
-        } else {
-            ret = NAIVE_PARSE_MISS_COMMA_OR_CURLY_BRACKET;
-            break;
-        }
+static inline void naive_set_block_capacity(void* block, size_t capacity) {
+    if (block != nullptr)
+        static_cast<size_t*>(block)[-1] = capacity;
+}
+
+static void* naive_alloc_block(NaiveArena* arena, size_t capacity, size_t size, unsigned char* shift) {
+    if (capacity > UINT32_MAX)
+        throw std::length_error("naivejson: containers hold at most 2^32 - 1 values");
+    char* p = static_cast<char*>(naive_alloc(arena, NAIVE_BLOCK_HEADER_SIZE + size, shift));
+    *reinterpret_cast<size_t*>(p) = capacity;
+    return p + NAIVE_BLOCK_HEADER_SIZE;
+}
+
+// heap blocks only
+static void* naive_realloc_block(void* block, size_t capacity, size_t size) {
+    char* p = block != nullptr ? static_cast<char*>(block) - NAIVE_BLOCK_HEADER_SIZE : nullptr;
+    if (capacity == 0) {
+        free(p);
+        return nullptr;
+    }
+    if (capacity > UINT32_MAX)
+        throw std::length_error("naivejson: containers hold at most 2^32 - 1 values");
+    p = static_cast<char*>(realloc(p, NAIVE_BLOCK_HEADER_SIZE + size));
+    *reinterpret_cast<size_t*>(p) = capacity;
+    return p + NAIVE_BLOCK_HEADER_SIZE;
+}
+
+static void naive_free_block(void* block) {
+    if (block != nullptr)
+        free(static_cast<char*>(block) - NAIVE_BLOCK_HEADER_SIZE);
+}
+
+// every slot of a block is stamped with the chunk it lives in, naive_init_slot keeps the stamp
+static NaiveValue* naive_alloc_elements(NaiveArena* arena, size_t capacity) {
+    if (capacity == 0)
+        return nullptr;
+    unsigned char shift;
+    NaiveValue* arr = static_cast<NaiveValue*>(naive_alloc_block(arena, capacity, capacity * sizeof(NaiveValue), &shift));
+    for (size_t i = 0; i < capacity; i++)
+        arr[i].chunk = shift;
+    return arr;
+}
+
+// object blocks with room for at least this many members look keys up through a hash index, kept up to
+// date by every writer and stored behind the members in the same block
+static const size_t NAIVE_OBJECT_INDEX_THRESHOLD = 32;
+
+// open addressing with linear probing, index is the member index + 1 so that 0 marks an empty slot
+struct NaiveIndexSlot {
+    uint32_t hash;
+    uint32_t index;
+};
+
+static size_t naive_index_capacity(size_t mapcap) {
+    if (mapcap < NAIVE_OBJECT_INDEX_THRESHOLD)
+        return 0;
+    size_t capacity = 1;
+    while (capacity < mapcap * 2)
+        capacity <<= 1;
+    return capacity;
+}
+
+static size_t naive_members_size(size_t mapcap) {
+    return mapcap * sizeof(NaiveMember) + naive_index_capacity(mapcap) * sizeof(NaiveIndexSlot);
+}
+
+static uint32_t naive_hash_key(const char* key, size_t keylen) {
+    const uint64_t k = 0x9E3779B97F4A7C15ULL;
+    uint64_t h = keylen * k;
+    uint64_t w;
+    for (; keylen >= 8; key += 8, keylen -= 8) {
+        memcpy(&w, key, 8);
+        h = (h ^ w) * k;
+        h ^= h >> 29;
     }
+    w = 0;
+    memcpy(&w, key, keylen);
+    h = (h ^ w) * k;
+    h ^= h >> 32;
+    return static_cast<uint32_t>(h);
+}
+
+static NaiveIndexSlot* naive_object_index(const NaiveValue* value, size_t* mask) {
+    size_t mapcap = naive_block_capacity(value->map);
+    *mask = naive_index_capacity(mapcap) - 1;
+    return reinterpret_cast<NaiveIndexSlot*>(value->map + mapcap);
+}
+
+static void naive_index_insert(NaiveValue* value, size_t index, uint32_t hash) {
+    size_t mask;
+    NaiveIndexSlot* slots = naive_object_index(value, &mask);
+    size_t pos = hash & mask;
+    while (slots[pos].index != 0)
+        pos = (pos + 1) & mask;
+    slots[pos].hash = hash;
+    slots[pos].index = static_cast<uint32_t>(index + 1);
+}
 
-    // 5. pop and free members on the stack
-    free(member.key);
-    for (size_t i = 0; i < maplen; i++) {
-        NaiveMember* m = static_cast<NaiveMember*>(naive_context_pop(context, sizeof(NaiveMember)));
-        free(m->key);
-        naive_free(&m->value);
+// every writer that moves or places members rebuilds the index, so lookups only ever read it
+static void naive_build_object_index(NaiveValue* value) {
+    if (naive_index_capacity(naive_block_capacity(value->map)) == 0) {
+        value->flags &= ~NAIVE_VALUE_INDEXED;
+        return;
     }
+    size_t mask;
+    NaiveIndexSlot* slots = naive_object_index(value, &mask);
+    memset(slots, 0, (mask + 1) * sizeof(NaiveIndexSlot));
+    for (size_t i = 0; i < value->maplen; i++)
+        naive_index_insert(value, i, naive_hash_key(value->map[i].key, value->map[i].keylen));
+    value->flags |= NAIVE_VALUE_INDEXED;
+}
+
+static NaiveMember* naive_alloc_members(NaiveArena* arena, size_t capacity) {
+    if (capacity == 0)
+        return nullptr;
+    unsigned char shift;
+    NaiveMember* map = static_cast<NaiveMember*>(naive_alloc_block(arena, capacity, naive_members_size(capacity), &shift));
+    for (size_t i = 0; i < capacity; i++)
+        map[i].value.chunk = shift;
+    return map;
+}
+
+// the arena's own slots are emptied in place and keep the stamp of their block
+static inline void naive_init_slot(NaiveValue* value) {
     value->type = NAIVE_NULL;
-    return ret;
+    value->flags = 0;
 }
 
-static int naive_parse_value(NaiveContext* context, NaiveValue* value) {
-    switch (*context->json) {
-        case 'n':
-            return naive_parse_literal(context, value, "null", NAIVE_NULL);
-        case 't':
-            return naive_parse_literal(context, value, "true", NAIVE_TRUE);
-        case 'f':
-            return naive_parse_literal(context, value, "false", NAIVE_FALSE);
-        case '"':
-            return naive_parse_string(context, value);
-        case '[':
-            return naive_parse_array(context, value);
-        case '{':
-            return naive_parse_object(context, value);
-        default:
-            return naive_parse_number(context, value);
-        case '\0':
-            return NAIVE_PARSE_EXPECT_VALUE;
+// copy values into the slots of one block, keeping the block's chunk stamp
+static void naive_place_elements(NaiveValue* slots, const NaiveValue* src, size_t count) {
+    if (count == 0)
+        return;
+    unsigned char shift = slots[0].chunk;
+    memcpy(slots, src, count * sizeof(NaiveValue));
+    for (size_t i = 0; i < count; i++)
+        slots[i].chunk = shift;
+}
+
+static void naive_place_members(NaiveMember* slots, const NaiveMember* src, size_t count) {
+    if (count == 0)
+        return;
+    unsigned char shift = slots[0].value.chunk;
+    memcpy(slots, src, count * sizeof(NaiveMember));
+    for (size_t i = 0; i < count; i++)
+        slots[i].value.chunk = shift;
+}
+
+#if defined(NAIVE_AVX2)
+static const char* naive_skip_whitespace(const char* p, const char* end) {
+    const __m256i space = _mm256_set1_epi8(' ');
+    const __m256i tab = _mm256_set1_epi8('\t');
+    const __m256i lf = _mm256_set1_epi8('\n');
+    const __m256i cr = _mm256_set1_epi8('\r');
+    for (; end - p >= 32; p += 32) {
+        const __m256i s = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+        __m256i ws = _mm256_or_si256(_mm256_cmpeq_epi8(s, space), _mm256_cmpeq_epi8(s, tab));
+        ws = _mm256_or_si256(ws, _mm256_or_si256(_mm256_cmpeq_epi8(s, lf), _mm256_cmpeq_epi8(s, cr)));
+        unsigned mask = ~static_cast<unsigned>(_mm256_movemask_epi8(ws));
+        if (mask != 0)
+            return p + naive_ctz(mask);
+    }
+    // the tail is shorter than a vector, loading it would read past `end`
+    while (p != end && ISWHITESPACE(*p))
+        p++;
+    return p;
+}
+#elif defined(NAIVE_SSE2)
+static const char* naive_skip_whitespace(const char* p, const char* end) {
+    const __m128i space = _mm_set1_epi8(' ');
+    const __m128i tab = _mm_set1_epi8('\t');
+    const __m128i lf = _mm_set1_epi8('\n');
+    const __m128i cr = _mm_set1_epi8('\r');
+    for (; end - p >= 16; p += 16) {
+        const __m128i s = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+        __m128i ws = _mm_or_si128(_mm_cmpeq_epi8(s, space), _mm_cmpeq_epi8(s, tab));
+        ws = _mm_or_si128(ws, _mm_or_si128(_mm_cmpeq_epi8(s, lf), _mm_cmpeq_epi8(s, cr)));
+        unsigned mask = ~static_cast<unsigned>(_mm_movemask_epi8(ws)) & 0xFFFF;
+        if (mask != 0)
+            return p + naive_ctz(mask);
+    }
+    // the tail is shorter than a vector, loading it would read past `end`
+    while (p != end && ISWHITESPACE(*p))
+        p++;
+    return p;
+}
+#else
+static const char* naive_skip_whitespace(const char* p, const char* end) {
+    while (p != end && ISWHITESPACE(*p))
+        p++;
+    return p;
+}
+#endif
+
+void naive_parse_whitespace(NaiveContext* context) {
+    const char* p = context->json;
+    // minified input and single spaces after ',' or ':' never need the vector loop
+    if (p == context->end || !ISWHITESPACE(*p))
+        return;
+    if (++p == context->end || !ISWHITESPACE(*p)) {
+        context->json = p;
+        return;
+    }
+    context->json = naive_skip_whitespace(p, context->end);
+}
+
+static int naive_parse_span(NaiveValue* value, const char* json, size_t len, NaiveArena* arena, unsigned flags);
+
+int naive_parse(NaiveValue* value, const char* json) {
+    return naive_parse_n(value, json, strlen(json), nullptr);
+}
+
+// with an arena every string, block and key of the document is carved from it and naive_free is O(1),
+// the memory comes back with naive_arena_reset
+int naive_parse(NaiveValue* value, const char* json, NaiveArena* arena) {
+    return naive_parse_n(value, json, strlen(json), arena);
+}
+
+int naive_parse_n(NaiveValue* value, const char* json, size_t len) {
+    return naive_parse_n(value, json, len, nullptr);
+}
+
+// parses exactly [json, json + len), the span needs no terminator and may be followed by anything
+int naive_parse_n(NaiveValue* value, const char* json, size_t len, NaiveArena* arena) {
+    return naive_parse_span(value, json, len, arena, 0);
+}
+
+int naive_parse_insitu(NaiveValue* value, char* json, size_t len) {
+    return naive_parse_span(value, json, len, nullptr, NAIVE_PARSE_INSITU);
+}
+
+// strings and keys are unescaped in place and point into `json`, which has to outlive the document;
+// containers still come from the heap or `arena`
+int naive_parse_insitu(NaiveValue* value, char* json, size_t len, NaiveArena* arena) {
+    return naive_parse_span(value, json, len, arena, NAIVE_PARSE_INSITU);
+}
+
+int naive_parse_raw(NaiveValue* value, const char* json, size_t len) {
+    return naive_parse_span(value, json, len, nullptr, NAIVE_PARSE_RAW);
+}
+
+// strings and numbers are validated but not decoded, they point at their source text in `json`, which has
+// to outlive the document. Only strings with escapes are decoded up front and integers converted, the
+// rest stringify as their source text. naive_get_string returns the span of a raw string, which is not
+// '\0'-terminated; number getters decode into a temporary and leave the document alone.
+int naive_parse_raw(NaiveValue* value, const char* json, size_t len, NaiveArena* arena) {
+    return naive_parse_span(value, json, len, arena, NAIVE_PARSE_RAW);
+}
+
+int naive_parse_file(const char* path, NaiveValue* value, unsigned flags) {
+    return naive_parse_file(path, value, flags, nullptr);
+}
+
+// the file is mapped read-only and parsed without a copy or a terminator. With NAIVE_PARSE_KEEP_MAPPING
+// (or NAIVE_PARSE_INSITU) it is mapped copy-on-write instead, strings and keys are decoded in place and
+// point into it, and the mapping lives until naive_arena_reset releases the document, so these flags
+// need an arena. NAIVE_PARSE_RAW keeps the mapping too.
+int naive_parse_file(const char* path, NaiveValue* value, unsigned flags, NaiveArena* arena) {
+    assert(path != nullptr && value != nullptr);
+    bool keep = (flags & (NAIVE_PARSE_KEEP_MAPPING | NAIVE_PARSE_INSITU | NAIVE_PARSE_RAW)) != 0;
+    unsigned parse_flags = keep ? NAIVE_PARSE_INSITU | (flags & NAIVE_PARSE_RAW) : 0;
+    naive_init(value);
+    // the document would point into a mapping nothing releases
+    if (keep && arena == nullptr)
+        return NAIVE_PARSE_INVALID_ARGUMENT;
+    int ret;
+#if !defined(_WIN32)
+    int fd = open(path, O_RDONLY);
+    if (fd < 0)
+        return NAIVE_PARSE_IO_ERROR;
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        close(fd);
+        return NAIVE_PARSE_IO_ERROR;
+    }
+    size_t size = static_cast<size_t>(st.st_size);
+    if (size == 0) {
+        close(fd);
+        return naive_parse_span(value, "", 0, arena, 0);
+    }
+    void* base = mmap(nullptr, size, keep ? PROT_READ | PROT_WRITE : PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (base == MAP_FAILED)
+        return NAIVE_PARSE_IO_ERROR;
+    madvise(base, size, MADV_SEQUENTIAL);
+    ret = naive_parse_span(value, static_cast<const char*>(base), size, arena, parse_flags);
+    if (keep && ret == NAIVE_PARSE_OK)
+        naive_arena_attach(arena, base, size, true);
+    else
+        munmap(base, size);
+#else
+    // no mapping here, the file is read into one buffer instead
+    FILE* fp = fopen(path, "rb");
+    if (fp == nullptr)
+        return NAIVE_PARSE_IO_ERROR;
+    char* base = nullptr;
+    size_t size = 0, capacity = 0, n;
+    do {
+        if (size == capacity) {
+            capacity = capacity ? capacity * 2 : 65536;
+            base = static_cast<char*>(realloc(base, capacity));
+        }
+        size += n = fread(base + size, 1, capacity - size, fp);
+    } while (n > 0);
+    bool failed = ferror(fp) != 0;
+    fclose(fp);
+    if (failed) {
+        free(base);
+        return NAIVE_PARSE_IO_ERROR;
+    }
+    ret = naive_parse_span(value, base, size, arena, parse_flags);
+    if (keep && ret == NAIVE_PARSE_OK)
+        naive_arena_attach(arena, base, size, false);
+    else
+        free(base);
+#endif
+    return ret;
+}
+
+static void naive_context_init(NaiveContext* context, const char* json, size_t len, NaiveArena* arena,
+                               unsigned flags) {
+    assert(json != nullptr || len == 0);
+    context->json = json;
+    context->end = json + len;
+    context->stack = nullptr;
+    context->size = context->top = 0;
+    context->arena = arena;
+    context->flags = flags;
+    context->sink = nullptr;
+    context->intern = nullptr;
+    context->frames = nullptr;
+    context->depth = context->frames_size = 0;
+    context->max_depth = NAIVE_PARSE_MAX_DEPTH;
+}
+
+// the document in `context` as the single root value, the stack is left to the caller
+static int naive_parse_document(NaiveContext* context, NaiveValue* value) {
+    assert(value != nullptr);
+    naive_init(value);
+    naive_parse_whitespace(context);
+    int ret;
+    if ((ret = naive_parse_value(context, value)) == NAIVE_PARSE_OK) {
+        naive_parse_whitespace(context);
+        if (context->json != context->end) {
+            naive_free(value);
+            ret = NAIVE_PARSE_ROOT_NOT_SINGULAR;
+        }
+    }
+    assert(context->top == 0);
+    return ret;
+}
+
+static int naive_parse_root(NaiveContext* context, NaiveValue* value) {
+    int ret;
+    try {
+        ret = naive_parse_document(context, value);
+    } catch (...) {
+        free(context->stack);
+        throw;
+    }
+    free(context->stack);
+    return ret;
+}
+
+static int naive_parse_span(NaiveValue* value, const char* json, size_t len, NaiveArena* arena, unsigned flags) {
+    NaiveContext context;
+    naive_context_init(&context, json, len, arena, flags);
+    return naive_parse_root(&context, value);
+}
+
+// keys (and strings up to pool->max_string bytes) point into `pool` instead of being copied per document.
+// Containers nested deeper than `max_depth` fail with NAIVE_PARSE_TOO_DEEP; free, copy, compare and
+// stringify recurse once per level, so a tree always has a limit and 0 is not one
+int naive_parse_n(NaiveValue* value, const char* json, size_t len, NaiveArena* arena, NaiveInternPool* pool,
+                  size_t max_depth) {
+    assert(max_depth > 0);
+    NaiveContext context;
+    naive_context_init(&context, json, len, arena, 0);
+    context.intern = pool;
+    context.max_depth = max_depth;
+    return naive_parse_root(&context, value);
+}
+
+// NDJSON: the buffer is cut into one part per thread at line breaks, which never occur inside a JSON
+// value, and each worker parses the lines of its part into its own record array. With several workers
+// each one also has an arena and a pool of its own, merged into the caller's once all of them are done
+static const size_t NAIVE_NDJSON_MIN_PART = 64 * 1024;
+
+struct NaiveNdjsonPart {
+    const char* begin;
+    const char* end;
+    NaiveInternPool* pool;
+    NaiveArena* arena;
+    NaiveInternPool cache; // the strings missing from the caller's pool
+    NaiveArena local;
+    NaiveContext context;  // its stack is kept from one line to the next
+    NaiveRecord* records;
+    size_t count, capacity;
+    bool failed; // ran out of memory
+};
+
+static void naive_parse_ndjson_part(const char* json, NaiveNdjsonPart* part) {
+    const char* p = part->begin;
+    try {
+        while (p != part->end) {
+            const char* line = p;
+            const char* eol = static_cast<const char*>(memchr(p, '\n', part->end - p));
+            p = eol ? eol + 1 : part->end;
+            if (eol == nullptr)
+                eol = part->end;
+            // blank lines separate nothing and are skipped
+            const char* q = line;
+            while (q != eol && ISWHITESPACE(*q))
+                q++;
+            if (q == eol)
+                continue;
+            if (part->count == part->capacity) {
+                size_t capacity = part->capacity ? part->capacity + (part->capacity >> 1) : 64;
+                NaiveRecord* records = static_cast<NaiveRecord*>(realloc(part->records, capacity * sizeof(NaiveRecord)));
+                if (records == nullptr)
+                    throw std::bad_alloc();
+                part->records = records;
+                part->capacity = capacity;
+            }
+            NaiveRecord* record = part->records + part->count++;
+            record->offset = line - json;
+            record->len = eol - line;
+            char* stack = part->context.stack;
+            size_t size = part->context.size;
+            naive_context_init(&part->context, line, eol - line, part->arena, 0);
+            part->context.stack = stack;
+            part->context.size = size;
+            part->context.intern = part->pool;
+            record->error = naive_parse_document(&part->context, &record->value);
+        }
+    } catch (const std::bad_alloc&) {
+        part->failed = true;
+    }
+    free(part->context.stack);
+}
+
+// parses every non-blank line of [json, json + len) on up to `threads` threads (0 for one per core) and
+// returns the record count, *records is in input order and goes back with naive_free_records
+size_t naive_parse_ndjson(const char* json, size_t len, NaiveRecord** records, unsigned threads) {
+    return naive_parse_ndjson(json, len, records, threads, nullptr);
+}
+
+// the records share the keys of `pool`: each worker only reads it and pools what it misses on its own,
+// so two workers may keep a copy each of a string that was new to the pool
+size_t naive_parse_ndjson(const char* json, size_t len, NaiveRecord** records, unsigned threads,
+                          NaiveInternPool* pool) {
+    return naive_parse_ndjson(json, len, records, threads, pool, nullptr);
+}
+
+// the records' payloads come from `arena`, which has to outlive them; naive_free_records still frees the
+// record array
+size_t naive_parse_ndjson(const char* json, size_t len, NaiveRecord** records, unsigned threads,
+                          NaiveInternPool* pool, NaiveArena* arena) {
+    assert((json != nullptr || len == 0) && records != nullptr);
+    if (threads == 0)
+        threads = std::thread::hardware_concurrency();
+    // small inputs are not worth a thread per part
+    size_t parts = len / NAIVE_NDJSON_MIN_PART + 1;
+    if (parts > threads)
+        parts = threads ? threads : 1;
+    std::vector<NaiveNdjsonPart> part(parts);
+    const char* begin = json;
+    for (size_t i = 0; i < parts; i++) {
+        const char* end = json + len * (i + 1) / parts;
+        if (end < begin)
+            end = begin;
+        const char* eol = i + 1 < parts ? static_cast<const char*>(memchr(end, '\n', json + len - end)) : nullptr;
+        end = eol ? eol + 1 : json + len;
+        part[i].begin = begin;
+        part[i].end = end;
+        part[i].pool = pool;
+        part[i].arena = arena;
+        if (pool != nullptr && parts > 1) {
+            naive_intern_init(&part[i].cache, pool->max_string);
+            part[i].cache.base = pool;
+            part[i].pool = &part[i].cache;
+        }
+        if (arena != nullptr && parts > 1) {
+            naive_arena_init(&part[i].local, arena->chunk_size);
+            part[i].arena = &part[i].local;
+        }
+        part[i].context.stack = nullptr;
+        part[i].context.size = 0;
+        part[i].records = nullptr;
+        part[i].count = part[i].capacity = 0;
+        part[i].failed = false;
+        begin = end;
+    }
+    // the first part is parsed on the calling thread
+    std::vector<std::thread> workers;
+    workers.reserve(parts - 1);
+    for (size_t i = 1; i < parts; i++)
+        workers.push_back(std::thread(naive_parse_ndjson_part, json, &part[i]));
+    naive_parse_ndjson_part(json, &part[0]);
+    for (size_t i = 0; i < workers.size(); i++)
+        workers[i].join();
+
+    size_t count = 0, pooled = pool != nullptr ? pool->count : 0;
+    bool failed = false;
+    for (size_t i = 0; i < parts; i++) {
+        count += part[i].count;
+        failed |= part[i].failed;
+        if (part[i].pool != pool)
+            pooled += part[i].pool->count;
+    }
+    if (pool != nullptr && parts > 1) {
+        try {
+            naive_intern_reserve(pool, pooled);
+        } catch (const std::bad_alloc&) {
+            failed = true;
+        }
+    }
+    // the workers' arenas and pools go to the caller's, or with the records on failure
+    for (size_t i = 0; i < parts; i++) {
+        if (part[i].arena != arena) {
+            if (failed)
+                naive_arena_destroy(&part[i].local);
+            else
+                naive_arena_adopt(arena, &part[i].local);
+        }
+        if (part[i].pool != pool) {
+            if (failed)
+                naive_intern_destroy(&part[i].cache);
+            else
+                naive_intern_merge(pool, &part[i].cache);
+        }
+    }
+    if (failed) {
+        for (size_t i = 0; i < parts; i++)
+            naive_free_records(part[i].records, part[i].count);
+        throw std::bad_alloc();
+    }
+    NaiveRecord* all = part[0].records;
+    if (parts > 1) {
+        if ((all = static_cast<NaiveRecord*>(malloc(count * sizeof(NaiveRecord) + 1))) == nullptr) {
+            for (size_t i = 0; i < parts; i++)
+                naive_free_records(part[i].records, part[i].count);
+            throw std::bad_alloc();
+        }
+        // heap values own their payloads through pointers, moving them is a copy of their bytes
+        size_t n = 0;
+        for (size_t i = 0; i < parts; i++) {
+            if (part[i].count)
+                memcpy(all + n, part[i].records, part[i].count * sizeof(NaiveRecord));
+            n += part[i].count;
+            free(part[i].records);
+        }
+    }
+    *records = all;
+    return count;
+}
+
+void naive_free_records(NaiveRecord* records, size_t count) {
+    for (size_t i = 0; i < count; i++)
+        naive_free(&records[i].value);
+    free(records);
+}
+
+void naive_free(NaiveValue* value) {
+    // called before set
+    assert(value != nullptr);
+    // arena payloads (and everything below them) are released by naive_arena_reset
+    if (!(value->flags & NAIVE_VALUE_SHARED)) {
+        switch (value->type) {
+            case NAIVE_STRING:
+                if (!(value->flags & NAIVE_VALUE_INLINE))
+                    free(value->str);
+                break;
+            case NAIVE_ARRAY:
+                for (size_t i = 0; i < value->arrlen; i++) {
+                    naive_free(&value->arr[i]);
+                }
+                naive_free_block(value->arr);
+                break;
+            case NAIVE_OBJECT:
+                for (size_t i = 0; i < value->maplen; i++) {
+                    if (!(value->flags & NAIVE_VALUE_BORROWED))
+                        free(value->map[i].key);
+                    naive_free(&value->map[i].value);
+                }
+                naive_free_block(value->map);
+                break;
+            default:
+                break;
+        }
+    }
+    value->type = NAIVE_NULL;
+    value->flags = 0;
+}
+
+static int naive_parse_literal(NaiveContext* context, const char* literal) {
+    // compare with null、true、false
+    size_t i = 0;
+    // TODO: remove EXPECT?
+    EXPECT(context, literal[0]);
+    // compared with literal value by character
+    for (i = 0; literal[i + 1] != '\0'; ++i) {
+        if (context->json + i == context->end || context->json[i] != literal[i + 1])
+            return NAIVE_PARSE_INVALID_VALUE;
+    }
+    context->json += i;
+    return NAIVE_PARSE_OK;
+}
+
+int naive_parse_literal(NaiveContext* context, NaiveValue* value, const char* literal, NaiveType type) {
+    int ret;
+    if ((ret = naive_parse_literal(context, literal)) == NAIVE_PARSE_OK)
+        value->type = type;
+    return ret;
+}
+
+// 128-bit approximations (rounded down) of 10^e for e in [-348, 347], normalized so the top bit is set,
+// stored as {high, low}
+static const int NAIVE_POW10_MIN_EXP = -348;
+static const int NAIVE_POW10_MAX_EXP = 347;
+static const uint64_t naive_pow10_table[][2] = {
+    {0xFA8FD5A0081C0288, 0x1732C869CD60E453}, {0x9C99E58405118195, 0x0E7FBD42205C8EB4},
+    {0xC3C05EE50655E1FA, 0x521FAC92A873B261}, {0xF4B0769E47EB5A78, 0xE6A797B752909EF9},
+    {0x98EE4A22ECF3188B, 0x9028BED2939A635C}, {0xBF29DCABA82FDEAE, 0x7432EE873880FC33},
+    {0xEEF453D6923BD65A, 0x113FAA2906A13B3F}, {0x9558B4661B6565F8, 0x4AC7CA59A424C507},
+    {0xBAAEE17FA23EBF76, 0x5D79BCF00D2DF649}, {0xE95A99DF8ACE6F53, 0xF4D82C2C107973DC},
+    {0x91D8A02BB6C10594, 0x79071B9B8A4BE869}, {0xB64EC836A47146F9, 0x9748E2826CDEE284},
+    {0xE3E27A444D8D98B7, 0xFD1B1B2308169B25}, {0x8E6D8C6AB0787F72, 0xFE30F0F5E50E20F7},
+    {0xB208EF855C969F4F, 0xBDBD2D335E51A935}, {0xDE8B2B66B3BC4723, 0xAD2C788035E61382},
+    {0x8B16FB203055AC76, 0x4C3BCB5021AFCC31}, {0xADDCB9E83C6B1793, 0xDF4ABE242A1BBF3D},
+    {0xD953E8624B85DD78, 0xD71D6DAD34A2AF0D}, {0x87D4713D6F33AA6B, 0x8672648C40E5AD68},
+    {0xA9C98D8CCB009506, 0x680EFDAF511F18C2}, {0xD43BF0EFFDC0BA48, 0x0212BD1B2566DEF2},
+    {0x84A57695FE98746D, 0x014BB630F7604B57}, {0xA5CED43B7E3E9188, 0x419EA3BD35385E2D},
+    {0xCF42894A5DCE35EA, 0x52064CAC828675B9}, {0x818995CE7AA0E1B2, 0x7343EFEBD1940993},
+    {0xA1EBFB4219491A1F, 0x1014EBE6C5F90BF8}, {0xCA66FA129F9B60A6, 0xD41A26E077774EF6},
+    {0xFD00B897478238D0, 0x8920B098955522B4}, {0x9E20735E8CB16382, 0x55B46E5F5D5535B0},
+    {0xC5A890362FDDBC62, 0xEB2189F734AA831D}, {0xF712B443BBD52B7B, 0xA5E9EC7501D523E4},
+    {0x9A6BB0AA55653B2D, 0x47B233C92125366E}, {0xC1069CD4EABE89F8, 0x999EC0BB696E840A},
+    {0xF148440A256E2C76, 0xC00670EA43CA250D}, {0x96CD2A865764DBCA, 0x380406926A5E5728},
+    {0xBC807527ED3E12BC, 0xC605083704F5ECF2}, {0xEBA09271E88D976B, 0xF7864A44C633682E},
+    {0x93445B8731587EA3, 0x7AB3EE6AFBE0211D}, {0xB8157268FDAE9E4C, 0x5960EA05BAD82964},
+    {0xE61ACF033D1A45DF, 0x6FB92487298E33BD}, {0x8FD0C16206306BAB, 0xA5D3B6D479F8E056},
+    {0xB3C4F1BA87BC8696, 0x8F48A4899877186C}, {0xE0B62E2929ABA83C, 0x331ACDABFE94DE87},
+    {0x8C71DCD9BA0B4925, 0x9FF0C08B7F1D0B14}, {0xAF8E5410288E1B6F, 0x07ECF0AE5EE44DD9},
+    {0xDB71E91432B1A24A, 0xC9E82CD9F69D6150}, {0x892731AC9FAF056E, 0xBE311C083A225CD2},
+    {0xAB70FE17C79AC6CA, 0x6DBD630A48AAF406}, {0xD64D3D9DB981787D, 0x092CBBCCDAD5B108},
+    {0x85F0468293F0EB4E, 0x25BBF56008C58EA5}, {0xA76C582338ED2621, 0xAF2AF2B80AF6F24E},
+    {0xD1476E2C07286FAA, 0x1AF5AF660DB4AEE1}, {0x82CCA4DB847945CA, 0x50D98D9FC890ED4D},
+    {0xA37FCE126597973C, 0xE50FF107BAB528A0}, {0xCC5FC196FEFD7D0C, 0x1E53ED49A96272C8},
+    {0xFF77B1FCBEBCDC4F, 0x25E8E89C13BB0F7A}, {0x9FAACF3DF73609B1, 0x77B191618C54E9AC},
+    {0xC795830D75038C1D, 0xD59DF5B9EF6A2417}, {0xF97AE3D0D2446F25, 0x4B0573286B44AD1D},
+    {0x9BECCE62836AC577, 0x4EE367F9430AEC32}, {0xC2E801FB244576D5, 0x229C41F793CDA73F},
+    {0xF3A20279ED56D48A, 0x6B43527578C1110F}, {0x9845418C345644D6, 0x830A13896B78AAA9},
+    {0xBE5691EF416BD60C, 0x23CC986BC656D553}, {0xEDEC366B11C6CB8F, 0x2CBFBE86B7EC8AA8},
+    {0x94B3A202EB1C3F39, 0x7BF7D71432F3D6A9}, {0xB9E08A83A5E34F07, 0xDAF5CCD93FB0CC53},
+    {0xE858AD248F5C22C9, 0xD1B3400F8F9CFF68}, {0x91376C36D99995BE, 0x23100809B9C21FA1},
+    {0xB58547448FFFFB2D, 0xABD40A0C2832A78A}, {0xE2E69915B3FFF9F9, 0x16C90C8F323F516C},
+    {0x8DD01FAD907FFC3B, 0xAE3DA7D97F6792E3}, {0xB1442798F49FFB4A, 0x99CD11CFDF41779C},
+    {0xDD95317F31C7FA1D, 0x40405643D711D583}, {0x8A7D3EEF7F1CFC52, 0x482835EA666B2572},
+    {0xAD1C8EAB5EE43B66, 0xDA3243650005EECF}, {0xD863B256369D4A40, 0x90BED43E40076A82},
+    {0x873E4F75E2224E68, 0x5A7744A6E804A291}, {0xA90DE3535AAAE202, 0x711515D0A205CB36},
+    {0xD3515C2831559A83, 0x0D5A5B44CA873E03}, {0x8412D9991ED58091, 0xE858790AFE9486C2},
+    {0xA5178FFF668AE0B6, 0x626E974DBE39A872}, {0xCE5D73FF402D98E3, 0xFB0A3D212DC8128F},
+    {0x80FA687F881C7F8E, 0x7CE66634BC9D0B99}, {0xA139029F6A239F72, 0x1C1FFFC1EBC44E80},
+    {0xC987434744AC874E, 0xA327FFB266B56220}, {0xFBE9141915D7A922, 0x4BF1FF9F0062BAA8},
+    {0x9D71AC8FADA6C9B5, 0x6F773FC3603DB4A9}, {0xC4CE17B399107C22, 0xCB550FB4384D21D3},
+    {0xF6019DA07F549B2B, 0x7E2A53A146606A48}, {0x99C102844F94E0FB, 0x2EDA7444CBFC426D},
+    {0xC0314325637A1939, 0xFA911155FEFB5308}, {0xF03D93EEBC589F88, 0x793555AB7EBA27CA},
+    {0x96267C7535B763B5, 0x4BC1558B2F3458DE}, {0xBBB01B9283253CA2, 0x9EB1AAEDFB016F16},
+    {0xEA9C227723EE8BCB, 0x465E15A979C1CADC}, {0x92A1958A7675175F, 0x0BFACD89EC191EC9},
+    {0xB749FAED14125D36, 0xCEF980EC671F667B}, {0xE51C79A85916F484, 0x82B7E12780E7401A},
+    {0x8F31CC0937AE58D2, 0xD1B2ECB8B0908810}, {0xB2FE3F0B8599EF07, 0x861FA7E6DCB4AA15},
+    {0xDFBDCECE67006AC9, 0x67A791E093E1D49A}, {0x8BD6A141006042BD, 0xE0C8BB2C5C6D24E0},
+    {0xAECC49914078536D, 0x58FAE9F773886E18}, {0xDA7F5BF590966848, 0xAF39A475506A899E},
+    {0x888F99797A5E012D, 0x6D8406C952429603}, {0xAAB37FD7D8F58178, 0xC8E5087BA6D33B83},
+    {0xD5605FCDCF32E1D6, 0xFB1E4A9A90880A64}, {0x855C3BE0A17FCD26, 0x5CF2EEA09A55067F},
+    {0xA6B34AD8C9DFC06F, 0xF42FAA48C0EA481E}, {0xD0601D8EFC57B08B, 0xF13B94DAF124DA26},
+    {0x823C12795DB6CE57, 0x76C53D08D6B70858}, {0xA2CB1717B52481ED, 0x54768C4B0C64CA6E},
+    {0xCB7DDCDDA26DA268, 0xA9942F5DCF7DFD09}, {0xFE5D54150B090B02, 0xD3F93B35435D7C4C},
+    {0x9EFA548D26E5A6E1, 0xC47BC5014A1A6DAF}, {0xC6B8E9B0709F109A, 0x359AB6419CA1091B},
+    {0xF867241C8CC6D4C0, 0xC30163D203C94B62}, {0x9B407691D7FC44F8, 0x79E0DE63425DCF1D},
+    {0xC21094364DFB5636, 0x985915FC12F542E4}, {0xF294B943E17A2BC4, 0x3E6F5B7B17B2939D},
+    {0x979CF3CA6CEC5B5A, 0xA705992CEECF9C42}, {0xBD8430BD08277231, 0x50C6FF782A838353},
+    {0xECE53CEC4A314EBD, 0xA4F8BF5635246428}, {0x940F4613AE5ED136, 0x871B7795E136BE99},
+    {0xB913179899F68584, 0x28E2557B59846E3F}, {0xE757DD7EC07426E5, 0x331AEADA2FE589CF},
+    {0x9096EA6F3848984F, 0x3FF0D2C85DEF7621}, {0xB4BCA50B065ABE63, 0x0FED077A756B53A9},
+    {0xE1EBCE4DC7F16DFB, 0xD3E8495912C62894}, {0x8D3360F09CF6E4BD, 0x64712DD7ABBBD95C},
+    {0xB080392CC4349DEC, 0xBD8D794D96AACFB3}, {0xDCA04777F541C567, 0xECF0D7A0FC5583A0},
+    {0x89E42CAAF9491B60, 0xF41686C49DB57244}, {0xAC5D37D5B79B6239, 0x311C2875C522CED5},
+    {0xD77485CB25823AC7, 0x7D633293366B828B}, {0x86A8D39EF77164BC, 0xAE5DFF9C02033197},
+    {0xA8530886B54DBDEB, 0xD9F57F830283FDFC}, {0xD267CAA862A12D66, 0xD072DF63C324FD7B},
+    {0x8380DEA93DA4BC60, 0x4247CB9E59F71E6D}, {0xA46116538D0DEB78, 0x52D9BE85F074E608},
+    {0xCD795BE870516656, 0x67902E276C921F8B}, {0x806BD9714632DFF6, 0x00BA1CD8A3DB53B6},
+    {0xA086CFCD97BF97F3, 0x80E8A40ECCD228A4}, {0xC8A883C0FDAF7DF0, 0x6122CD128006B2CD},
+    {0xFAD2A4B13D1B5D6C, 0x796B805720085F81}, {0x9CC3A6EEC6311A63, 0xCBE3303674053BB0},
+    {0xC3F490AA77BD60FC, 0xBEDBFC4411068A9C}, {0xF4F1B4D515ACB93B, 0xEE92FB5515482D44},
+    {0x991711052D8BF3C5, 0x751BDD152D4D1C4A}, {0xBF5CD54678EEF0B6, 0xD262D45A78A0635D},
+    {0xEF340A98172AACE4, 0x86FB897116C87C34}, {0x9580869F0E7AAC0E, 0xD45D35E6AE3D4DA0},
+    {0xBAE0A846D2195712, 0x8974836059CCA109}, {0xE998D258869FACD7, 0x2BD1A438703FC94B},
+    {0x91FF83775423CC06, 0x7B6306A34627DDCF}, {0xB67F6455292CBF08, 0x1A3BC84C17B1D542},
+    {0xE41F3D6A7377EECA, 0x20CABA5F1D9E4A93}, {0x8E938662882AF53E, 0x547EB47B7282EE9C},
+    {0xB23867FB2A35B28D, 0xE99E619A4F23AA43}, {0xDEC681F9F4C31F31, 0x6405FA00E2EC94D4},
+    {0x8B3C113C38F9F37E, 0xDE83BC408DD3DD04}, {0xAE0B158B4738705E, 0x9624AB50B148D445},
+    {0xD98DDAEE19068C76, 0x3BADD624DD9B0957}, {0x87F8A8D4CFA417C9, 0xE54CA5D70A80E5D6},
+    {0xA9F6D30A038D1DBC, 0x5E9FCF4CCD211F4C}, {0xD47487CC8470652B, 0x7647C3200069671F},
+    {0x84C8D4DFD2C63F3B, 0x29ECD9F40041E073}, {0xA5FB0A17C777CF09, 0xF468107100525890},
+    {0xCF79CC9DB955C2CC, 0x7182148D4066EEB4}, {0x81AC1FE293D599BF, 0xC6F14CD848405530},
+    {0xA21727DB38CB002F, 0xB8ADA00E5A506A7C}, {0xCA9CF1D206FDC03B, 0xA6D90811F0E4851C},
+    {0xFD442E4688BD304A, 0x908F4A166D1DA663}, {0x9E4A9CEC15763E2E, 0x9A598E4E043287FE},
+    {0xC5DD44271AD3CDBA, 0x40EFF1E1853F29FD}, {0xF7549530E188C128, 0xD12BEE59E68EF47C},
+    {0x9A94DD3E8CF578B9, 0x82BB74F8301958CE}, {0xC13A148E3032D6E7, 0xE36A52363C1FAF01},
+    {0xF18899B1BC3F8CA1, 0xDC44E6C3CB279AC1}, {0x96F5600F15A7B7E5, 0x29AB103A5EF8C0B9},
+    {0xBCB2B812DB11A5DE, 0x7415D448F6B6F0E7}, {0xEBDF661791D60F56, 0x111B495B3464AD21},
+    {0x936B9FCEBB25C995, 0xCAB10DD900BEEC34}, {0xB84687C269EF3BFB, 0x3D5D514F40EEA742},
+    {0xE65829B3046B0AFA, 0x0CB4A5A3112A5112}, {0x8FF71A0FE2C2E6DC, 0x47F0E785EABA72AB},
+    {0xB3F4E093DB73A093, 0x59ED216765690F56}, {0xE0F218B8D25088B8, 0x306869C13EC3532C},
+    {0x8C974F7383725573, 0x1E414218C73A13FB}, {0xAFBD2350644EEACF, 0xE5D1929EF90898FA},
+    {0xDBAC6C247D62A583, 0xDF45F746B74ABF39}, {0x894BC396CE5DA772, 0x6B8BBA8C328EB783},
+    {0xAB9EB47C81F5114F, 0x066EA92F3F326564}, {0xD686619BA27255A2, 0xC80A537B0EFEFEBD},
+    {0x8613FD0145877585, 0xBD06742CE95F5F36}, {0xA798FC4196E952E7, 0x2C48113823B73704},
+    {0xD17F3B51FCA3A7A0, 0xF75A15862CA504C5}, {0x82EF85133DE648C4, 0x9A984D73DBE722FB},
+    {0xA3AB66580D5FDAF5, 0xC13E60D0D2E0EBBA}, {0xCC963FEE10B7D1B3, 0x318DF905079926A8},
+    {0xFFBBCFE994E5C61F, 0xFDF17746497F7052}, {0x9FD561F1FD0F9BD3, 0xFEB6EA8BEDEFA633},
+    {0xC7CABA6E7C5382C8, 0xFE64A52EE96B8FC0}, {0xF9BD690A1B68637B, 0x3DFDCE7AA3C673B0},
+    {0x9C1661A651213E2D, 0x06BEA10CA65C084E}, {0xC31BFA0FE5698DB8, 0x486E494FCFF30A62},
+    {0xF3E2F893DEC3F126, 0x5A89DBA3C3EFCCFA}, {0x986DDB5C6B3A76B7, 0xF89629465A75E01C},
+    {0xBE89523386091465, 0xF6BBB397F1135823}, {0xEE2BA6C0678B597F, 0x746AA07DED582E2C},
+    {0x94DB483840B717EF, 0xA8C2A44EB4571CDC}, {0xBA121A4650E4DDEB, 0x92F34D62616CE413},
+    {0xE896A0D7E51E1566, 0x77B020BAF9C81D17}, {0x915E2486EF32CD60, 0x0ACE1474DC1D122E},
+    {0xB5B5ADA8AAFF80B8, 0x0D819992132456BA}, {0xE3231912D5BF60E6, 0x10E1FFF697ED6C69},
+    {0x8DF5EFABC5979C8F, 0xCA8D3FFA1EF463C1}, {0xB1736B96B6FD83B3, 0xBD308FF8A6B17CB2},
+    {0xDDD0467C64BCE4A0, 0xAC7CB3F6D05DDBDE}, {0x8AA22C0DBEF60EE4, 0x6BCDF07A423AA96B},
+    {0xAD4AB7112EB3929D, 0x86C16C98D2C953C6}, {0xD89D64D57A607744, 0xE871C7BF077BA8B7},
+    {0x87625F056C7C4A8B, 0x11471CD764AD4972}, {0xA93AF6C6C79B5D2D, 0xD598E40D3DD89BCF},
+    {0xD389B47879823479, 0x4AFF1D108D4EC2C3}, {0x843610CB4BF160CB, 0xCEDF722A585139BA},
+    {0xA54394FE1EEDB8FE, 0xC2974EB4EE658828}, {0xCE947A3DA6A9273E, 0x733D226229FEEA32},
+    {0x811CCC668829B887, 0x0806357D5A3F525F}, {0xA163FF802A3426A8, 0xCA07C2DCB0CF26F7},
+    {0xC9BCFF6034C13052, 0xFC89B393DD02F0B5}, {0xFC2C3F3841F17C67, 0xBBAC2078D443ACE2},
+    {0x9D9BA7832936EDC0, 0xD54B944B84AA4C0D}, {0xC5029163F384A931, 0x0A9E795E65D4DF11},
+    {0xF64335BCF065D37D, 0x4D4617B5FF4A16D5}, {0x99EA0196163FA42E, 0x504BCED1BF8E4E45},
+    {0xC06481FB9BCF8D39, 0xE45EC2862F71E1D6}, {0xF07DA27A82C37088, 0x5D767327BB4E5A4C},
+    {0x964E858C91BA2655, 0x3A6A07F8D510F86F}, {0xBBE226EFB628AFEA, 0x890489F70A55368B},
+    {0xEADAB0ABA3B2DBE5, 0x2B45AC74CCEA842E}, {0x92C8AE6B464FC96F, 0x3B0B8BC90012929D},
+    {0xB77ADA0617E3BBCB, 0x09CE6EBB40173744}, {0xE55990879DDCAABD, 0xCC420A6A101D0515},
+    {0x8F57FA54C2A9EAB6, 0x9FA946824A12232D}, {0xB32DF8E9F3546564, 0x47939822DC96ABF9},
+    {0xDFF9772470297EBD, 0x59787E2B93BC56F7}, {0x8BFBEA76C619EF36, 0x57EB4EDB3C55B65A},
+    {0xAEFAE51477A06B03, 0xEDE622920B6B23F1}, {0xDAB99E59958885C4, 0xE95FAB368E45ECED},
+    {0x88B402F7FD75539B, 0x11DBCB0218EBB414}, {0xAAE103B5FCD2A881, 0xD652BDC29F26A119},
+    {0xD59944A37C0752A2, 0x4BE76D3346F0495F}, {0x857FCAE62D8493A5, 0x6F70A4400C562DDB},
+    {0xA6DFBD9FB8E5B88E, 0xCB4CCD500F6BB952}, {0xD097AD07A71F26B2, 0x7E2000A41346A7A7},
+    {0x825ECC24C873782F, 0x8ED400668C0C28C8}, {0xA2F67F2DFA90563B, 0x728900802F0F32FA},
+    {0xCBB41EF979346BCA, 0x4F2B40A03AD2FFB9}, {0xFEA126B7D78186BC, 0xE2F610C84987BFA8},
+    {0x9F24B832E6B0F436, 0x0DD9CA7D2DF4D7C9}, {0xC6EDE63FA05D3143, 0x91503D1C79720DBB},
+    {0xF8A95FCF88747D94, 0x75A44C6397CE912A}, {0x9B69DBE1B548CE7C, 0xC986AFBE3EE11ABA},
+    {0xC24452DA229B021B, 0xFBE85BADCE996168}, {0xF2D56790AB41C2A2, 0xFAE27299423FB9C3},
+    {0x97C560BA6B0919A5, 0xDCCD879FC967D41A}, {0xBDB6B8E905CB600F, 0x5400E987BBC1C920},
+    {0xED246723473E3813, 0x290123E9AAB23B68}, {0x9436C0760C86E30B, 0xF9A0B6720AAF6521},
+    {0xB94470938FA89BCE, 0xF808E40E8D5B3E69}, {0xE7958CB87392C2C2, 0xB60B1D1230B20E04},
+    {0x90BD77F3483BB9B9, 0xB1C6F22B5E6F48C2}, {0xB4ECD5F01A4AA828, 0x1E38AEB6360B1AF3},
+    {0xE2280B6C20DD5232, 0x25C6DA63C38DE1B0}, {0x8D590723948A535F, 0x579C487E5A38AD0E},
+    {0xB0AF48EC79ACE837, 0x2D835A9DF0C6D851}, {0xDCDB1B2798182244, 0xF8E431456CF88E65},
+    {0x8A08F0F8BF0F156B, 0x1B8E9ECB641B58FF}, {0xAC8B2D36EED2DAC5, 0xE272467E3D222F3F},
+    {0xD7ADF884AA879177, 0x5B0ED81DCC6ABB0F}, {0x86CCBB52EA94BAEA, 0x98E947129FC2B4E9},
+    {0xA87FEA27A539E9A5, 0x3F2398D747B36224}, {0xD29FE4B18E88640E, 0x8EEC7F0D19A03AAD},
+    {0x83A3EEEEF9153E89, 0x1953CF68300424AC}, {0xA48CEAAAB75A8E2B, 0x5FA8C3423C052DD7},
+    {0xCDB02555653131B6, 0x3792F412CB06794D}, {0x808E17555F3EBF11, 0xE2BBD88BBEE40BD0},
+    {0xA0B19D2AB70E6ED6, 0x5B6ACEAEAE9D0EC4}, {0xC8DE047564D20A8B, 0xF245825A5A445275},
+    {0xFB158592BE068D2E, 0xEED6E2F0F0D56712}, {0x9CED737BB6C4183D, 0x55464DD69685606B},
+    {0xC428D05AA4751E4C, 0xAA97E14C3C26B886}, {0xF53304714D9265DF, 0xD53DD99F4B3066A8},
+    {0x993FE2C6D07B7FAB, 0xE546A8038EFE4029}, {0xBF8FDB78849A5F96, 0xDE98520472BDD033},
+    {0xEF73D256A5C0F77C, 0x963E66858F6D4440}, {0x95A8637627989AAD, 0xDDE7001379A44AA8},
+    {0xBB127C53B17EC159, 0x5560C018580D5D52}, {0xE9D71B689DDE71AF, 0xAAB8F01E6E10B4A6},
+    {0x9226712162AB070D, 0xCAB3961304CA70E8}, {0xB6B00D69BB55C8D1, 0x3D607B97C5FD0D22},
+    {0xE45C10C42A2B3B05, 0x8CB89A7DB77C506A}, {0x8EB98A7A9A5B04E3, 0x77F3608E92ADB242},
+    {0xB267ED1940F1C61C, 0x55F038B237591ED3}, {0xDF01E85F912E37A3, 0x6B6C46DEC52F6688},
+    {0x8B61313BBABCE2C6, 0x2323AC4B3B3DA015}, {0xAE397D8AA96C1B77, 0xABEC975E0A0D081A},
+    {0xD9C7DCED53C72255, 0x96E7BD358C904A21}, {0x881CEA14545C7575, 0x7E50D64177DA2E54},
+    {0xAA242499697392D2, 0xDDE50BD1D5D0B9E9}, {0xD4AD2DBFC3D07787, 0x955E4EC64B44E864},
+    {0x84EC3C97DA624AB4, 0xBD5AF13BEF0B113E}, {0xA6274BBDD0FADD61, 0xECB1AD8AEACDD58E},
+    {0xCFB11EAD453994BA, 0x67DE18EDA5814AF2}, {0x81CEB32C4B43FCF4, 0x80EACF948770CED7},
+    {0xA2425FF75E14FC31, 0xA1258379A94D028D}, {0xCAD2F7F5359A3B3E, 0x096EE45813A04330},
+    {0xFD87B5F28300CA0D, 0x8BCA9D6E188853FC}, {0x9E74D1B791E07E48, 0x775EA264CF55347D},
+    {0xC612062576589DDA, 0x95364AFE032A819D}, {0xF79687AED3EEC551, 0x3A83DDBD83F52204},
+    {0x9ABE14CD44753B52, 0xC4926A9672793542}, {0xC16D9A0095928A27, 0x75B7053C0F178293},
+    {0xF1C90080BAF72CB1, 0x5324C68B12DD6338}, {0x971DA05074DA7BEE, 0xD3F6FC16EBCA5E03},
+    {0xBCE5086492111AEA, 0x88F4BB1CA6BCF584}, {0xEC1E4A7DB69561A5, 0x2B31E9E3D06C32E5},
+    {0x9392EE8E921D5D07, 0x3AFF322E62439FCF}, {0xB877AA3236A4B449, 0x09BEFEB9FAD487C2},
+    {0xE69594BEC44DE15B, 0x4C2EBE687989A9B3}, {0x901D7CF73AB0ACD9, 0x0F9D37014BF60A10},
+    {0xB424DC35095CD80F, 0x538484C19EF38C94}, {0xE12E13424BB40E13, 0x2865A5F206B06FB9},
+    {0x8CBCCC096F5088CB, 0xF93F87B7442E45D3}, {0xAFEBFF0BCB24AAFE, 0xF78F69A51539D748},
+    {0xDBE6FECEBDEDD5BE, 0xB573440E5A884D1B}, {0x89705F4136B4A597, 0x31680A88F8953030},
+    {0xABCC77118461CEFC, 0xFDC20D2B36BA7C3D}, {0xD6BF94D5E57A42BC, 0x3D32907604691B4C},
+    {0x8637BD05AF6C69B5, 0xA63F9A49C2C1B10F}, {0xA7C5AC471B478423, 0x0FCF80DC33721D53},
+    {0xD1B71758E219652B, 0xD3C36113404EA4A8}, {0x83126E978D4FDF3B, 0x645A1CAC083126E9},
+    {0xA3D70A3D70A3D70A, 0x3D70A3D70A3D70A3}, {0xCCCCCCCCCCCCCCCC, 0xCCCCCCCCCCCCCCCC},
+    {0x8000000000000000, 0x0000000000000000}, {0xA000000000000000, 0x0000000000000000},
+    {0xC800000000000000, 0x0000000000000000}, {0xFA00000000000000, 0x0000000000000000},
+    {0x9C40000000000000, 0x0000000000000000}, {0xC350000000000000, 0x0000000000000000},
+    {0xF424000000000000, 0x0000000000000000}, {0x9896800000000000, 0x0000000000000000},
+    {0xBEBC200000000000, 0x0000000000000000}, {0xEE6B280000000000, 0x0000000000000000},
+    {0x9502F90000000000, 0x0000000000000000}, {0xBA43B74000000000, 0x0000000000000000},
+    {0xE8D4A51000000000, 0x0000000000000000}, {0x9184E72A00000000, 0x0000000000000000},
+    {0xB5E620F480000000, 0x0000000000000000}, {0xE35FA931A0000000, 0x0000000000000000},
+    {0x8E1BC9BF04000000, 0x0000000000000000}, {0xB1A2BC2EC5000000, 0x0000000000000000},
+    {0xDE0B6B3A76400000, 0x0000000000000000}, {0x8AC7230489E80000, 0x0000000000000000},
+    {0xAD78EBC5AC620000, 0x0000000000000000}, {0xD8D726B7177A8000, 0x0000000000000000},
+    {0x878678326EAC9000, 0x0000000000000000}, {0xA968163F0A57B400, 0x0000000000000000},
+    {0xD3C21BCECCEDA100, 0x0000000000000000}, {0x84595161401484A0, 0x0000000000000000},
+    {0xA56FA5B99019A5C8, 0x0000000000000000}, {0xCECB8F27F4200F3A, 0x0000000000000000},
+    {0x813F3978F8940984, 0x4000000000000000}, {0xA18F07D736B90BE5, 0x5000000000000000},
+    {0xC9F2C9CD04674EDE, 0xA400000000000000}, {0xFC6F7C4045812296, 0x4D00000000000000},
+    {0x9DC5ADA82B70B59D, 0xF020000000000000}, {0xC5371912364CE305, 0x6C28000000000000},
+    {0xF684DF56C3E01BC6, 0xC732000000000000}, {0x9A130B963A6C115C, 0x3C7F400000000000},
+    {0xC097CE7BC90715B3, 0x4B9F100000000000}, {0xF0BDC21ABB48DB20, 0x1E86D40000000000},
+    {0x96769950B50D88F4, 0x1314448000000000}, {0xBC143FA4E250EB31, 0x17D955A000000000},
+    {0xEB194F8E1AE525FD, 0x5DCFAB0800000000}, {0x92EFD1B8D0CF37BE, 0x5AA1CAE500000000},
+    {0xB7ABC627050305AD, 0xF14A3D9E40000000}, {0xE596B7B0C643C719, 0x6D9CCD05D0000000},
+    {0x8F7E32CE7BEA5C6F, 0xE4820023A2000000}, {0xB35DBF821AE4F38B, 0xDDA2802C8A800000},
+    {0xE0352F62A19E306E, 0xD50B2037AD200000}, {0x8C213D9DA502DE45, 0x4526F422CC340000},
+    {0xAF298D050E4395D6, 0x9670B12B7F410000}, {0xDAF3F04651D47B4C, 0x3C0CDD765F114000},
+    {0x88D8762BF324CD0F, 0xA5880A69FB6AC800}, {0xAB0E93B6EFEE0053, 0x8EEA0D047A457A00},
+    {0xD5D238A4ABE98068, 0x72A4904598D6D880}, {0x85A36366EB71F041, 0x47A6DA2B7F864750},
+    {0xA70C3C40A64E6C51, 0x999090B65F67D924}, {0xD0CF4B50CFE20765, 0xFFF4B4E3F741CF6D},
+    {0x82818F1281ED449F, 0xBFF8F10E7A8921A4}, {0xA321F2D7226895C7, 0xAFF72D52192B6A0D},
+    {0xCBEA6F8CEB02BB39, 0x9BF4F8A69F764490}, {0xFEE50B7025C36A08, 0x02F236D04753D5B4},
+    {0x9F4F2726179A2245, 0x01D762422C946590}, {0xC722F0EF9D80AAD6, 0x424D3AD2B7B97EF5},
+    {0xF8EBAD2B84E0D58B, 0xD2E0898765A7DEB2}, {0x9B934C3B330C8577, 0x63CC55F49F88EB2F},
+    {0xC2781F49FFCFA6D5, 0x3CBF6B71C76B25FB}, {0xF316271C7FC3908A, 0x8BEF464E3945EF7A},
+    {0x97EDD871CFDA3A56, 0x97758BF0E3CBB5AC}, {0xBDE94E8E43D0C8EC, 0x3D52EEED1CBEA317},
+    {0xED63A231D4C4FB27, 0x4CA7AAA863EE4BDD}, {0x945E455F24FB1CF8, 0x8FE8CAA93E74EF6A},
+    {0xB975D6B6EE39E436, 0xB3E2FD538E122B44}, {0xE7D34C64A9C85D44, 0x60DBBCA87196B616},
+    {0x90E40FBEEA1D3A4A, 0xBC8955E946FE31CD}, {0xB51D13AEA4A488DD, 0x6BABAB6398BDBE41},
+    {0xE264589A4DCDAB14, 0xC696963C7EED2DD1}, {0x8D7EB76070A08AEC, 0xFC1E1DE5CF543CA2},
+    {0xB0DE65388CC8ADA8, 0x3B25A55F43294BCB}, {0xDD15FE86AFFAD912, 0x49EF0EB713F39EBE},
+    {0x8A2DBF142DFCC7AB, 0x6E3569326C784337}, {0xACB92ED9397BF996, 0x49C2C37F07965404},
+    {0xD7E77A8F87DAF7FB, 0xDC33745EC97BE906}, {0x86F0AC99B4E8DAFD, 0x69A028BB3DED71A3},
+    {0xA8ACD7C0222311BC, 0xC40832EA0D68CE0C}, {0xD2D80DB02AABD62B, 0xF50A3FA490C30190},
+    {0x83C7088E1AAB65DB, 0x792667C6DA79E0FA}, {0xA4B8CAB1A1563F52, 0x577001B891185938},
+    {0xCDE6FD5E09ABCF26, 0xED4C0226B55E6F86}, {0x80B05E5AC60B6178, 0x544F8158315B05B4},
+    {0xA0DC75F1778E39D6, 0x696361AE3DB1C721}, {0xC913936DD571C84C, 0x03BC3A19CD1E38E9},
+    {0xFB5878494ACE3A5F, 0x04AB48A04065C723}, {0x9D174B2DCEC0E47B, 0x62EB0D64283F9C76},
+    {0xC45D1DF942711D9A, 0x3BA5D0BD324F8394}, {0xF5746577930D6500, 0xCA8F44EC7EE36479},
+    {0x9968BF6ABBE85F20, 0x7E998B13CF4E1ECB}, {0xBFC2EF456AE276E8, 0x9E3FEDD8C321A67E},
+    {0xEFB3AB16C59B14A2, 0xC5CFE94EF3EA101E}, {0x95D04AEE3B80ECE5, 0xBBA1F1D158724A12},
+    {0xBB445DA9CA61281F, 0x2A8A6E45AE8EDC97}, {0xEA1575143CF97226, 0xF52D09D71A3293BD},
+    {0x924D692CA61BE758, 0x593C2626705F9C56}, {0xB6E0C377CFA2E12E, 0x6F8B2FB00C77836C},
+    {0xE498F455C38B997A, 0x0B6DFB9C0F956447}, {0x8EDF98B59A373FEC, 0x4724BD4189BD5EAC},
+    {0xB2977EE300C50FE7, 0x58EDEC91EC2CB657}, {0xDF3D5E9BC0F653E1, 0x2F2967B66737E3ED},
+    {0x8B865B215899F46C, 0xBD79E0D20082EE74}, {0xAE67F1E9AEC07187, 0xECD8590680A3AA11},
+    {0xDA01EE641A708DE9, 0xE80E6F4820CC9495}, {0x884134FE908658B2, 0x3109058D147FDCDD},
+    {0xAA51823E34A7EEDE, 0xBD4B46F0599FD415}, {0xD4E5E2CDC1D1EA96, 0x6C9E18AC7007C91A},
+    {0x850FADC09923329E, 0x03E2CF6BC604DDB0}, {0xA6539930BF6BFF45, 0x84DB8346B786151C},
+    {0xCFE87F7CEF46FF16, 0xE612641865679A63}, {0x81F14FAE158C5F6E, 0x4FCB7E8F3F60C07E},
+    {0xA26DA3999AEF7749, 0xE3BE5E330F38F09D}, {0xCB090C8001AB551C, 0x5CADF5BFD3072CC5},
+    {0xFDCB4FA002162A63, 0x73D9732FC7C8F7F6}, {0x9E9F11C4014DDA7E, 0x2867E7FDDCDD9AFA},
+    {0xC646D63501A1511D, 0xB281E1FD541501B8}, {0xF7D88BC24209A565, 0x1F225A7CA91A4226},
+    {0x9AE757596946075F, 0x3375788DE9B06958}, {0xC1A12D2FC3978937, 0x0052D6B1641C83AE},
+    {0xF209787BB47D6B84, 0xC0678C5DBD23A49A}, {0x9745EB4D50CE6332, 0xF840B7BA963646E0},
+    {0xBD176620A501FBFF, 0xB650E5A93BC3D898}, {0xEC5D3FA8CE427AFF, 0xA3E51F138AB4CEBE},
+    {0x93BA47C980E98CDF, 0xC66F336C36B10137}, {0xB8A8D9BBE123F017, 0xB80B0047445D4184},
+    {0xE6D3102AD96CEC1D, 0xA60DC059157491E5}, {0x9043EA1AC7E41392, 0x87C89837AD68DB2F},
+    {0xB454E4A179DD1877, 0x29BABE4598C311FB}, {0xE16A1DC9D8545E94, 0xF4296DD6FEF3D67A},
+    {0x8CE2529E2734BB1D, 0x1899E4A65F58660C}, {0xB01AE745B101E9E4, 0x5EC05DCFF72E7F8F},
+    {0xDC21A1171D42645D, 0x76707543F4FA1F73}, {0x899504AE72497EBA, 0x6A06494A791C53A8},
+    {0xABFA45DA0EDBDE69, 0x0487DB9D17636892}, {0xD6F8D7509292D603, 0x45A9D2845D3C42B6},
+    {0x865B86925B9BC5C2, 0x0B8A2392BA45A9B2}, {0xA7F26836F282B732, 0x8E6CAC7768D7141E},
+    {0xD1EF0244AF2364FF, 0x3207D795430CD926}, {0x8335616AED761F1F, 0x7F44E6BD49E807B8},
+    {0xA402B9C5A8D3A6E7, 0x5F16206C9C6209A6}, {0xCD036837130890A1, 0x36DBA887C37A8C0F},
+    {0x802221226BE55A64, 0xC2494954DA2C9789}, {0xA02AA96B06DEB0FD, 0xF2DB9BAA10B7BD6C},
+    {0xC83553C5C8965D3D, 0x6F92829494E5ACC7}, {0xFA42A8B73ABBF48C, 0xCB772339BA1F17F9},
+    {0x9C69A97284B578D7, 0xFF2A760414536EFB}, {0xC38413CF25E2D70D, 0xFEF5138519684ABA},
+    {0xF46518C2EF5B8CD1, 0x7EB258665FC25D69}, {0x98BF2F79D5993802, 0xEF2F773FFBD97A61},
+    {0xBEEEFB584AFF8603, 0xAAFB550FFACFD8FA}, {0xEEAABA2E5DBF6784, 0x95BA2A53F983CF38},
+    {0x952AB45CFA97A0B2, 0xDD945A747BF26183}, {0xBA756174393D88DF, 0x94F971119AEEF9E4},
+    {0xE912B9D1478CEB17, 0x7A37CD5601AAB85D}, {0x91ABB422CCB812EE, 0xAC62E055C10AB33A},
+    {0xB616A12B7FE617AA, 0x577B986B314D6009}, {0xE39C49765FDF9D94, 0xED5A7E85FDA0B80B},
+    {0x8E41ADE9FBEBC27D, 0x14588F13BE847307}, {0xB1D219647AE6B31C, 0x596EB2D8AE258FC8},
+    {0xDE469FBD99A05FE3, 0x6FCA5F8ED9AEF3BB}, {0x8AEC23D680043BEE, 0x25DE7BB9480D5854},
+    {0xADA72CCC20054AE9, 0xAF561AA79A10AE6A}, {0xD910F7FF28069DA4, 0x1B2BA1518094DA04},
+    {0x87AA9AFF79042286, 0x90FB44D2F05D0842}, {0xA99541BF57452B28, 0x353A1607AC744A53},
+    {0xD3FA922F2D1675F2, 0x42889B8997915CE8}, {0x847C9B5D7C2E09B7, 0x69956135FEBADA11},
+    {0xA59BC234DB398C25, 0x43FAB9837E699095}, {0xCF02B2C21207EF2E, 0x94F967E45E03F4BB},
+    {0x8161AFB94B44F57D, 0x1D1BE0EEBAC278F5}, {0xA1BA1BA79E1632DC, 0x6462D92A69731732},
+    {0xCA28A291859BBF93, 0x7D7B8F7503CFDCFE}, {0xFCB2CB35E702AF78, 0x5CDA735244C3D43E},
+    {0x9DEFBF01B061ADAB, 0x3A0888136AFA64A7}, {0xC56BAEC21C7A1916, 0x088AAA1845B8FDD0},
+    {0xF6C69A72A3989F5B, 0x8AAD549E57273D45}, {0x9A3C2087A63F6399, 0x36AC54E2F678864B},
+    {0xC0CB28A98FCF3C7F, 0x84576A1BB416A7DD}, {0xF0FDF2D3F3C30B9F, 0x656D44A2A11C51D5},
+    {0x969EB7C47859E743, 0x9F644AE5A4B1B325}, {0xBC4665B596706114, 0x873D5D9F0DDE1FEE},
+    {0xEB57FF22FC0C7959, 0xA90CB506D155A7EA}, {0x9316FF75DD87CBD8, 0x09A7F12442D588F2},
+    {0xB7DCBF5354E9BECE, 0x0C11ED6D538AEB2F}, {0xE5D3EF282A242E81, 0x8F1668C8A86DA5FA},
+    {0x8FA475791A569D10, 0xF96E017D694487BC}, {0xB38D92D760EC4455, 0x37C981DCC395A9AC},
+    {0xE070F78D3927556A, 0x85BBE253F47B1417}, {0x8C469AB843B89562, 0x93956D7478CCEC8E},
+    {0xAF58416654A6BABB, 0x387AC8D1970027B2}, {0xDB2E51BFE9D0696A, 0x06997B05FCC0319E},
+    {0x88FCF317F22241E2, 0x441FECE3BDF81F03}, {0xAB3C2FDDEEAAD25A, 0xD527E81CAD7626C3},
+    {0xD60B3BD56A5586F1, 0x8A71E223D8D3B074}, {0x85C7056562757456, 0xF6872D5667844E49},
+    {0xA738C6BEBB12D16C, 0xB428F8AC016561DB}, {0xD106F86E69D785C7, 0xE13336D701BEBA52},
+    {0x82A45B450226B39C, 0xECC0024661173473}, {0xA34D721642B06084, 0x27F002D7F95D0190},
+    {0xCC20CE9BD35C78A5, 0x31EC038DF7B441F4}, {0xFF290242C83396CE, 0x7E67047175A15271},
+    {0x9F79A169BD203E41, 0x0F0062C6E984D386}, {0xC75809C42C684DD1, 0x52C07B78A3E60868},
+    {0xF92E0C3537826145, 0xA7709A56CCDF8A82}, {0x9BBCC7A142B17CCB, 0x88A66076400BB691},
+    {0xC2ABF989935DDBFE, 0x6ACFF893D00EA435}, {0xF356F7EBF83552FE, 0x0583F6B8C4124D43},
+    {0x98165AF37B2153DE, 0xC3727A337A8B704A}, {0xBE1BF1B059E9A8D6, 0x744F18C0592E4C5C},
+    {0xEDA2EE1C7064130C, 0x1162DEF06F79DF73}, {0x9485D4D1C63E8BE7, 0x8ADDCB5645AC2BA8},
+    {0xB9A74A0637CE2EE1, 0x6D953E2BD7173692}, {0xE8111C87C5C1BA99, 0xC8FA8DB6CCDD0437},
+    {0x910AB1D4DB9914A0, 0x1D9C9892400A22A2}, {0xB54D5E4A127F59C8, 0x2503BEB6D00CAB4B},
+    {0xE2A0B5DC971F303A, 0x2E44AE64840FD61D}, {0x8DA471A9DE737E24, 0x5CEAECFED289E5D2},
+    {0xB10D8E1456105DAD, 0x7425A83E872C5F47}, {0xDD50F1996B947518, 0xD12F124E28F77719},
+    {0x8A5296FFE33CC92F, 0x82BD6B70D99AAA6F}, {0xACE73CBFDC0BFB7B, 0x636CC64D1001550B},
+    {0xD8210BEFD30EFA5A, 0x3C47F7E05401AA4E}, {0x8714A775E3E95C78, 0x65ACFAEC34810A71},
+    {0xA8D9D1535CE3B396, 0x7F1839A741A14D0D}, {0xD31045A8341CA07C, 0x1EDE48111209A050},
+    {0x83EA2B892091E44D, 0x934AED0AAB460432}, {0xA4E4B66B68B65D60, 0xF81DA84D5617853F},
+    {0xCE1DE40642E3F4B9, 0x36251260AB9D668E}, {0x80D2AE83E9CE78F3, 0xC1D72B7C6B426019},
+    {0xA1075A24E4421730, 0xB24CF65B8612F81F}, {0xC94930AE1D529CFC, 0xDEE033F26797B627},
+    {0xFB9B7CD9A4A7443C, 0x169840EF017DA3B1}, {0x9D412E0806E88AA5, 0x8E1F289560EE864E},
+    {0xC491798A08A2AD4E, 0xF1A6F2BAB92A27E2}, {0xF5B5D7EC8ACB58A2, 0xAE10AF696774B1DB},
+    {0x9991A6F3D6BF1765, 0xACCA6DA1E0A8EF29}, {0xBFF610B0CC6EDD3F, 0x17FD090A58D32AF3},
+    {0xEFF394DCFF8A948E, 0xDDFC4B4CEF07F5B0}, {0x95F83D0A1FB69CD9, 0x4ABDAF101564F98E},
+    {0xBB764C4CA7A4440F, 0x9D6D1AD41ABE37F1}, {0xEA53DF5FD18D5513, 0x84C86189216DC5ED},
+    {0x92746B9BE2F8552C, 0x32FD3CF5B4E49BB4}, {0xB7118682DBB66A77, 0x3FBC8C33221DC2A1},
+    {0xE4D5E82392A40515, 0x0FABAF3FEAA5334A}, {0x8F05B1163BA6832D, 0x29CB4D87F2A7400E},
+    {0xB2C71D5BCA9023F8, 0x743E20E9EF511012}, {0xDF78E4B2BD342CF6, 0x914DA9246B255416},
+    {0x8BAB8EEFB6409C1A, 0x1AD089B6C2F7548E}, {0xAE9672ABA3D0C320, 0xA184AC2473B529B1},
+    {0xDA3C0F568CC4F3E8, 0xC9E5D72D90A2741E}, {0x8865899617FB1871, 0x7E2FA67C7A658892},
+    {0xAA7EEBFB9DF9DE8D, 0xDDBB901B98FEEAB7}, {0xD51EA6FA85785631, 0x552A74227F3EA565},
+    {0x8533285C936B35DE, 0xD53A88958F87275F}, {0xA67FF273B8460356, 0x8A892ABAF368F137},
+    {0xD01FEF10A657842C, 0x2D2B7569B0432D85}, {0x8213F56A67F6B29B, 0x9C3B29620E29FC73},
+    {0xA298F2C501F45F42, 0x8349F3BA91B47B8F}, {0xCB3F2F7642717713, 0x241C70A936219A73},
+    {0xFE0EFB53D30DD4D7, 0xED238CD383AA0110}, {0x9EC95D1463E8A506, 0xF4363804324A40AA},
+    {0xC67BB4597CE2CE48, 0xB143C6053EDCD0D5}, {0xF81AA16FDC1B81DA, 0xDD94B7868E94050A},
+    {0x9B10A4E5E9913128, 0xCA7CF2B4191C8326}, {0xC1D4CE1F63F57D72, 0xFD1C2F611F63A3F0},
+    {0xF24A01A73CF2DCCF, 0xBC633B39673C8CEC}, {0x976E41088617CA01, 0xD5BE0503E085D813},
+    {0xBD49D14AA79DBC82, 0x4B2D8644D8A74E18}, {0xEC9C459D51852BA2, 0xDDF8E7D60ED1219E},
+    {0x93E1AB8252F33B45, 0xCABB90E5C942B503}, {0xB8DA1662E7B00A17, 0x3D6A751F3B936243},
+    {0xE7109BFBA19C0C9D, 0x0CC512670A783AD4}, {0x906A617D450187E2, 0x27FB2B80668B24C5},
+    {0xB484F9DC9641E9DA, 0xB1F9F660802DEDF6}, {0xE1A63853BBD26451, 0x5E7873F8A0396973},
+    {0x8D07E33455637EB2, 0xDB0B487B6423E1E8}, {0xB049DC016ABC5E5F, 0x91CE1A9A3D2CDA62},
+    {0xDC5C5301C56B75F7, 0x7641A140CC7810FB}, {0x89B9B3E11B6329BA, 0xA9E904C87FCB0A9D},
+    {0xAC2820D9623BF429, 0x546345FA9FBDCD44}, {0xD732290FBACAF133, 0xA97C177947AD4095},
+    {0x867F59A9D4BED6C0, 0x49ED8EABCCCC485D}, {0xA81F301449EE8C70, 0x5C68F256BFFF5A74},
+    {0xD226FC195C6A2F8C, 0x73832EEC6FFF3111}, {0x83585D8FD9C25DB7, 0xC831FD53C5FF7EAB},
+    {0xA42E74F3D032F525, 0xBA3E7CA8B77F5E55}, {0xCD3A1230C43FB26F, 0x28CE1BD2E55F35EB},
+    {0x80444B5E7AA7CF85, 0x7980D163CF5B81B3}, {0xA0555E361951C366, 0xD7E105BCC332621F},
+    {0xC86AB5C39FA63440, 0x8DD9472BF3FEFAA7}, {0xFA856334878FC150, 0xB14F98F6F0FEB951},
+    {0x9C935E00D4B9D8D2, 0x6ED1BF9A569F33D3}, {0xC3B8358109E84F07, 0x0A862F80EC4700C8},
+    {0xF4A642E14C6262C8, 0xCD27BB612758C0FA}, {0x98E7E9CCCFBD7DBD, 0x8038D51CB897789C},
+    {0xBF21E44003ACDD2C, 0xE0470A63E6BD56C3}, {0xEEEA5D5004981478, 0x1858CCFCE06CAC74},
+    {0x95527A5202DF0CCB, 0x0F37801E0C43EBC8}, {0xBAA718E68396CFFD, 0xD30560258F54E6BA},
+    {0xE950DF20247C83FD, 0x47C6B82EF32A2069}, {0x91D28B7416CDD27E, 0x4CDC331D57FA5441},
+    {0xB6472E511C81471D, 0xE0133FE4ADF8E952}, {0xE3D8F9E563A198E5, 0x58180FDDD97723A6},
+    {0x8E679C2F5E44FF8F, 0x570F09EAA7EA7648}, {0xB201833B35D63F73, 0x2CD2CC6551E513DA},
+    {0xDE81E40A034BCF4F, 0xF8077F7EA65E58D1}, {0x8B112E86420F6191, 0xFB04AFAF27FAF782},
+    {0xADD57A27D29339F6, 0x79C5DB9AF1F9B563}, {0xD94AD8B1C7380874, 0x18375281AE7822BC},
+    {0x87CEC76F1C830548, 0x8F2293910D0B15B5}, {0xA9C2794AE3A3C69A, 0xB2EB3875504DDB22},
+    {0xD433179D9C8CB841, 0x5FA60692A46151EB}, {0x849FEEC281D7F328, 0xDBC7C41BA6BCD333},
+    {0xA5C7EA73224DEFF3, 0x12B9B522906C0800}, {0xCF39E50FEAE16BEF, 0xD768226B34870A00},
+    {0x81842F29F2CCE375, 0xE6A1158300D46640}, {0xA1E53AF46F801C53, 0x60495AE3C1097FD0},
+    {0xCA5E89B18B602368, 0x385BB19CB14BDFC4}, {0xFCF62C1DEE382C42, 0x46729E03DD9ED7B5},
+    {0x9E19DB92B4E31BA9, 0x6C07A2C26A8346D1}, {0xC5A05277621BE293, 0xC7098B7305241885},
+    {0xF70867153AA2DB38, 0xB8CBEE4FC66D1EA7}, {0x9A65406D44A5C903, 0x737F74F1DC043328},
+    {0xC0FE908895CF3B44, 0x505F522E53053FF2}, {0xF13E34AABB430A15, 0x647726B9E7C68FEF},
+    {0x96C6E0EAB509E64D, 0x5ECA783430DC19F5}, {0xBC789925624C5FE0, 0xB67D16413D132072},
+    {0xEB96BF6EBADF77D8, 0xE41C5BD18C57E88F}, {0x933E37A534CBAAE7, 0x8E91B962F7B6F159},
+    {0xB80DC58E81FE95A1, 0x723627BBB5A4ADB0}, {0xE61136F2227E3B09, 0xCEC3B1AAA30DD91C},
+    {0x8FCAC257558EE4E6, 0x213A4F0AA5E8A7B1}, {0xB3BD72ED2AF29E1F, 0xA988E2CD4F62D19D},
+    {0xE0ACCFA875AF45A7, 0x93EB1B80A33B8605}, {0x8C6C01C9498D8B88, 0xBC72F130660533C3},
+    {0xAF87023B9BF0EE6A, 0xEB8FAD7C7F8680B4}, {0xDB68C2CA82ED2A05, 0xA67398DB9F6820E1},
+    {0x892179BE91D43A43, 0x88083F8943A1148C}, {0xAB69D82E364948D4, 0x6A0A4F6B948959B0},
+    {0xD6444E39C3DB9B09, 0x848CE34679ABB01C}, {0x85EAB0E41A6940E5, 0xF2D80E0C0C0B4E11},
+    {0xA7655D1D2103911F, 0x6F8E118F0F0E2195}, {0xD13EB46469447567, 0x4B7195F2D2D1A9FB},
+};
+
+static inline uint64_t naive_mul64(uint64_t a, uint64_t b, uint64_t* high) {
+#if defined(__SIZEOF_INT128__)
+    unsigned __int128 r = static_cast<unsigned __int128>(a) * b;
+    *high = static_cast<uint64_t>(r >> 64);
+    return static_cast<uint64_t>(r);
+#elif defined(_MSC_VER) && defined(_M_X64)
+    return _umul128(a, b, high);
+#else
+    uint64_t a_lo = a & 0xFFFFFFFF, a_hi = a >> 32, b_lo = b & 0xFFFFFFFF, b_hi = b >> 32;
+    uint64_t lo_lo = a_lo * b_lo, hi_lo = a_hi * b_lo, lo_hi = a_lo * b_hi, hi_hi = a_hi * b_hi;
+    uint64_t cross = (lo_lo >> 32) + (hi_lo & 0xFFFFFFFF) + lo_hi;
+    *high = (hi_lo >> 32) + (cross >> 32) + hi_hi;
+    return (cross << 32) | (lo_lo & 0xFFFFFFFF);
+#endif
+}
+
+static inline int naive_clz64(uint64_t x) {
+#if defined(_MSC_VER) && defined(_M_X64)
+    unsigned long index;
+    _BitScanReverse64(&index, x);
+    return 63 - static_cast<int>(index);
+#elif defined(_MSC_VER)
+    unsigned long index;
+    if (_BitScanReverse(&index, static_cast<unsigned long>(x >> 32)))
+        return 31 - static_cast<int>(index);
+    _BitScanReverse(&index, static_cast<unsigned long>(x));
+    return 63 - static_cast<int>(index);
+#else
+    return __builtin_clzll(x);
+#endif
+}
+
+static inline double naive_bits_to_double(uint64_t bits) {
+    double d;
+    memcpy(&d, &bits, sizeof(d));
+    return d;
+}
+
+// Eisel-Lemire: mantissa * 10^exp10 correctly rounded, for mantissa != 0.
+// Returns false when the 128-bit approximation cannot decide the rounding, or the result is
+// subnormal or out of range; the caller then falls back to naive_decimal_to_double.
+static bool naive_eisel_lemire(uint64_t mantissa, int64_t exp10, double* result) {
+    if (exp10 < NAIVE_POW10_MIN_EXP || exp10 > NAIVE_POW10_MAX_EXP)
+        return false;
+    const uint64_t* pow10 = naive_pow10_table[exp10 - NAIVE_POW10_MIN_EXP];
+    int clz = naive_clz64(mantissa);
+    mantissa <<= clz;
+    // floor(exp10 * log2(10)) + 64 + bias
+    uint64_t exp2 = static_cast<uint64_t>(((217706 * exp10) >> 16) + 64 + 1023 - clz);
+
+    uint64_t x_hi, x_lo = naive_mul64(mantissa, pow10[0], &x_hi);
+    // the lower 9 bits are all ones, the truncated low half of the power may carry into them
+    if ((x_hi & 0x1FF) == 0x1FF && x_lo + mantissa < mantissa) {
+        uint64_t y_hi, y_lo = naive_mul64(mantissa, pow10[1], &y_hi);
+        uint64_t merged_hi = x_hi, merged_lo = x_lo + y_hi;
+        if (merged_lo < x_lo)
+            merged_hi++;
+        if ((merged_hi & 0x1FF) == 0x1FF && merged_lo + 1 == 0 && y_lo + mantissa < mantissa)
+            return false;
+        x_hi = merged_hi;
+        x_lo = merged_lo;
+    }
+
+    // keep 54 bits, one more than the double mantissa for rounding
+    uint64_t msb = x_hi >> 63;
+    uint64_t bits = x_hi >> (msb + 9);
+    exp2 -= 1 ^ msb;
+    // exactly halfway between two doubles, let the exact path round to even
+    if (x_lo == 0 && (x_hi & 0x1FF) == 0 && (bits & 3) == 1)
+        return false;
+    bits += bits & 1;
+    bits >>= 1;
+    if (bits >> 53 > 0) {
+        bits >>= 1;
+        exp2++;
+    }
+    // subnormal (exp2 <= 0) or infinite (exp2 >= 0x7FF)
+    if (exp2 - 1 >= 0x7FF - 1)
+        return false;
+    *result = naive_bits_to_double(exp2 << 52 | (bits & 0x000FFFFFFFFFFFFF));
+    return true;
+}
+
+// Arbitrary-precision decimal used when Eisel-Lemire gives up: digits are shifted by powers of two
+// until the value lands in the double range, then the leading 53 bits are rounded half-to-even.
+struct NaiveDecimal {
+    int count;          // digits used
+    int point;          // position of the decimal point
+    bool truncated;     // non-zero digits were dropped past NAIVE_DECIMAL_DIGITS
+    unsigned char digits[800];
+};
+
+static const int NAIVE_DECIMAL_DIGITS = 800;
+static const int NAIVE_DECIMAL_MAX_SHIFT = 60;
+
+static void naive_decimal_trim(NaiveDecimal* d) {
+    while (d->count > 0 && d->digits[d->count - 1] == 0)
+        d->count--;
+    if (d->count == 0)
+        d->point = 0;
+}
+
+static void naive_decimal_right_shift(NaiveDecimal* d, unsigned k) {
+    int r = 0, w = 0;
+    uint64_t n = 0;
+    // pick up enough leading digits to cover the first shift
+    for (; n >> k == 0; r++) {
+        if (r >= d->count) {
+            if (n == 0) {
+                d->count = 0;
+                return;
+            }
+            while (n >> k == 0) {
+                n *= 10;
+                r++;
+            }
+            break;
+        }
+        n = n * 10 + d->digits[r];
+    }
+    d->point -= r - 1;
+    const uint64_t mask = (static_cast<uint64_t>(1) << k) - 1;
+    for (; r < d->count; r++) {
+        d->digits[w++] = static_cast<unsigned char>(n >> k);
+        n = (n & mask) * 10 + d->digits[r];
+    }
+    while (n > 0) {
+        unsigned char digit = static_cast<unsigned char>(n >> k);
+        if (w < NAIVE_DECIMAL_DIGITS)
+            d->digits[w++] = digit;
+        else if (digit > 0)
+            d->truncated = true;
+        n = (n & mask) * 10;
+    }
+    d->count = w;
+    naive_decimal_trim(d);
+}
+
+static void naive_decimal_left_shift(NaiveDecimal* d, unsigned k) {
+    // produce the digits least significant first, then store them back in order
+    unsigned char reversed[NAIVE_DECIMAL_DIGITS + 20];
+    int produced = 0;
+    uint64_t n = 0;
+    for (int r = d->count - 1; r >= 0; r--) {
+        n += static_cast<uint64_t>(d->digits[r]) << k;
+        reversed[produced++] = static_cast<unsigned char>(n % 10);
+        n /= 10;
+    }
+    while (n > 0) {
+        reversed[produced++] = static_cast<unsigned char>(n % 10);
+        n /= 10;
+    }
+    d->point += produced - d->count;
+    int dropped = produced > NAIVE_DECIMAL_DIGITS ? produced - NAIVE_DECIMAL_DIGITS : 0;
+    for (int i = 0; i < dropped; i++) {
+        if (reversed[i] != 0)
+            d->truncated = true;
+    }
+    d->count = produced - dropped;
+    for (int i = 0; i < d->count; i++)
+        d->digits[i] = reversed[produced - 1 - i];
+    naive_decimal_trim(d);
+}
+
+static void naive_decimal_shift(NaiveDecimal* d, int k) {
+    if (d->count == 0)
+        return;
+    for (; k > NAIVE_DECIMAL_MAX_SHIFT; k -= NAIVE_DECIMAL_MAX_SHIFT)
+        naive_decimal_left_shift(d, NAIVE_DECIMAL_MAX_SHIFT);
+    for (; k < -NAIVE_DECIMAL_MAX_SHIFT; k += NAIVE_DECIMAL_MAX_SHIFT)
+        naive_decimal_right_shift(d, NAIVE_DECIMAL_MAX_SHIFT);
+    if (k > 0)
+        naive_decimal_left_shift(d, k);
+    else if (k < 0)
+        naive_decimal_right_shift(d, -k);
+}
+
+static uint64_t naive_decimal_rounded_integer(const NaiveDecimal* d) {
+    int i;
+    uint64_t n = 0;
+    if (d->point > 20)
+        return UINT64_MAX;
+    for (i = 0; i < d->point && i < d->count; i++)
+        n = n * 10 + d->digits[i];
+    for (; i < d->point; i++)
+        n *= 10;
+    if (d->point >= 0 && d->point < d->count) {
+        bool round_up;
+        if (d->digits[d->point] == 5 && d->point + 1 == d->count)
+            round_up = d->truncated || (d->point > 0 && d->digits[d->point - 1] % 2 == 1);
+        else
+            round_up = d->digits[d->point] >= 5;
+        if (round_up)
+            n++;
+    }
+    return n;
+}
+
+// exact conversion of the digits in [int_begin, int_end) and [frac_begin, frac_end) times 10^exponent
+static double naive_decimal_to_double(const char* int_begin, const char* int_end,
+                                      const char* frac_begin, const char* frac_end, int64_t exponent) {
+    // powers of two that move the decimal point by at least 0, 1, 2 ... 8 digits
+    static const int shifts[] = {1, 3, 6, 9, 13, 16, 19, 23, 26};
+    NaiveDecimal d;
+    d.count = d.point = 0;
+    d.truncated = false;
+    for (const char* p = int_begin; p != int_end; p++) {
+        if (d.count == 0 && *p == '0')
+            continue;
+        if (d.count < NAIVE_DECIMAL_DIGITS)
+            d.digits[d.count++] = static_cast<unsigned char>(*p - '0');
+        else if (*p != '0')
+            d.truncated = true;
+        d.point++;
+    }
+    for (const char* p = frac_begin; p != frac_end; p++) {
+        if (d.count == 0 && *p == '0') {
+            d.point--;
+            continue;
+        }
+        if (d.count < NAIVE_DECIMAL_DIGITS)
+            d.digits[d.count++] = static_cast<unsigned char>(*p - '0');
+        else if (*p != '0')
+            d.truncated = true;
+    }
+    naive_decimal_trim(&d);
+    if (d.count == 0 || d.point + exponent < -330)
+        return 0.0;
+    if (d.point + exponent > 310)
+        return HUGE_VAL;
+    d.point += static_cast<int>(exponent);
+
+    // scale into [0.5, 1)
+    int exp2 = 0;
+    while (d.point > 0) {
+        int n = d.point >= 9 ? 27 : shifts[d.point];
+        naive_decimal_shift(&d, -n);
+        exp2 += n;
+    }
+    while (d.point < 0 || (d.point == 0 && d.digits[0] < 5)) {
+        int n = -d.point >= 9 ? 27 : shifts[-d.point];
+        naive_decimal_shift(&d, n);
+        exp2 -= n;
+    }
+    // [0.5, 1) to [1, 2)
+    exp2--;
+    // below the smallest normal exponent, denormalize
+    if (exp2 < -1022) {
+        naive_decimal_shift(&d, exp2 + 1022);
+        exp2 = -1022;
+    }
+    if (exp2 + 1023 >= 0x7FF)
+        return HUGE_VAL;
+    naive_decimal_shift(&d, 53);
+    uint64_t mantissa = naive_decimal_rounded_integer(&d);
+    if (mantissa == static_cast<uint64_t>(2) << 52) {
+        mantissa >>= 1;
+        exp2++;
+        if (exp2 + 1023 >= 0x7FF)
+            return HUGE_VAL;
+    }
+    uint64_t biased = (mantissa & (static_cast<uint64_t>(1) << 52)) ? exp2 + 1023 : 0;
+    return naive_bits_to_double(biased << 52 | (mantissa & 0x000FFFFFFFFFFFFF));
+}
+
+int naive_parse_number(NaiveContext* context, NaiveValue* value) {
+    // the grammar is validated and the value accumulated in the same pass: up to 19 significant
+    // digits go into `mantissa`, `exp10` tracks where the decimal point ended up
+    static const double exact_pow10[] = {
+            1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+            1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+    };
+    const char* p = context->json;
+    const char* end = context->end;
+    uint64_t mantissa = 0;
+    int64_t exp10 = 0, exponent = 0;
+    int significant = 0;
+    bool negative = false, truncated = false;
+    if (p != end && *p == '-') {
+        negative = true;
+        p++;
+    }
+    const char* int_begin = p;
+    // 002 is invalid input: root_not_singular
+    if (p != end && *p == '0') p++; // single zero is allowed
+    else {
+        if (p == end || !ISDIGIT1TO9((*p)))
+            return NAIVE_PARSE_INVALID_VALUE;
+        for (; p != end && ISDIGIT(*p); p++) {
+            if (significant < 19) {
+                mantissa = mantissa * 10 + (*p - '0');
+                significant++;
+            } else {
+                exp10++;
+                truncated |= *p != '0';
+            }
+        }
+    }
+    const char* int_end = p;
+    const char* frac_begin = p, * frac_end = p;
+    if (p != end && *p == '.') {
+        p++;
+        if (p == end || !ISDIGIT((*p)))
+            return NAIVE_PARSE_INVALID_VALUE;
+        frac_begin = p;
+        for (; p != end && ISDIGIT(*p); p++) {
+            if (significant < 19) {
+                mantissa = mantissa * 10 + (*p - '0');
+                exp10--;
+                if (mantissa != 0)
+                    significant++;
+            } else {
+                truncated |= *p != '0';
+            }
+        }
+        frac_end = p;
+    }
+    if (p != end && (*p == 'e' || *p == 'E')) {
+        bool exp_negative = false;
+        p++;
+        if (p != end && (*p == '+' || *p == '-'))
+            exp_negative = *p++ == '-';
+        // leading zeros are allowed in the exponent, e.g. 1e-07
+        if (p == end || !ISDIGIT((*p)))
+            return NAIVE_PARSE_INVALID_VALUE;
+        for (; p != end && ISDIGIT(*p); p++) {
+            // saturate, anything this large is zero or infinity anyway
+            if (exponent < 0x10000000)
+                exponent = exponent * 10 + (*p - '0');
+        }
+        if (exp_negative)
+            exponent = -exponent;
+    }
+    // integers that fit 64 bits are kept exact, -0 stays a double to keep its sign
+    if (p == int_end && exp10 <= 1 && (mantissa != 0 || !negative)) {
+        uint64_t integer = mantissa;
+        bool fits = exp10 == 0;
+        if (!fits) {
+            // a 20th digit, dropped from the mantissa above
+            unsigned digit = static_cast<unsigned>(int_end[-1] - '0');
+            fits = mantissa <= (UINT64_MAX - digit) / 10;
+            integer = mantissa * 10 + digit;
+        }
+        if (fits && (!negative || integer <= static_cast<uint64_t>(1) << 63)) {
+            if (negative) {
+                value->u64 = ~integer + 1;
+                value->flags = NAIVE_VALUE_INT64;
+            } else {
+                value->u64 = integer;
+                value->flags = integer <= INT64_MAX ? NAIVE_VALUE_INT64 : NAIVE_VALUE_UINT64;
+            }
+            value->type = NAIVE_NUMBER;
+            context->json = p;
+            return NAIVE_PARSE_OK;
+        }
+    }
+    exp10 += exponent;
+
+    double number;
+    if (mantissa == 0) {
+        number = 0.0;
+    } else if (!truncated && mantissa <= (static_cast<uint64_t>(1) << 53) && exp10 >= -22 && exp10 <= 22) {
+        // both operands are exact doubles, so a single multiplication or division rounds correctly;
+        // plain integers take this path with exp10 == 0
+        number = static_cast<double>(mantissa);
+        if (exp10 < 0)
+            number /= exact_pow10[-exp10];
+        else if (exp10 > 0)
+            number *= exact_pow10[exp10];
+    } else if (exp10 < NAIVE_POW10_MIN_EXP) {
+        // below 10^19 * 10^-348, rounds to zero
+        number = 0.0;
+    } else if (exp10 > NAIVE_POW10_MAX_EXP) {
+        number = HUGE_VAL;
+    } else {
+        double upper;
+        // with dropped digits the value lies in [mantissa, mantissa + 1) * 10^exp10, both ends must agree
+        if (!naive_eisel_lemire(mantissa, exp10, &number) ||
+            (truncated && (!naive_eisel_lemire(mantissa + 1, exp10, &upper) || upper != number)))
+            number = naive_decimal_to_double(int_begin, int_end, frac_begin, frac_end, exponent);
+    }
+    if (number == HUGE_VAL)
+        return NAIVE_PARSE_NUMBER_TOO_BIG;
+    value->number = negative ? -number : number;
+    value->type = NAIVE_NUMBER;
+    value->flags = 0;
+    context->json = p;
+    return NAIVE_PARSE_OK;
+}
+
+// NAIVE_PARSE_RAW: checks the grammar of a number without converting it. A literal below 10^308 cannot
+// overflow, only larger ones are converted to find out.
+static int naive_skip_number(NaiveContext* context) {
+    const char* p = context->json;
+    const char* end = context->end;
+    if (p != end && *p == '-')
+        p++;
+    const char* int_begin = p;
+    if (p != end && *p == '0') p++;
+    else {
+        if (p == end || !ISDIGIT1TO9((*p)))
+            return NAIVE_PARSE_INVALID_VALUE;
+        while (p != end && ISDIGIT(*p))
+            p++;
+    }
+    // the number is below 10^magnitude
+    int64_t magnitude = p - int_begin;
+    if (p != end && *p == '.') {
+        p++;
+        if (p == end || !ISDIGIT((*p)))
+            return NAIVE_PARSE_INVALID_VALUE;
+        while (p != end && ISDIGIT(*p))
+            p++;
+    }
+    if (p != end && (*p == 'e' || *p == 'E')) {
+        bool exp_negative = false;
+        int64_t exponent = 0;
+        p++;
+        if (p != end && (*p == '+' || *p == '-'))
+            exp_negative = *p++ == '-';
+        if (p == end || !ISDIGIT((*p)))
+            return NAIVE_PARSE_INVALID_VALUE;
+        for (; p != end && ISDIGIT(*p); p++) {
+            if (exponent < 0x10000000)
+                exponent = exponent * 10 + (*p - '0');
+        }
+        magnitude += exp_negative ? -exponent : exponent;
+    }
+    if (magnitude > 308) {
+        NaiveValue number;
+        return naive_parse_number(context, &number);
+    }
+    context->json = p;
+    return NAIVE_PARSE_OK;
+}
+
+const char* naive_parse_hex4(const char* p, unsigned* u) {
+    *u = 0;
+    for (int i = 0; i < 4; ++i) {
+        char ch = *p++;
+        *u <<= 4;
+        if (ch >= '0' && ch <= '9') *u |= ch - '0';
+        else if (ch >= 'A' && ch <= 'F') *u |= ch - ('A' - 10);
+        else if (ch >= 'a' && ch <= 'f') *u |= ch - ('a' - 10);
+        else return nullptr;
+    }
+    return p;
+};
+
+// writes the UTF-8 encoding of u at p (at most 4 bytes), returns the end
+static char* naive_write_utf8(char* p, unsigned u) {
+    if (u <= 0x7F)
+        *p++ = static_cast<char>(u & 0xFF);
+    else if (u <= 0x7FF) {
+        *p++ = static_cast<char>(0xC0 | ((u >> 6) & 0xFF));
+        *p++ = static_cast<char>(0x80 | (u & 0x3F));
+    } else if (u <= 0xFFFF) {
+        *p++ = static_cast<char>(0xE0 | ((u >> 12) & 0xFF));
+        *p++ = static_cast<char>(0x80 | ((u >> 6) & 0x3F));
+        *p++ = static_cast<char>(0x80 | (u & 0x3F));
+    } else {
+        assert(u <= 0x10FFFF);
+        *p++ = static_cast<char>(0xF0 | ((u >> 18) & 0xFF));
+        *p++ = static_cast<char>(0x80 | ((u >> 12) & 0x3F));
+        *p++ = static_cast<char>(0x80 | ((u >> 6) & 0x3F));
+        *p++ = static_cast<char>(0x80 | (u & 0x3F));
+    }
+    return p;
+}
+
+void naive_encode_utf8(NaiveContext* c, unsigned u) {
+    char* head = static_cast<char*>(naive_context_push(c, 4));
+    c->top -= 4 - (naive_write_utf8(head, u) - head);
+}
+
+// decodes the escape sequence after a '\\' into out (at most 4 bytes, never more than the sequence itself),
+// returns the position after it, or nullptr with *error set
+static const char* naive_parse_escape(const char* p, const char* end, char* out, size_t* len, int* error) {
+    unsigned unicode1, unicode2;
+    switch (p != end ? *p++ : '\0') {
+        case 'u': // parse unicode e.g. \u4f60\u597d
+            if (end - p < 4 || !(p = naive_parse_hex4(p, &unicode1))) {
+                *error = NAIVE_PARSE_INVALID_UNICODE_HEX;
+                return nullptr;
+            }
+            if (unicode1 >= 0xD800 && unicode1 <= 0xDBFF) {
+                if (p == end || *p++ != '\\' || p == end || *p++ != 'u') {
+                    *error = NAIVE_PARSE_INVALID_UNICODE_SURROGATE;
+                    return nullptr;
+                }
+                if (end - p < 4 || !(p = naive_parse_hex4(p, &unicode2))) {
+                    *error = NAIVE_PARSE_INVALID_UNICODE_HEX;
+                    return nullptr;
+                }
+                if (unicode2 < 0xDC00 || unicode2 > 0xDFFF) {
+                    *error = NAIVE_PARSE_INVALID_UNICODE_SURROGATE;
+                    return nullptr;
+                }
+                unicode1 = (((unicode1 - 0xD800) << 10) | (unicode2 - 0xDC00)) + 0x10000;
+            }
+            *len = naive_write_utf8(out, unicode1) - out;
+            return p;
+        case '\"':
+            *out = '\"';
+            break;
+        case '\\':
+            *out = '\\';
+            break;
+        case '/':
+            *out = '/';
+            break;
+        case 'b':
+            *out = '\b';
+            break;
+        case 'f':
+            *out = '\f';
+            break;
+        case 'n':
+            *out = '\n';
+            break;
+        case 'r':
+            *out = '\r';
+            break;
+        case 't':
+            *out = '\t';
+            break;
+        default:
+            *error = NAIVE_PARSE_INVALID_STRING_ESCAPE;
+            return nullptr;
+    }
+    *len = 1;
+    return p;
+}
+
+inline bool naive_is_string_special(char ch) {
+    return ch == '"' || ch == '\\' || static_cast<unsigned char>(ch) < 0x20;
+}
+
+// returns the first '"', '\\' or control character in [p, end), or end
+#if defined(NAIVE_AVX2)
+static const char* naive_scan_string(const char* p, const char* end) {
+    const __m256i quote = _mm256_set1_epi8('"');
+    const __m256i backslash = _mm256_set1_epi8('\\');
+    const __m256i control = _mm256_set1_epi8(0x1F);
+    for (; end - p >= 32; p += 32) {
+        const __m256i s = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+        __m256i special = _mm256_or_si256(_mm256_cmpeq_epi8(s, quote), _mm256_cmpeq_epi8(s, backslash));
+        // unsigned s <= 0x1F  <=>  min(s, 0x1F) == s
+        special = _mm256_or_si256(special, _mm256_cmpeq_epi8(_mm256_min_epu8(s, control), s));
+        unsigned mask = static_cast<unsigned>(_mm256_movemask_epi8(special));
+        if (mask != 0)
+            return p + naive_ctz(mask);
+    }
+    // the tail is shorter than a vector, loading it would read past `end`
+    while (p != end && !naive_is_string_special(*p))
+        p++;
+    return p;
+}
+#elif defined(NAIVE_SSE2)
+static const char* naive_scan_string(const char* p, const char* end) {
+    const __m128i quote = _mm_set1_epi8('"');
+    const __m128i backslash = _mm_set1_epi8('\\');
+    const __m128i control = _mm_set1_epi8(0x1F);
+    for (; end - p >= 16; p += 16) {
+        const __m128i s = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+        __m128i special = _mm_or_si128(_mm_cmpeq_epi8(s, quote), _mm_cmpeq_epi8(s, backslash));
+        // unsigned s <= 0x1F  <=>  min(s, 0x1F) == s
+        special = _mm_or_si128(special, _mm_cmpeq_epi8(_mm_min_epu8(s, control), s));
+        unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(special));
+        if (mask != 0)
+            return p + naive_ctz(mask);
+    }
+    // the tail is shorter than a vector, loading it would read past `end`
+    while (p != end && !naive_is_string_special(*p))
+        p++;
+    return p;
+}
+#else
+static const char* naive_scan_string(const char* p, const char* end) {
+    while (p != end && !naive_is_string_special(*p))
+        p++;
+    return p;
+}
+#endif
+
+inline bool naive_is_nesting_special(char ch) {
+    return ch == '"' || ch == '[' || ch == ']' || ch == '{' || ch == '}';
+}
+
+// returns the first '"', bracket or brace in [p, end), or end
+#if defined(NAIVE_AVX2)
+static const char* naive_scan_nesting(const char* p, const char* end) {
+    const __m256i quote = _mm256_set1_epi8('"');
+    const __m256i open = _mm256_set1_epi8('{');
+    const __m256i close = _mm256_set1_epi8('}');
+    const __m256i fold = _mm256_set1_epi8(0x20);
+    for (; end - p >= 32; p += 32) {
+        const __m256i s = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+        // '[' and ']' are '{' and '}' with bit 5 cleared
+        const __m256i folded = _mm256_or_si256(s, fold);
+        __m256i special = _mm256_or_si256(_mm256_cmpeq_epi8(folded, open), _mm256_cmpeq_epi8(folded, close));
+        special = _mm256_or_si256(special, _mm256_cmpeq_epi8(s, quote));
+        unsigned mask = static_cast<unsigned>(_mm256_movemask_epi8(special));
+        if (mask != 0)
+            return p + naive_ctz(mask);
+    }
+    // the tail is shorter than a vector, loading it would read past `end`
+    while (p != end && !naive_is_nesting_special(*p))
+        p++;
+    return p;
+}
+#elif defined(NAIVE_SSE2)
+static const char* naive_scan_nesting(const char* p, const char* end) {
+    const __m128i quote = _mm_set1_epi8('"');
+    const __m128i open = _mm_set1_epi8('{');
+    const __m128i close = _mm_set1_epi8('}');
+    const __m128i fold = _mm_set1_epi8(0x20);
+    for (; end - p >= 16; p += 16) {
+        const __m128i s = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+        // '[' and ']' are '{' and '}' with bit 5 cleared
+        const __m128i folded = _mm_or_si128(s, fold);
+        __m128i special = _mm_or_si128(_mm_cmpeq_epi8(folded, open), _mm_cmpeq_epi8(folded, close));
+        special = _mm_or_si128(special, _mm_cmpeq_epi8(s, quote));
+        unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(special));
+        if (mask != 0)
+            return p + naive_ctz(mask);
+    }
+    // the tail is shorter than a vector, loading it would read past `end`
+    while (p != end && !naive_is_nesting_special(*p))
+        p++;
+    return p;
+}
+#else
+static const char* naive_scan_nesting(const char* p, const char* end) {
+    while (p != end && !naive_is_nesting_special(*p))
+        p++;
+    return p;
+}
+#endif
+
+// in-situ mode: the string is unescaped over its own bytes, which never grow, and terminated where the
+// closing quote was
+static int naive_parse_string_insitu(NaiveContext* context, char** str, size_t* len) {
+    char* begin = const_cast<char*>(context->json);
+    char* dst = begin;
+    const char* p = begin;
+    const char* end = context->end;
+    size_t n;
+    int error;
+    while (true) {
+        const char* run = naive_scan_string(p, end);
+        if (dst != p)
+            memmove(dst, p, run - p);
+        dst += run - p;
+        p = run;
+        if (p == end)
+            return NAIVE_PARSE_MISS_QUOTATION_MARK;
+        char ch = *p++;
+        switch (ch) {
+            case '\"':
+                *dst = '\0';
+                *str = begin;
+                *len = dst - begin;
+                context->json = p;
+                return NAIVE_PARSE_OK;
+            case '\\':
+                if (!(p = naive_parse_escape(p, end, dst, &n, &error)))
+                    return error;
+                dst += n;
+                break;
+            default:
+                assert(static_cast<unsigned char>(ch) < 0x20);
+                return NAIVE_PARSE_INVALID_STRING_CHAR;
+        }
+    }
+}
+
+int naive_parse_string_raw(NaiveContext* context, char** str, size_t* len) {
+    size_t head = context->top;
+    EXPECT(context, '\"'); // string starts with "
+    if (context->flags & NAIVE_PARSE_INSITU)
+        return naive_parse_string_insitu(context, str, len);
+    const char* p = context->json;
+    const char* end = context->end;
+    char decoded[4];
+    size_t n;
+    int error;
+    // without escapes the string is its own decoding and is returned in place, nothing is copied
+    const char* run = naive_scan_string(p, end);
+    if (run != end && *run == '\"') {
+        *str = const_cast<char*>(p);
+        *len = run - p;
+        context->json = run + 1;
+        return NAIVE_PARSE_OK;
+    }
+    while (true) {
+        // copy the run of plain characters in one push, only escapes and the closing quote reach the switch
+        if (run != p) {
+            PUTS(context, p, run - p);
+            p = run;
+        }
+        if (p == end) {
+            // reset stack top
+            context->top = head;
+            return NAIVE_PARSE_MISS_QUOTATION_MARK;
+        }
+        char ch = *p++;
+        switch (ch) {
+            case '\"':
+                // meet end of string
+                *len = context->top - head;
+                *str = static_cast<char*>(naive_context_pop(context, *len));
+                context->json = p;
+                return NAIVE_PARSE_OK;
+            case '\\':
+                if (!(p = naive_parse_escape(p, end, decoded, &n, &error))) {
+                    context->top = head;
+                    return error;
+                }
+                PUTS(context, decoded, n);
+                run = naive_scan_string(p, end);
+                break;
+            default:
+                // naive_scan_string only stops here at control characters
+                assert(static_cast<unsigned char>(ch) < 0x20);
+                context->top = head;
+                return NAIVE_PARSE_INVALID_STRING_CHAR;
+        }
+    }
+}
+
+// NAIVE_PARSE_RAW: checks a string like naive_parse_string_raw but decodes nothing, not even in place, and
+// tells whether it has escapes
+static int naive_skip_string(NaiveContext* context, bool* escaped) {
+    EXPECT(context, '\"');
+    const char* p = context->json;
+    const char* end = context->end;
+    char decoded[4];
+    size_t n;
+    int error;
+    *escaped = false;
+    while (true) {
+        p = naive_scan_string(p, end);
+        if (p == end)
+            return NAIVE_PARSE_MISS_QUOTATION_MARK;
+        char ch = *p++;
+        if (ch == '\"') {
+            context->json = p;
+            return NAIVE_PARSE_OK;
+        }
+        if (ch != '\\')
+            return NAIVE_PARSE_INVALID_STRING_CHAR;
+        if (!(p = naive_parse_escape(p, end, decoded, &n, &error)))
+            return error;
+        *escaped = true;
+    }
+}
+
+// inline strings take the bytes in front of NaiveValue::type, less one for the '\0'
+static const size_t NAIVE_INLINE_STRING_MAX = offsetof(NaiveValue, type) - 1;
+
+static inline const char* naive_string_data(const NaiveValue* value) {
+    return (value->flags & NAIVE_VALUE_INLINE) ? reinterpret_cast<const char*>(value) : value->str;
+}
+
+static inline size_t naive_string_size(const NaiveValue* value) {
+    return (value->flags & NAIVE_VALUE_INLINE) ? value->inlen : value->strlen;
+}
+
+// the assign helpers expect a freed value and put the payload in `arena` (or on the heap); short strings
+// need neither
+static void naive_assign_string(NaiveValue* value, const char* str, size_t len, NaiveArena* arena) {
+    if (len <= NAIVE_INLINE_STRING_MAX) {
+        char* inlined = reinterpret_cast<char*>(value);
+        if (len > 0)
+            memcpy(inlined, str, len);
+        inlined[len] = '\0';
+        value->inlen = static_cast<unsigned char>(len);
+        value->type = NAIVE_STRING;
+        value->flags = NAIVE_VALUE_INLINE;
+        return;
+    }
+    if (len > UINT32_MAX)
+        throw std::length_error("naivejson: strings hold at most 2^32 - 1 bytes");
+    value->str = naive_alloc_string(arena, str, len);
+    value->strlen = static_cast<uint32_t>(len);
+    value->type = NAIVE_STRING;
+    value->flags = arena ? NAIVE_VALUE_SHARED : 0;
+}
+
+// the decoded form of a NAIVE_VALUE_RAW value, written to the freed `out` (which may be `raw` itself) with
+// its payload in `arena`; the source text was validated by the parse
+static void naive_decode_raw(const NaiveValue* raw, NaiveValue* out, NaiveArena* arena) {
+    NaiveContext context;
+    int ret;
+    if (raw->type == NAIVE_NUMBER) {
+        naive_context_init(&context, raw->str, raw->strlen, nullptr, 0);
+        ret = naive_parse_number(&context, out);
+        assert(ret == NAIVE_PARSE_OK);
+        (void) ret;
+        return;
+    }
+    // raw strings have no escapes, the span is the decoded string
+    naive_assign_string(out, raw->str, raw->strlen, arena);
+}
+
+// what the number getters read: a raw number is decoded into `scratch`, which needs no freeing
+static inline const NaiveValue* naive_decoded_number(const NaiveValue* value, NaiveValue* scratch) {
+    if (!(value->flags & NAIVE_VALUE_RAW))
+        return value;
+    naive_decode_raw(value, scratch, nullptr);
+    return scratch;
+}
+
+static void naive_assign_array(NaiveValue* value, size_t capacity, NaiveArena* arena) {
+    value->arr = naive_alloc_elements(arena, capacity);
+    value->arrlen = 0;
+    value->type = NAIVE_ARRAY;
+    value->flags = arena ? NAIVE_VALUE_SHARED : 0;
+}
+
+static void naive_assign_object(NaiveValue* value, size_t capacity, NaiveArena* arena) {
+    value->map = naive_alloc_members(arena, capacity);
+    value->maplen = 0;
+    value->type = NAIVE_OBJECT;
+    value->flags = arena ? NAIVE_VALUE_SHARED : 0;
+    naive_build_object_index(value);
+}
+
+// The grammar is written once against a builder, which decides what the parsed values turn into. A
+// builder provides
+//   Value, Member                  what a value and a key/value pair parse into, Member has a `value`
+//   init(value), init_member(member)
+//   literal(value, type), number(value, number), string(value, str, len)   `number` is a parsed NAIVE_NUMBER
+//   raw(value, type, str, len)     NAIVE_PARSE_RAW: a validated string or number as its source text
+//   start_array(), element(value), end_array(value, count)
+//   start_object(), key(member, str, len), member(member), end_object(value, count)
+//   drop_elements(count), drop_members(member, count)
+//   decodes                        false when keys and scalars are only checked with the raw-mode validators
+// Everything returning int returns NAIVE_PARSE_OK to go on, any other code aborts the parse with it.
+// element() and member() take over a finished child, the drop functions undo them when the container
+// fails to parse. Any of them may throw; end_array() and end_object() only take the children when they
+// return NAIVE_PARSE_OK, element() and member() free a child they could not take.
+
+// builds the NaiveValue tree: children are collected on the context stack and placed into an exactly
+// sized block once their container closes
+struct NaiveTreeBuilder {
+    typedef NaiveValue Value;
+    typedef NaiveMember Member;
+
+    static const bool decodes = true;
+
+    NaiveContext* context;
+
+    // values under construction sit on the context stack, outside any arena
+    static void init(NaiveValue* value) {
+        naive_init(value);
+    }
+
+    static void init_member(NaiveMember* member) {
+        member->key = nullptr;
+        member->keylen = 0;
+    }
+
+    static int literal(NaiveValue* value, NaiveType type) {
+        value->type = type;
+        return NAIVE_PARSE_OK;
+    }
+
+    static int number(NaiveValue* value, const NaiveValue* number) {
+        value->u64 = number->u64;
+        value->type = NAIVE_NUMBER;
+        value->flags = number->flags;
+        return NAIVE_PARSE_OK;
+    }
+
+    int string(NaiveValue* value, char* str, size_t len) {
+        NaiveInternPool* pool = context->intern;
+        if (pool != nullptr && len > NAIVE_INLINE_STRING_MAX && len <= pool->max_string) {
+            // pooled strings are shared, like in-situ ones
+            value->str = const_cast<char*>(naive_intern(pool, str, len));
+            value->strlen = static_cast<uint32_t>(len);
+            value->type = NAIVE_STRING;
+            value->flags = NAIVE_VALUE_SHARED;
+        } else if (context->flags & NAIVE_PARSE_INSITU) {
+            if (len > UINT32_MAX)
+                throw std::length_error("naivejson: strings hold at most 2^32 - 1 bytes");
+            value->str = str;
+            value->strlen = static_cast<uint32_t>(len);
+            value->type = NAIVE_STRING;
+            value->flags = NAIVE_VALUE_SHARED;
+        } else
+            naive_assign_string(value, str, len, context->arena);
+        return NAIVE_PARSE_OK;
+    }
+
+    // the value borrows its source text, like in-situ strings
+    static int raw(NaiveValue* value, NaiveType type, const char* str, size_t len) {
+        if (len > UINT32_MAX)
+            throw std::length_error("naivejson: strings hold at most 2^32 - 1 bytes");
+        value->str = const_cast<char*>(str);
+        value->strlen = static_cast<uint32_t>(len);
+        value->type = static_cast<unsigned char>(type);
+        value->flags = NAIVE_VALUE_RAW | NAIVE_VALUE_SHARED;
+        return NAIVE_PARSE_OK;
+    }
+
+    static int start_array() {
+        return NAIVE_PARSE_OK;
+    }
+
+    void element(NaiveValue* element) {
+        void* top;
+        try {
+            top = naive_context_push(context, sizeof(NaiveValue));
+        } catch (...) {
+            // nobody took the child
+            naive_free(element);
+            throw;
+        }
+        memcpy(top, element, sizeof(NaiveValue));
+    }
+
+    int end_array(NaiveValue* value, size_t arrlen) {
+        naive_assign_array(value, arrlen, context->arena);
+        size_t size = arrlen * sizeof(NaiveValue);
+        naive_place_elements(value->arr, static_cast<NaiveValue*>(naive_context_pop(context, size)), arrlen);
+        value->arrlen = arrlen;
+        return NAIVE_PARSE_OK;
+    }
+
+    void drop_elements(size_t arrlen) {
+        for (size_t i = 0; i < arrlen; i++) {
+            // FIX: free->naive_free
+            naive_free(static_cast<NaiveValue*>(naive_context_pop(context, sizeof(NaiveValue))));
+        }
+    }
+
+    static int start_object() {
+        return NAIVE_PARSE_OK;
+    }
+
+    int key(NaiveMember* member, char* str, size_t len) {
+        if (context->intern != nullptr)
+            member->key = const_cast<char*>(naive_intern(context->intern, str, len));
+        else
+            member->key = (context->flags & NAIVE_PARSE_INSITU) ? str : naive_alloc_string(context->arena, str, len);
+        member->keylen = len;
+        return NAIVE_PARSE_OK;
+    }
+
+    void member(NaiveMember* member) {
+        void* top;
+        try {
+            top = naive_context_push(context, sizeof(NaiveMember));
+        } catch (...) {
+            // the key is still pending, drop_members frees it
+            naive_free(&member->value);
+            throw;
+        }
+        memcpy(top, member, sizeof(NaiveMember));
+        member->key = nullptr;
+    }
+
+    int end_object(NaiveValue* value, size_t maplen) {
+        naive_assign_object(value, maplen, context->arena);
+        size_t size = maplen * sizeof(NaiveMember);
+        naive_place_members(value->map, static_cast<NaiveMember*>(naive_context_pop(context, size)), maplen);
+        value->maplen = maplen;
+        if (value->flags & NAIVE_VALUE_INDEXED)
+            naive_build_object_index(value);
+        if ((context->flags & NAIVE_PARSE_INSITU) || context->intern != nullptr)
+            value->flags |= NAIVE_VALUE_BORROWED;
+        return NAIVE_PARSE_OK;
+    }
+
+    // pop and free members on the stack, arena, in-situ and pooled keys are not ours
+    void drop_members(NaiveMember* pending, size_t maplen) {
+        bool owns_keys = context->arena == nullptr && !(context->flags & NAIVE_PARSE_INSITU) &&
+                         context->intern == nullptr;
+        if (owns_keys)
+            free(pending->key);
+        for (size_t i = 0; i < maplen; i++) {
+            NaiveMember* m = static_cast<NaiveMember*>(naive_context_pop(context, sizeof(NaiveMember)));
+            if (owns_keys)
+                free(m->key);
+            naive_free(&m->value);
+        }
+    }
+};
+
+// forwards every value to a NaiveHandler and keeps nothing, strings are handed over straight from the
+// input or the context stack
+struct NaiveEventBuilder {
+    struct Value {
+    };
+    struct Member {
+        Value value;
+    };
+
+    static const bool decodes = true;
+
+    const NaiveHandler* handler;
+
+    static int result(bool ok) {
+        return ok ? NAIVE_PARSE_OK : NAIVE_PARSE_HANDLER_ABORTED;
+    }
+
+    static void init(Value*) {}
+
+    static void init_member(Member*) {}
+
+    int literal(Value*, NaiveType type) {
+        if (type == NAIVE_NULL)
+            return handler->on_null ? result(handler->on_null(handler->user)) : NAIVE_PARSE_OK;
+        return handler->on_boolean ? result(handler->on_boolean(handler->user, type == NAIVE_TRUE)) : NAIVE_PARSE_OK;
+    }
+
+    int number(Value*, const NaiveValue* number) {
+        if ((number->flags & NAIVE_VALUE_INT64) && handler->on_int64)
+            return result(handler->on_int64(handler->user, number->i64));
+        if ((number->flags & NAIVE_VALUE_UINT64) && handler->on_uint64)
+            return result(handler->on_uint64(handler->user, number->u64));
+        return handler->on_number ? result(handler->on_number(handler->user, naive_get_number(number)))
+                                  : NAIVE_PARSE_OK;
+    }
+
+    int string(Value*, const char* str, size_t len) {
+        return handler->on_string ? result(handler->on_string(handler->user, str, len)) : NAIVE_PARSE_OK;
+    }
+
+    // naive_parse_sax never sets NAIVE_PARSE_RAW
+    static int raw(Value*, NaiveType, const char*, size_t) {
+        return NAIVE_PARSE_OK;
+    }
+
+    int start_array() {
+        return handler->on_start_array ? result(handler->on_start_array(handler->user)) : NAIVE_PARSE_OK;
+    }
+
+    static void element(Value*) {}
+
+    int end_array(Value*, size_t arrlen) {
+        return handler->on_end_array ? result(handler->on_end_array(handler->user, arrlen)) : NAIVE_PARSE_OK;
+    }
+
+    static void drop_elements(size_t) {}
+
+    int start_object() {
+        return handler->on_start_object ? result(handler->on_start_object(handler->user)) : NAIVE_PARSE_OK;
+    }
+
+    int key(Member*, const char* str, size_t len) {
+        return handler->on_key ? result(handler->on_key(handler->user, str, len)) : NAIVE_PARSE_OK;
+    }
+
+    static void member(Member*) {}
+
+    int end_object(Value*, size_t maplen) {
+        return handler->on_end_object ? result(handler->on_end_object(handler->user, maplen)) : NAIVE_PARSE_OK;
+    }
+
+    static void drop_members(Member*, size_t) {}
+};
+
+// checks the grammar and keeps nothing: keys and scalars go through naive_skip_string and
+// naive_skip_number, so not a byte is decoded or converted
+struct NaiveSkipBuilder {
+    struct Value {
+    };
+    struct Member {
+        Value value;
+    };
+
+    static const bool decodes = false;
+
+    static void init(Value*) {}
+
+    static void init_member(Member*) {}
+
+    static int literal(Value*, NaiveType) {
+        return NAIVE_PARSE_OK;
+    }
+
+    static int number(Value*, const NaiveValue*) {
+        return NAIVE_PARSE_OK;
+    }
+
+    static int string(Value*, const char*, size_t) {
+        return NAIVE_PARSE_OK;
+    }
+
+    static int raw(Value*, NaiveType, const char*, size_t) {
+        return NAIVE_PARSE_OK;
+    }
+
+    static int start_array() {
+        return NAIVE_PARSE_OK;
+    }
+
+    static void element(Value*) {}
+
+    static int end_array(Value*, size_t) {
+        return NAIVE_PARSE_OK;
+    }
+
+    static void drop_elements(size_t) {}
+
+    static int start_object() {
+        return NAIVE_PARSE_OK;
+    }
+
+    static int key(Member*, const char*, size_t) {
+        return NAIVE_PARSE_OK;
+    }
+
+    static void member(Member*) {}
+
+    static int end_object(Value*, size_t) {
+        return NAIVE_PARSE_OK;
+    }
+
+    static void drop_members(Member*, size_t) {}
+};
+
+template <typename Builder>
+static int naive_parse_string(NaiveContext* context, Builder* builder, typename Builder::Value* value) {
+    int ret = 0;
+    size_t len = 0;
+    char* str;
+    if ((ret = naive_parse_string_raw(context, &str, &len)) == NAIVE_PARSE_OK)
+        ret = builder->string(value, str, len);
+    return ret;
+}
+
+// only what reads the same decoded stays raw: strings without escapes, which getters take as they are, and
+// numbers that do not fit 64-bit integers. Strings with escapes are decoded here and integers converted,
+// both stringify no differently from their source text.
+template <typename Builder>
+static int naive_parse_raw(NaiveContext* context, Builder* builder, typename Builder::Value* value, NaiveType type) {
+    const char* begin = context->json;
+    int ret;
+    if (type == NAIVE_STRING) {
+        bool escaped;
+        if ((ret = naive_skip_string(context, &escaped)) != NAIVE_PARSE_OK)
+            return ret;
+        if (escaped && Builder::decodes) {
+            context->json = begin;
+            return naive_parse_string(context, builder, value);
+        }
+        return builder->raw(value, type, begin + 1, context->json - begin - 2);
+    }
+    if ((ret = naive_skip_number(context)) != NAIVE_PARSE_OK)
+        return ret;
+    const char* digits = begin + (*begin == '-');
+    if (Builder::decodes && context->json - digits <= 19) {
+        const char* p = digits;
+        while (p != context->json && ISDIGIT(*p))
+            p++;
+        if (p == context->json) {
+            NaiveValue number;
+            context->json = begin;
+            naive_parse_number(context, &number);
+            return builder->number(value, &number);
+        }
+    }
+    return builder->raw(value, type, begin, context->json - begin);
+}
+
+// one open container of the grammar: the member being parsed (for arrays just its value, the element)
+// and the children taken so far
+template <typename Builder>
+struct NaiveFrame {
+    typename Builder::Member member;
+    size_t count;
+    bool object;
+};
+
+// frames the parse starts out with on the machine stack, deeper documents move them to the heap
+static const size_t NAIVE_INLINE_FRAMES = 64;
+
+template <typename Builder>
+static NaiveFrame<Builder>* naive_push_frame(NaiveContext* context, NaiveFrame<Builder>* inline_frames) {
+    typedef NaiveFrame<Builder> Frame;
+    if ((context->depth + 1) * sizeof(Frame) > context->frames_size) {
+        size_t frames_size = context->frames_size + (context->frames_size >> 1);
+        char* frames;
+        if (context->frames == reinterpret_cast<char*>(inline_frames)) {
+            if ((frames = static_cast<char*>(malloc(frames_size))) != nullptr)
+                memcpy(frames, context->frames, context->frames_size);
+        } else
+            frames = static_cast<char*>(realloc(context->frames, frames_size));
+        if (frames == nullptr)
+            throw std::bad_alloc();
+        context->frames = frames;
+        context->frames_size = frames_size;
+    }
+    return reinterpret_cast<Frame*>(context->frames) + context->depth++;
+}
+
+// the key and colon in front of a member's value
+template <typename Builder>
+static inline int naive_parse_key(NaiveContext* context, Builder* builder, typename Builder::Member* member) {
+    char* str;
+    size_t len;
+    int ret;
+    bool escaped;
+    if (naive_peek(context) != '"')
+        return NAIVE_PARSE_MISS_KEY;
+    if (!Builder::decodes) {
+        if ((ret = naive_skip_string(context, &escaped)) != NAIVE_PARSE_OK)
+            return ret;
+    } else if ((ret = naive_parse_string_raw(context, &str, &len)) != NAIVE_PARSE_OK ||
+               (ret = builder->key(member, str, len)) != NAIVE_PARSE_OK)
+        return ret;
+    naive_parse_whitespace(context);
+    if (naive_peek(context) != ':')
+        return NAIVE_PARSE_MISS_COLON;
+    context->json++;
+    naive_parse_whitespace(context);
+    return NAIVE_PARSE_OK;
+}
+
+// a literal, number or string; inlined into the engine, where every scalar sibling goes through it
+template <typename Builder>
+static inline int naive_parse_scalar(NaiveContext* context, Builder* builder, typename Builder::Value* value) {
+    int ret;
+    NaiveValue number;
+    if (context->json == context->end)
+        return NAIVE_PARSE_EXPECT_VALUE;
+    switch (*context->json) {
+        case 'n':
+            if ((ret = naive_parse_literal(context, "null")) != NAIVE_PARSE_OK)
+                return ret;
+            return builder->literal(value, NAIVE_NULL);
+        case 't':
+            if ((ret = naive_parse_literal(context, "true")) != NAIVE_PARSE_OK)
+                return ret;
+            return builder->literal(value, NAIVE_TRUE);
+        case 'f':
+            if ((ret = naive_parse_literal(context, "false")) != NAIVE_PARSE_OK)
+                return ret;
+            return builder->literal(value, NAIVE_FALSE);
+        case '"':
+            if (!Builder::decodes || (context->flags & NAIVE_PARSE_RAW))
+                return naive_parse_raw(context, builder, value, NAIVE_STRING);
+            return naive_parse_string(context, builder, value);
+        default:
+            if (!Builder::decodes || (context->flags & NAIVE_PARSE_RAW))
+                return naive_parse_raw(context, builder, value, NAIVE_NUMBER);
+            if ((ret = naive_parse_number(context, &number)) != NAIVE_PARSE_OK)
+                return ret;
+            return builder->number(value, &number);
+    }
+}
+
+// drops the children of every open container, innermost first, and gives the frames back
+template <typename Builder>
+static void naive_unwind_frames(NaiveContext* context, Builder* builder, NaiveFrame<Builder>* inline_frames) {
+    for (; context->depth > 0; context->depth--) {
+        NaiveFrame<Builder>* frame = reinterpret_cast<NaiveFrame<Builder>*>(context->frames) + context->depth - 1;
+        if (frame->object)
+            builder->drop_members(&frame->member, frame->count);
+        else
+            builder->drop_elements(frame->count);
+    }
+    if (context->frames != reinterpret_cast<char*>(inline_frames))
+        free(context->frames);
+    context->frames = nullptr;
+    context->frames_size = 0;
+}
+
+// The grammar without recursion: the open containers are frames in context->frames, so the nesting
+// depth costs heap instead of machine stack and is capped by context->max_depth. The outer loop opens
+// containers and parses the first value of each into `slot`, the inner loop hands values to the innermost
+// container, parses scalar siblings in place and closes every container that ends behind them. On failure,
+// or when the builder throws, the open containers are unwound innermost first, each one dropping the
+// children it took.
+template <typename Builder>
+static int naive_parse_value(NaiveContext* context, Builder* builder, typename Builder::Value* value) {
+    typedef NaiveFrame<Builder> Frame;
+    Frame inline_frames[NAIVE_INLINE_FRAMES];
+    Frame* frame = nullptr; // innermost open container
+    bool object = false;    // what `frame` is
+    size_t count = 0;       // the children of `frame`, its own count is only brought up to date around it
+    typename Builder::Value* slot = value;
+    int ret = NAIVE_PARSE_OK;
+    assert(context->depth == 0);
+    context->frames = reinterpret_cast<char*>(inline_frames);
+    context->frames_size = sizeof(inline_frames);
+    try {
+        while (ret == NAIVE_PARSE_OK) {
+            char ch = naive_peek(context);
+            if (ch == '[' || ch == '{') {
+                context->json++;
+                if (context->depth == context->max_depth) {
+                    ret = NAIVE_PARSE_TOO_DEEP;
+                    break;
+                }
+                if ((ret = ch == '{' ? builder->start_object() : builder->start_array()) != NAIVE_PARSE_OK)
+                    break;
+                naive_parse_whitespace(context);
+                if (naive_peek(context) == ch + 2) { // ']' and '}' follow '[' and '{' two apart
+                    context->json++;
+                    ret = ch == '{' ? builder->end_object(slot, 0) : builder->end_array(slot, 0);
+                } else {
+                    if (frame)
+                        frame->count = count;
+                    frame = naive_push_frame(context, inline_frames);
+                    builder->init_member(&frame->member);
+                    count = 0;
+                    frame->object = object = ch == '{';
+                    slot = &frame->member.value;
+                    builder->init(slot);
+                    if (object)
+                        ret = naive_parse_key(context, builder, &frame->member);
+                    continue;
+                }
+            } else
+                ret = naive_parse_scalar(context, builder, slot);
+            while (ret == NAIVE_PARSE_OK) {
+                if (frame == nullptr) {
+                    // the root is complete
+                    naive_unwind_frames(context, builder, inline_frames);
+                    return NAIVE_PARSE_OK;
+                }
+                if (object)
+                    builder->member(&frame->member);
+                else
+                    builder->element(slot);
+                count++;
+                naive_parse_whitespace(context);
+                ch = naive_peek(context);
+                if (ch == ',') {
+                    context->json++;
+                    naive_parse_whitespace(context);
+                    builder->init(slot);
+                    if (object && (ret = naive_parse_key(context, builder, &frame->member)) != NAIVE_PARSE_OK)
+                        break;
+                    ch = naive_peek(context);
+                    if (ch == '[' || ch == '{')
+                        break;
+                    ret = naive_parse_scalar(context, builder, slot);
+                    continue;
+                }
+                if (ch != (object ? '}' : ']')) {
+                    ret = object ? NAIVE_PARSE_MISS_COMMA_OR_CURLY_BRACKET : NAIVE_PARSE_MISS_COMMA_OR_SQUARE_BRACKET;
+                    break;
+                }
+                context->json++;
+                // the closed container goes into the slot of the one around it, or into the root; it stays
+                // open until the builder took its children, which the unwinding drops otherwise
+                slot = context->depth > 1 ? &(frame - 1)->member.value : value;
+                ret = object ? builder->end_object(slot, count) : builder->end_array(slot, count);
+                if (ret != NAIVE_PARSE_OK)
+                    break;
+                if (--context->depth) {
+                    frame--;
+                    object = frame->object;
+                    count = frame->count;
+                } else {
+                    frame = nullptr;
+                }
+            }
+        }
+    } catch (...) {
+        if (frame)
+            frame->count = count;
+        naive_unwind_frames(context, builder, inline_frames);
+        throw;
+    }
+    if (frame)
+        frame->count = count;
+    naive_unwind_frames(context, builder, inline_frames);
+    return ret;
+}
+
+int naive_parse_string(NaiveContext* context, NaiveValue* value) {
+    NaiveTreeBuilder builder = {context};
+    return naive_parse_string(context, &builder, value);
+}
+
+int naive_parse_array(NaiveContext* context, NaiveValue* value) {
+    NaiveTreeBuilder builder = {context};
+    assert(context->json != context->end && *context->json == '[');
+    return naive_parse_value(context, &builder, value);
+}
+
+int naive_parse_object(NaiveContext* context, NaiveValue* value) {
+    NaiveTreeBuilder builder = {context};
+    int ret;
+    assert(context->json != context->end && *context->json == '{');
+    if ((ret = naive_parse_value(context, &builder, value)) != NAIVE_PARSE_OK)
+        value->type = NAIVE_NULL;
+    return ret;
+}
+
+int naive_parse_value(NaiveContext* context, NaiveValue* value) {
+    NaiveTreeBuilder builder = {context};
+    return naive_parse_value(context, &builder, value);
+}
+
+// walks [json, json + len) with the tree grammar but only reports what it meets to `handler`, nothing is
+// allocated besides the context stack that escaped strings are decoded on. No tree is built, so
+// `max_depth` may be 0 to lift the limit and let the depth cost heap only
+int naive_parse_sax(const NaiveHandler* handler, const char* json, size_t len, size_t max_depth) {
+    NaiveContext context;
+    NaiveEventBuilder builder = {handler};
+    NaiveEventBuilder::Value value;
+    assert(handler != nullptr);
+    naive_context_init(&context, json, len, nullptr, 0);
+    context.max_depth = max_depth ? max_depth : SIZE_MAX;
+    naive_parse_whitespace(&context);
+    int ret;
+    try {
+        ret = naive_parse_value(&context, &builder, &value);
+    } catch (...) {
+        // a handler may throw too
+        free(context.stack);
+        throw;
+    }
+    if (ret == NAIVE_PARSE_OK) {
+        naive_parse_whitespace(&context);
+        if (context.json != context.end)
+            ret = NAIVE_PARSE_ROOT_NOT_SINGULAR;
+    }
+    assert(context.top == 0);
+    free(context.stack);
+    return ret;
+}
+
+// two-stage parsing. Stage 1 classifies the input 64 bytes at a time and records the offset of every
+// structural character, opening quote and scalar start outside strings; on large inputs it runs in parts,
+// one per thread. Stage 2 builds the tree from those offsets alone, see naive_parse_structurals.
+static const size_t NAIVE_INDEX_MIN_PART = 1024 * 1024;
+
+// one bit per byte of a 64-byte block
+struct NaiveBlock {
+    uint64_t backslash, quote, whitespace, op;
+};
+
+#if defined(NAIVE_AVX2)
+static uint64_t naive_block_mask(__m256i lo, __m256i hi, char ch) {
+    __m256i c = _mm256_set1_epi8(ch);
+    return static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(lo, c))) |
+           static_cast<uint64_t>(static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(hi, c)))) << 32;
+}
+
+static void naive_classify(const char* p, NaiveBlock* block) {
+    __m256i lo = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+    __m256i hi = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + 32));
+    // '[' and ']' are '{' and '}' with bit 5 cleared
+    __m256i case_lo = _mm256_or_si256(lo, _mm256_set1_epi8(0x20));
+    __m256i case_hi = _mm256_or_si256(hi, _mm256_set1_epi8(0x20));
+    block->backslash = naive_block_mask(lo, hi, '\\');
+    block->quote = naive_block_mask(lo, hi, '\"');
+    block->whitespace = naive_block_mask(lo, hi, ' ') | naive_block_mask(lo, hi, '\t') |
+                        naive_block_mask(lo, hi, '\n') | naive_block_mask(lo, hi, '\r');
+    block->op = naive_block_mask(case_lo, case_hi, '{') | naive_block_mask(case_lo, case_hi, '}') |
+                naive_block_mask(lo, hi, ':') | naive_block_mask(lo, hi, ',');
+}
+#elif defined(NAIVE_SSE2)
+static uint64_t naive_block_mask(const __m128i* v, char ch) {
+    __m128i c = _mm_set1_epi8(ch);
+    uint64_t mask = 0;
+    for (int i = 0; i < 4; i++)
+        mask |= static_cast<uint64_t>(static_cast<unsigned>(_mm_movemask_epi8(_mm_cmpeq_epi8(v[i], c)))) << (16 * i);
+    return mask;
+}
+
+static void naive_classify(const char* p, NaiveBlock* block) {
+    __m128i v[4], folded[4];
+    for (int i = 0; i < 4; i++) {
+        v[i] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + 16 * i));
+        // '[' and ']' are '{' and '}' with bit 5 cleared
+        folded[i] = _mm_or_si128(v[i], _mm_set1_epi8(0x20));
+    }
+    block->backslash = naive_block_mask(v, '\\');
+    block->quote = naive_block_mask(v, '\"');
+    block->whitespace = naive_block_mask(v, ' ') | naive_block_mask(v, '\t') | naive_block_mask(v, '\n') |
+                        naive_block_mask(v, '\r');
+    block->op = naive_block_mask(folded, '{') | naive_block_mask(folded, '}') | naive_block_mask(v, ':') |
+                naive_block_mask(v, ',');
+}
+#else
+static void naive_classify(const char* p, NaiveBlock* block) {
+    block->backslash = block->quote = block->whitespace = block->op = 0;
+    for (int i = 0; i < 64; i++) {
+        uint64_t bit = static_cast<uint64_t>(1) << i;
+        switch (p[i]) {
+            case '\\':
+                block->backslash |= bit;
+                break;
+            case '\"':
+                block->quote |= bit;
+                break;
+            case ' ':
+            case '\t':
+            case '\n':
+            case '\r':
+                block->whitespace |= bit;
+                break;
+            case '{':
+            case '}':
+            case '[':
+            case ']':
+            case ':':
+            case ',':
+                block->op |= bit;
+                break;
+            default:
+                break;
+        }
+    }
+}
+#endif
+
+// the characters escaped by a backslash, `carry` is set when the block ends in an unescaped backslash
+static uint64_t naive_escaped(uint64_t backslash, uint64_t* carry) {
+    uint64_t escaped = *carry;
+    *carry = 0;
+    // backslashes are rare, walking them one by one is cheaper than the branch-free sequence arithmetic
+    uint64_t b = backslash & ~escaped;
+    while (b) {
+        unsigned i = naive_ctz64(b);
+        if (i == 63) {
+            *carry = 1;
+            break;
+        }
+        escaped |= static_cast<uint64_t>(1) << (i + 1);
+        b &= ~(static_cast<uint64_t>(3) << i);
+    }
+    return escaped;
+}
+
+// bit i is the parity of the bits up to and including i: from an opening quote up to its closing one
+static uint64_t naive_prefix_xor(uint64_t x) {
+#if defined(NAIVE_AVX2) && defined(__PCLMUL__)
+    return static_cast<uint64_t>(_mm_cvtsi128_si64(
+            _mm_clmulepi64_si128(_mm_set_epi64x(0, static_cast<long long>(x)), _mm_set1_epi8(-1), 0)));
+#else
+    x ^= x << 1;
+    x ^= x << 2;
+    x ^= x << 4;
+    x ^= x << 8;
+    x ^= x << 16;
+    x ^= x << 32;
+    return x;
+#endif
+}
+
+static bool naive_is_scalar_char(char ch) {
+    return !ISWHITESPACE(ch) && ch != '\"' && ch != '{' && ch != '}' && ch != '[' && ch != ']' && ch != ':' &&
+           ch != ',';
+}
+
+// classifies [begin, end) of `json`, which starts outside of an escape and inside a string if
+// `in_string` is all ones. With `Emit` the offsets go to `index` and their count to `*count`. Returns
+// the string state at `end`.
+template <bool Emit>
+static uint64_t naive_index_part(const char* json, size_t begin, size_t end, uint64_t in_string, uint32_t* index,
+                                 size_t* count) {
+    uint64_t escape = 0;
+    uint64_t scalar = !in_string && begin > 0 && naive_is_scalar_char(json[begin - 1]);
+    size_t n = 0;
+    for (size_t i = begin; i < end; i += 64) {
+        NaiveBlock block;
+        if (end - i >= 64) {
+            naive_classify(json + i, &block);
+        } else {
+            // the tail is padded with whitespace, which adds nothing to the index
+            char tail[64];
+            memset(tail, ' ', sizeof(tail));
+            memcpy(tail, json + i, end - i);
+            naive_classify(tail, &block);
+        }
+        uint64_t quote = block.quote & ~naive_escaped(block.backslash, &escape);
+        uint64_t string = naive_prefix_xor(quote) ^ in_string;
+        in_string = static_cast<uint64_t>(static_cast<int64_t>(string) >> 63);
+        if (!Emit)
+            continue;
+        // scalars are indexed where they start: behind whitespace, a structural character or a string
+        uint64_t other = ~(block.whitespace | block.op | block.quote | string);
+        uint64_t structural = (block.op & ~string) | (quote & string) | (other & ~(other << 1 | scalar));
+        scalar = other >> 63;
+        while (structural) {
+            index[n++] = static_cast<uint32_t>(i + naive_ctz64(structural));
+            structural &= structural - 1;
+        }
+    }
+    if (Emit)
+        *count = n;
+    return in_string;
+}
+
+// fills `index` (room for `len` offsets) and returns how many there are
+static size_t naive_build_index(const char* json, size_t len, unsigned threads, uint32_t* index) {
+    size_t parts = len / NAIVE_INDEX_MIN_PART;
+    // asking for the core count costs more than indexing a small document
+    if (parts > 1 && threads == 0)
+        threads = std::thread::hardware_concurrency();
+    if (parts > threads)
+        parts = threads;
+    if (parts <= 1) {
+        size_t count;
+        naive_index_part<true>(json, 0, len, 0, index, &count);
+        return count;
+    }
+    // parts may not start behind a backslash, so that none of them starts inside an escape
+    std::vector<size_t> bounds(parts + 1);
+    bounds[0] = 0;
+    for (size_t i = 1; i < parts; i++) {
+        size_t b = len / parts * i;
+        if (b < bounds[i - 1])
+            b = bounds[i - 1];
+        while (b < len && json[b - 1] == '\\')
+            b++;
+        bounds[i] = b;
+    }
+    bounds[parts] = len;
+
+    // 1. whether each part flips the string state, 2. the index of each part from its actual state
+    std::vector<uint64_t> state(parts);
+    std::vector<size_t> count(parts);
+    std::vector<std::thread> workers;
+    for (size_t i = 1; i < parts; i++)
+        workers.push_back(std::thread([&, i]() {
+            state[i] = naive_index_part<false>(json, bounds[i], bounds[i + 1], 0, nullptr, nullptr);
+        }));
+    state[0] = naive_index_part<false>(json, bounds[0], bounds[1], 0, nullptr, nullptr);
+    for (size_t i = 0; i < workers.size(); i++)
+        workers[i].join();
+    workers.clear();
+    uint64_t in_string = 0;
+    for (size_t i = 0; i < parts; i++) {
+        uint64_t flips = state[i];
+        state[i] = in_string;
+        in_string ^= flips;
+    }
+    // a part never has more offsets than bytes, so each writes from its own first byte on
+    for (size_t i = 1; i < parts; i++)
+        workers.push_back(std::thread([&, i]() {
+            naive_index_part<true>(json, bounds[i], bounds[i + 1], state[i], index + bounds[i], &count[i]);
+        }));
+    naive_index_part<true>(json, bounds[0], bounds[1], state[0], index, &count[0]);
+    for (size_t i = 0; i < workers.size(); i++)
+        workers[i].join();
+    size_t n = count[0];
+    for (size_t i = 1; i < parts; i++) {
+        memmove(index + n, index + bounds[i], count[i] * sizeof(uint32_t));
+        n += count[i];
+    }
+    return n;
+}
+
+// a token ending at `p` is followed by the one at `next`: only whitespace, which stage 1 leaves out, may
+// lie between them. Anything else is the rest of a scalar its parser stopped short of
+static inline bool naive_index_follows(const char* p, const char* next) {
+    return p == next || (p < next && ISWHITESPACE(*p));
+}
+
+// the key and colon in front of a member's value, from the offsets at `*s`
+template <typename Builder>
+static inline int naive_index_key(NaiveContext* context, Builder* builder, typename Builder::Member* member,
+                                  const char* json, const uint32_t** s, const uint32_t* s_end) {
+    char* str;
+    size_t len;
+    int ret;
+    if (*s == s_end || json[**s] != '"')
+        return NAIVE_PARSE_INVALID_VALUE;
+    context->json = json + *(*s)++;
+    if ((ret = naive_parse_string_raw(context, &str, &len)) != NAIVE_PARSE_OK ||
+        (ret = builder->key(member, str, len)) != NAIVE_PARSE_OK)
+        return ret;
+    if (*s == s_end || json[**s] != ':' || !naive_index_follows(context->json, json + **s))
+        return NAIVE_PARSE_INVALID_VALUE;
+    context->json = json + *(*s)++ + 1;
+    return NAIVE_PARSE_OK;
+}
+
+template <typename Builder>
+static inline int naive_index_scalar(NaiveContext* context, Builder* builder, typename Builder::Value* value,
+                                     const char* json, const uint32_t** s, const uint32_t* s_end) {
+    if (*s == s_end)
+        return NAIVE_PARSE_INVALID_VALUE;
+    context->json = json + *(*s)++;
+    return naive_parse_scalar(context, builder, value);
+}
+
+// Stage 2: the grammar of naive_parse_value with the offsets in [s, s_end) as its tokens. Brackets, commas
+// and colons are taken from the index without reading the bytes around them, scalars and keys are parsed
+// from their offset on, and context->json is always the end of the last token, which must be followed by
+// whitespace or the next offset. Errors besides NAIVE_PARSE_TOO_DEEP are all NAIVE_PARSE_INVALID_VALUE,
+// the caller reparses failing documents for the precise one.
+template <typename Builder>
+static int naive_parse_structurals(NaiveContext* context, Builder* builder, typename Builder::Value* value,
+                                   const uint32_t* s, const uint32_t* s_end) {
+    typedef NaiveFrame<Builder> Frame;
+    Frame inline_frames[NAIVE_INLINE_FRAMES];
+    Frame* frame = nullptr;
+    bool object = false;
+    size_t count = 0;
+    typename Builder::Value* slot = value;
+    const char* json = context->json;
+    int ret = NAIVE_PARSE_OK;
+    assert(context->depth == 0);
+    context->frames = reinterpret_cast<char*>(inline_frames);
+    context->frames_size = sizeof(inline_frames);
+    try {
+        while (ret == NAIVE_PARSE_OK) {
+            char ch = s != s_end ? json[*s] : '\0';
+            if (ch == '[' || ch == '{') {
+                context->json = json + *s++ + 1;
+                if (context->depth == context->max_depth) {
+                    ret = NAIVE_PARSE_TOO_DEEP;
+                    break;
+                }
+                if ((ret = ch == '{' ? builder->start_object() : builder->start_array()) != NAIVE_PARSE_OK)
+                    break;
+                if (s != s_end && json[*s] == ch + 2) {
+                    context->json = json + *s++ + 1;
+                    ret = ch == '{' ? builder->end_object(slot, 0) : builder->end_array(slot, 0);
+                } else {
+                    if (frame)
+                        frame->count = count;
+                    frame = naive_push_frame(context, inline_frames);
+                    builder->init_member(&frame->member);
+                    count = 0;
+                    frame->object = object = ch == '{';
+                    slot = &frame->member.value;
+                    builder->init(slot);
+                    if (object)
+                        ret = naive_index_key(context, builder, &frame->member, json, &s, s_end);
+                    continue;
+                }
+            } else
+                ret = naive_index_scalar(context, builder, slot, json, &s, s_end);
+            while (ret == NAIVE_PARSE_OK) {
+                const char* next = s != s_end ? json + *s : context->end;
+                if (frame == nullptr) {
+                    // the root is complete and must be the last token
+                    naive_unwind_frames(context, builder, inline_frames);
+                    return s == s_end && naive_index_follows(context->json, next) ? NAIVE_PARSE_OK
+                                                                                  : NAIVE_PARSE_INVALID_VALUE;
+                }
+                if (object)
+                    builder->member(&frame->member);
+                else
+                    builder->element(slot);
+                count++;
+                if (s == s_end || !naive_index_follows(context->json, next)) {
+                    ret = NAIVE_PARSE_INVALID_VALUE;
+                    break;
+                }
+                context->json = next + 1;
+                ch = json[*s++];
+                if (ch == ',') {
+                    builder->init(slot);
+                    if (object && (ret = naive_index_key(context, builder, &frame->member, json, &s, s_end)) !=
+                                          NAIVE_PARSE_OK)
+                        break;
+                    if (s != s_end && (json[*s] == '[' || json[*s] == '{'))
+                        break;
+                    ret = naive_index_scalar(context, builder, slot, json, &s, s_end);
+                    continue;
+                }
+                if (ch != (object ? '}' : ']')) {
+                    ret = NAIVE_PARSE_INVALID_VALUE;
+                    break;
+                }
+                slot = context->depth > 1 ? &(frame - 1)->member.value : value;
+                ret = object ? builder->end_object(slot, count) : builder->end_array(slot, count);
+                if (ret != NAIVE_PARSE_OK)
+                    break;
+                if (--context->depth) {
+                    frame--;
+                    object = frame->object;
+                    count = frame->count;
+                } else {
+                    frame = nullptr;
+                }
+            }
+        }
+    } catch (...) {
+        if (frame)
+            frame->count = count;
+        naive_unwind_frames(context, builder, inline_frames);
+        throw;
+    }
+    if (frame)
+        frame->count = count;
+    naive_unwind_frames(context, builder, inline_frames);
+    return ret;
+}
+
+int naive_parse_indexed(NaiveValue* value, const char* json, size_t len, unsigned threads) {
+    return naive_parse_indexed(value, json, len, threads, nullptr);
+}
+
+// builds the same tree, and fails with the same error, as naive_parse_n. `threads` (0 for one per core)
+// share stage 1 of inputs of several megabytes; the index takes four bytes per input byte while the
+// document is parsed
+int naive_parse_indexed(NaiveValue* value, const char* json, size_t len, unsigned threads, NaiveArena* arena) {
+    assert(value != nullptr && (json != nullptr || len == 0));
+    if (len > UINT32_MAX)
+        return naive_parse_n(value, json, len, arena);
+    uint32_t* index = static_cast<uint32_t*>(malloc(len * sizeof(uint32_t) + 1));
+    if (index == nullptr)
+        throw std::bad_alloc();
+    int ret;
+    NaiveContext context;
+    NaiveTreeBuilder builder = {&context};
+    naive_context_init(&context, json, len, arena, 0);
+    naive_init(value);
+    try {
+        size_t count = naive_build_index(json, len, threads, index);
+        ret = naive_parse_structurals(&context, &builder, value, index, index + count);
+    } catch (...) {
+        free(context.stack);
+        free(index);
+        throw;
+    }
+    assert(context.top == 0);
+    free(context.stack);
+    free(index);
+    if (ret == NAIVE_PARSE_OK)
+        return ret;
+    // stage 2 only knows that the document is invalid, the byte-wise grammar tells why
+    naive_free(value);
+    return naive_parse_n(value, json, len, arena);
+}
+
+// incremental parsing: the grammar above as a state machine, so that it can stop at the end of any chunk.
+// Scalars are still parsed whole by the token functions, a token running past the end of a chunk is
+// collected in NaiveStream::token until the chunk that completes it arrives
+enum {
+    NAIVE_STREAM_VALUE = 0,
+    NAIVE_STREAM_ARRAY_FIRST,  // after '['
+    NAIVE_STREAM_ARRAY_NEXT,   // after an element
+    NAIVE_STREAM_OBJECT_FIRST, // after '{'
+    NAIVE_STREAM_KEY,          // after ',' in an object
+    NAIVE_STREAM_COLON,
+    NAIVE_STREAM_OBJECT_NEXT,  // after a member
+    NAIVE_STREAM_DONE          // the root is complete, only whitespace may follow
+};
+
+enum {
+    NAIVE_TOKEN_NONE = 0,
+    NAIVE_TOKEN_STRING,
+    NAIVE_TOKEN_NUMBER,
+    NAIVE_TOKEN_LITERAL
+};
+
+static bool naive_is_number_char(char ch) {
+    return ISDIGIT(ch) || ch == '-' || ch == '+' || ch == '.' || ch == 'e' || ch == 'E';
+}
+
+static bool naive_is_literal_char(char ch) {
+    return ch >= 'a' && ch <= 'z';
+}
+
+// end of the token continued at `p`, nullptr if it runs past `end`. Strings are scanned from behind the
+// opening quote and end behind the closing one, `escaped` carries a backslash across chunks
+static const char* naive_token_end(int token, bool* escaped, const char* p, const char* end) {
+    switch (token) {
+        case NAIVE_TOKEN_STRING:
+            while (p != end) {
+                if (*escaped) {
+                    *escaped = false;
+                    p++;
+                    continue;
+                }
+                p = naive_scan_string(p, end);
+                if (p == end)
+                    break;
+                if (*p == '\"')
+                    return p + 1;
+                *escaped = *p++ == '\\';
+            }
+            return nullptr;
+        case NAIVE_TOKEN_NUMBER:
+            while (p != end && naive_is_number_char(*p))
+                p++;
+            break;
+        default:
+            while (p != end && naive_is_literal_char(*p))
+                p++;
+            break;
+    }
+    return p != end ? p : nullptr;
+}
+
+// what the grammar reports for an unexpected character in `state`
+static int naive_stream_unexpected(int state) {
+    switch (state) {
+        case NAIVE_STREAM_ARRAY_NEXT:
+            return NAIVE_PARSE_MISS_COMMA_OR_SQUARE_BRACKET;
+        case NAIVE_STREAM_OBJECT_FIRST:
+        case NAIVE_STREAM_KEY:
+            return NAIVE_PARSE_MISS_KEY;
+        case NAIVE_STREAM_COLON:
+            return NAIVE_PARSE_MISS_COLON;
+        case NAIVE_STREAM_OBJECT_NEXT:
+            return NAIVE_PARSE_MISS_COMMA_OR_CURLY_BRACKET;
+        case NAIVE_STREAM_DONE:
+            return NAIVE_PARSE_ROOT_NOT_SINGULAR;
+        default:
+            return NAIVE_PARSE_EXPECT_VALUE;
+    }
+}
+
+static void naive_stream_keep(NaiveStream* stream, const char* p, size_t len) {
+    if (stream->tokenlen + len > stream->tokencap) {
+        size_t capacity = stream->tokencap ? stream->tokencap : NAIVE_STACK_INIT_SIZE;
+        while (stream->tokenlen + len > capacity)
+            capacity += capacity >> 1;
+        char* token = static_cast<char*>(realloc(stream->token, capacity));
+        if (token == nullptr)
+            throw std::bad_alloc();
+        stream->token = token;
+        stream->tokencap = capacity;
+    }
+    memcpy(stream->token + stream->tokenlen, p, len);
+    stream->tokenlen += len;
+}
+
+template <typename Builder>
+static NaiveFrame<Builder>* naive_stream_top(NaiveStream* stream) {
+    const NaiveContext* context = &stream->context;
+    return context->depth ? reinterpret_cast<NaiveFrame<Builder>*>(context->frames) + context->depth - 1 : nullptr;
+}
+
+// where the next value goes: the root, the open member or `element` for arrays
+template <typename Builder>
+static typename Builder::Value* naive_stream_slot(NaiveStream* stream, Builder* builder, typename Builder::Value* root,
+                                                  typename Builder::Value* element) {
+    NaiveFrame<Builder>* frame = naive_stream_top<Builder>(stream);
+    typename Builder::Value* slot = frame == nullptr ? root : frame->object ? &frame->member.value : element;
+    builder->init(slot);
+    return slot;
+}
+
+// hands the value just written to its container
+template <typename Builder>
+static void naive_stream_complete(NaiveStream* stream, Builder* builder, typename Builder::Value* slot) {
+    NaiveFrame<Builder>* frame = naive_stream_top<Builder>(stream);
+    if (frame == nullptr) {
+        stream->state = NAIVE_STREAM_DONE;
+    } else if (frame->object) {
+        builder->member(&frame->member);
+        frame->count++;
+        stream->state = NAIVE_STREAM_OBJECT_NEXT;
+    } else {
+        builder->element(slot);
+        frame->count++;
+        stream->state = NAIVE_STREAM_ARRAY_NEXT;
+    }
+}
+
+template <typename Builder>
+static int naive_stream_open(NaiveStream* stream, Builder* builder, bool object) {
+    NaiveContext* context = &stream->context;
+    int ret;
+    if (context->depth == context->max_depth)
+        return NAIVE_PARSE_TOO_DEEP;
+    if ((ret = object ? builder->start_object() : builder->start_array()) != NAIVE_PARSE_OK)
+        return ret;
+    size_t size = (context->depth + 1) * sizeof(NaiveFrame<Builder>);
+    if (size > context->frames_size) {
+        size_t frames_size = context->frames_size ? context->frames_size : 16 * sizeof(NaiveFrame<Builder>);
+        while (size > frames_size)
+            frames_size += frames_size >> 1;
+        char* frames = static_cast<char*>(realloc(context->frames, frames_size));
+        if (frames == nullptr)
+            throw std::bad_alloc();
+        context->frames = frames;
+        context->frames_size = frames_size;
+    }
+    NaiveFrame<Builder>* frame = reinterpret_cast<NaiveFrame<Builder>*>(context->frames) + context->depth++;
+    builder->init_member(&frame->member);
+    frame->count = 0;
+    frame->object = object;
+    stream->state = object ? NAIVE_STREAM_OBJECT_FIRST : NAIVE_STREAM_ARRAY_FIRST;
+    return NAIVE_PARSE_OK;
+}
+
+template <typename Builder>
+static int naive_stream_close(NaiveStream* stream, Builder* builder, typename Builder::Value* root) {
+    NaiveFrame<Builder>* frame = naive_stream_top<Builder>(stream);
+    size_t count = frame->count;
+    bool object = frame->object;
+    typename Builder::Value element;
+    stream->context.depth--;
+    typename Builder::Value* slot = naive_stream_slot(stream, builder, root, &element);
+    int ret;
+    if ((ret = object ? builder->end_object(slot, count) : builder->end_array(slot, count)) != NAIVE_PARSE_OK)
+        return ret;
+    naive_stream_complete(stream, builder, slot);
+    return NAIVE_PARSE_OK;
+}
+
+// parses the complete token [context->json, end), which ends where the input does or at a character
+// the token can't contain
+template <typename Builder>
+static int naive_stream_token(NaiveStream* stream, Builder* builder, typename Builder::Value* root, int token,
+                              const char* end) {
+    NaiveContext* context = &stream->context;
+    typename Builder::Value element;
+    typename Builder::Value* slot;
+    int ret;
+    NaiveValue number;
+    char* str;
+    size_t len;
+    context->end = end;
+    if (stream->state == NAIVE_STREAM_OBJECT_FIRST || stream->state == NAIVE_STREAM_KEY) {
+        if ((ret = naive_parse_string_raw(context, &str, &len)) != NAIVE_PARSE_OK ||
+            (ret = builder->key(&naive_stream_top<Builder>(stream)->member, str, len)) != NAIVE_PARSE_OK)
+            return ret;
+        stream->state = NAIVE_STREAM_COLON;
+        return NAIVE_PARSE_OK;
+    }
+    slot = naive_stream_slot(stream, builder, root, &element);
+    switch (token) {
+        case NAIVE_TOKEN_STRING:
+            ret = naive_parse_string(context, builder, slot);
+            break;
+        case NAIVE_TOKEN_NUMBER:
+            if ((ret = naive_parse_number(context, &number)) == NAIVE_PARSE_OK)
+                ret = builder->number(slot, &number);
+            break;
+        default:
+            switch (*context->json) {
+                case 'n':
+                    if ((ret = naive_parse_literal(context, "null")) == NAIVE_PARSE_OK)
+                        ret = builder->literal(slot, NAIVE_NULL);
+                    break;
+                case 't':
+                    if ((ret = naive_parse_literal(context, "true")) == NAIVE_PARSE_OK)
+                        ret = builder->literal(slot, NAIVE_TRUE);
+                    break;
+                default:
+                    if ((ret = naive_parse_literal(context, "false")) == NAIVE_PARSE_OK)
+                        ret = builder->literal(slot, NAIVE_FALSE);
+                    break;
+            }
+            break;
+    }
+    if (ret != NAIVE_PARSE_OK)
+        return ret;
+    naive_stream_complete(stream, builder, slot);
+    // "0123" or "nullx": the token ends early and what is left of it can't follow a value
+    if (token != NAIVE_TOKEN_STRING && context->json != end)
+        return naive_stream_unexpected(stream->state);
+    return NAIVE_PARSE_OK;
+}
+
+template <typename Builder>
+static int naive_stream_run(NaiveStream* stream, Builder* builder, typename Builder::Value* root, const char* p,
+                            const char* end) {
+    NaiveContext* context = &stream->context;
+    int ret, token;
+    const char* t;
+    // finish the token left over from the previous chunk first
+    if (stream->pending != NAIVE_TOKEN_NONE) {
+        bool escaped = stream->escaped != 0;
+        t = naive_token_end(stream->pending, &escaped, p, end);
+        stream->escaped = escaped;
+        naive_stream_keep(stream, p, (t ? t : end) - p);
+        if (t == nullptr)
+            return NAIVE_PARSE_OK;
+        p = t;
+        token = stream->pending;
+        stream->pending = NAIVE_TOKEN_NONE;
+        context->json = stream->token;
+        ret = naive_stream_token(stream, builder, root, token, stream->token + stream->tokenlen);
+        stream->tokenlen = 0;
+        if (ret != NAIVE_PARSE_OK)
+            return ret;
+    }
+    while (true) {
+        if (p != end && ISWHITESPACE(*p))
+            p = naive_skip_whitespace(p, end);
+        if (p == end)
+            return NAIVE_PARSE_OK;
+        char ch = *p;
+        switch (stream->state) {
+            case NAIVE_STREAM_ARRAY_NEXT:
+            case NAIVE_STREAM_OBJECT_NEXT:
+                if (ch == ',') {
+                    stream->state = stream->state == NAIVE_STREAM_ARRAY_NEXT ? NAIVE_STREAM_VALUE : NAIVE_STREAM_KEY;
+                    p++;
+                    continue;
+                }
+                if (ch != (stream->state == NAIVE_STREAM_ARRAY_NEXT ? ']' : '}'))
+                    return naive_stream_unexpected(stream->state);
+                p++;
+                if ((ret = naive_stream_close(stream, builder, root)) != NAIVE_PARSE_OK)
+                    return ret;
+                continue;
+            case NAIVE_STREAM_COLON:
+                if (ch != ':')
+                    return NAIVE_PARSE_MISS_COLON;
+                stream->state = NAIVE_STREAM_VALUE;
+                p++;
+                continue;
+            case NAIVE_STREAM_DONE:
+                return NAIVE_PARSE_ROOT_NOT_SINGULAR;
+            case NAIVE_STREAM_OBJECT_FIRST:
+            case NAIVE_STREAM_KEY:
+                if (ch == '}' && stream->state == NAIVE_STREAM_OBJECT_FIRST) {
+                    p++;
+                    if ((ret = naive_stream_close(stream, builder, root)) != NAIVE_PARSE_OK)
+                        return ret;
+                    continue;
+                }
+                if (ch != '\"')
+                    return NAIVE_PARSE_MISS_KEY;
+                token = NAIVE_TOKEN_STRING;
+                break;
+            default:
+                if (ch == ']' && stream->state == NAIVE_STREAM_ARRAY_FIRST) {
+                    p++;
+                    if ((ret = naive_stream_close(stream, builder, root)) != NAIVE_PARSE_OK)
+                        return ret;
+                    continue;
+                }
+                if (ch == '[' || ch == '{') {
+                    p++;
+                    if ((ret = naive_stream_open(stream, builder, ch == '{')) != NAIVE_PARSE_OK)
+                        return ret;
+                    continue;
+                }
+                if (ch == '\"')
+                    token = NAIVE_TOKEN_STRING;
+                else if (ch == 'n' || ch == 't' || ch == 'f')
+                    token = NAIVE_TOKEN_LITERAL;
+                else if (naive_is_number_char(ch))
+                    token = NAIVE_TOKEN_NUMBER;
+                else
+                    return NAIVE_PARSE_INVALID_VALUE;
+                break;
+        }
+        // a token, parsed in place when the chunk holds all of it
+        bool escaped = false;
+        context->json = p;
+        if (token == NAIVE_TOKEN_STRING) {
+            // most strings close within the chunk, only look for the end when parsing them fails
+            if ((ret = naive_stream_token(stream, builder, root, token, end)) == NAIVE_PARSE_OK) {
+                p = context->json;
+                continue;
+            }
+            if (ret == NAIVE_PARSE_HANDLER_ABORTED || naive_token_end(token, &escaped, p + 1, end) != nullptr)
+                return ret;
+        } else {
+            t = naive_token_end(token, &escaped, p, end);
+            if (t != nullptr) {
+                if ((ret = naive_stream_token(stream, builder, root, token, t)) != NAIVE_PARSE_OK)
+                    return ret;
+                p = t;
+                continue;
+            }
+        }
+        // runs past the chunk, keep it for the next one
+        naive_stream_keep(stream, p, end - p);
+        stream->pending = static_cast<unsigned char>(token);
+        stream->escaped = escaped;
+        return NAIVE_PARSE_OK;
+    }
+}
+
+// undoes the open containers, what they hold so far is dropped
+template <typename Builder>
+static void naive_stream_unwind(NaiveStream* stream, Builder* builder) {
+    NaiveFrame<Builder>* frame;
+    while ((frame = naive_stream_top<Builder>(stream)) != nullptr) {
+        if (frame->object)
+            builder->drop_members(&frame->member, frame->count);
+        else
+            builder->drop_elements(frame->count);
+        stream->context.depth--;
+    }
+    stream->pending = NAIVE_TOKEN_NONE;
+    stream->tokenlen = 0;
+}
+
+static void naive_stream_fail(NaiveStream* stream, int error) {
+    stream->error = error;
+    if (stream->handler) {
+        NaiveEventBuilder builder = {stream->handler};
+        naive_stream_unwind(stream, &builder);
+    } else {
+        NaiveTreeBuilder builder = {&stream->context};
+        naive_stream_unwind(stream, &builder);
+        naive_free(stream->value);
+    }
+    assert(stream->context.top == 0);
+}
+
+static void naive_stream_init(NaiveStream* stream, NaiveValue* value, const NaiveHandler* handler,
+                              NaiveArena* arena, size_t max_depth) {
+    naive_context_init(&stream->context, nullptr, 0, arena, 0);
+    stream->context.max_depth = max_depth ? max_depth : SIZE_MAX;
+    stream->value = value;
+    stream->handler = handler;
+    stream->token = nullptr;
+    stream->tokenlen = stream->tokencap = 0;
+    stream->state = NAIVE_STREAM_VALUE;
+    stream->pending = NAIVE_TOKEN_NONE;
+    stream->escaped = 0;
+    stream->error = NAIVE_PARSE_OK;
+    if (value)
+        naive_init(value);
+}
+
+void naive_stream_init(NaiveStream* stream, NaiveValue* value) {
+    naive_stream_init(stream, value, nullptr, nullptr, NAIVE_PARSE_MAX_DEPTH);
+}
+
+// `max_depth` works as in naive_parse_n, and as in naive_parse_sax for a stream of events
+void naive_stream_init(NaiveStream* stream, NaiveValue* value, NaiveArena* arena, size_t max_depth) {
+    assert(value != nullptr && max_depth > 0);
+    naive_stream_init(stream, value, nullptr, arena, max_depth);
+}
+
+void naive_stream_init(NaiveStream* stream, const NaiveHandler* handler, size_t max_depth) {
+    assert(handler != nullptr);
+    naive_stream_init(stream, nullptr, handler, nullptr, max_depth);
+}
+
+// chunks may split the document anywhere, even inside a string, an escape or a number. Once an error
+// is returned it sticks and later chunks are ignored
+int naive_stream_feed(NaiveStream* stream, const char* chunk, size_t len) {
+    assert(stream != nullptr && (chunk != nullptr || len == 0));
+    if (stream->error != NAIVE_PARSE_OK)
+        return stream->error;
+    int ret;
+    if (stream->handler) {
+        NaiveEventBuilder builder = {stream->handler};
+        NaiveEventBuilder::Value root;
+        ret = naive_stream_run(stream, &builder, &root, chunk, chunk + len);
+    } else {
+        NaiveTreeBuilder builder = {&stream->context};
+        ret = naive_stream_run(stream, &builder, stream->value, chunk, chunk + len);
+    }
+    if (ret != NAIVE_PARSE_OK)
+        naive_stream_fail(stream, ret);
+    return ret;
+}
+
+// marks the end of the input and returns what naive_parse_n would have for all the chunks together
+int naive_stream_finish(NaiveStream* stream) {
+    assert(stream != nullptr);
+    if (stream->error != NAIVE_PARSE_OK)
+        return stream->error;
+    int ret = NAIVE_PARSE_OK;
+    if (stream->pending != NAIVE_TOKEN_NONE) {
+        int token = stream->pending;
+        stream->pending = NAIVE_TOKEN_NONE;
+        stream->context.json = stream->token;
+        if (stream->handler) {
+            NaiveEventBuilder builder = {stream->handler};
+            NaiveEventBuilder::Value root;
+            ret = naive_stream_token(stream, &builder, &root, token, stream->token + stream->tokenlen);
+        } else {
+            NaiveTreeBuilder builder = {&stream->context};
+            ret = naive_stream_token(stream, &builder, stream->value, token, stream->token + stream->tokenlen);
+        }
+        stream->tokenlen = 0;
+    }
+    if (ret == NAIVE_PARSE_OK && stream->state != NAIVE_STREAM_DONE)
+        ret = naive_stream_unexpected(stream->state);
+    if (ret != NAIVE_PARSE_OK)
+        naive_stream_fail(stream, ret);
+    return ret;
+}
+
+// releases the stream, a document it has not completed is dropped. A completed one belongs to the caller
+void naive_stream_destroy(NaiveStream* stream) {
+    assert(stream != nullptr);
+    if (stream->error == NAIVE_PARSE_OK && stream->state != NAIVE_STREAM_DONE)
+        naive_stream_fail(stream, NAIVE_PARSE_EXPECT_VALUE);
+    free(stream->context.stack);
+    free(stream->context.frames);
+    free(stream->token);
+    stream->context.stack = stream->context.frames = stream->token = nullptr;
+}
+
+// lazy documents: naive_lazy_parse only validates, values are found by skipping over their siblings and
+// decoded when asked for. Everything below relies on the document being valid.
+static const char* naive_lazy_skip_string(const char* p, const char* end) {
+    // `p` is behind the opening quote
+    while (true) {
+        p = naive_scan_string(p, end);
+        if (*p == '\"')
+            return p + 1;
+        p += 2; // an escape, \uXXXX has no quote or backslash left to confuse the scan
+    }
+}
+
+// the end of the value at `p`, containers are crossed by counting brackets outside strings
+static const char* naive_lazy_skip(const char* p, const char* end) {
+    switch (*p) {
+        case '\"':
+            return naive_lazy_skip_string(p + 1, end);
+        case '[':
+        case '{': {
+            size_t depth = 1;
+            p++;
+            while (true) {
+                p = naive_scan_nesting(p, end);
+                char ch = *p++;
+                if (ch == '\"')
+                    p = naive_lazy_skip_string(p, end);
+                else if (ch == '[' || ch == '{')
+                    depth++;
+                else if (--depth == 0)
+                    return p;
+            }
+        }
+        default:
+            while (p != end && !ISWHITESPACE(*p) && *p != ',' && *p != ']' && *p != '}')
+                p++;
+            return p;
+    }
+}
+
+// the document is checked with the raw-mode validators and nothing else; like the values found later it
+// is skipped without recursion, so its depth is not limited
+int naive_lazy_parse(NaiveLazyValue* root, const char* json, size_t len) {
+    NaiveContext context;
+    NaiveSkipBuilder builder;
+    NaiveSkipBuilder::Value value;
+    int ret;
+    assert(root != nullptr);
+    root->json = root->end = nullptr;
+    naive_context_init(&context, json, len, nullptr, 0);
+    context.max_depth = SIZE_MAX;
+    naive_parse_whitespace(&context);
+    if ((ret = naive_parse_value(&context, &builder, &value)) == NAIVE_PARSE_OK) {
+        naive_parse_whitespace(&context);
+        if (context.json != context.end)
+            ret = NAIVE_PARSE_ROOT_NOT_SINGULAR;
+    }
+    assert(context.stack == nullptr);
+    if (ret != NAIVE_PARSE_OK)
+        return ret;
+    root->end = json + len;
+    root->json = naive_skip_whitespace(json, root->end);
+    return NAIVE_PARSE_OK;
+}
+
+NaiveType naive_lazy_get_type(const NaiveLazyValue* value) {
+    assert(value != nullptr && value->json != nullptr);
+    switch (*value->json) {
+        case 'n':
+            return NAIVE_NULL;
+        case 't':
+            return NAIVE_TRUE;
+        case 'f':
+            return NAIVE_FALSE;
+        case '\"':
+            return NAIVE_STRING;
+        case '[':
+            return NAIVE_ARRAY;
+        case '{':
+            return NAIVE_OBJECT;
+        default:
+            return NAIVE_NUMBER;
+    }
+}
+
+bool naive_lazy_get_boolean(const NaiveLazyValue* value) {
+    assert(value != nullptr && (naive_lazy_get_type(value) == NAIVE_TRUE || naive_lazy_get_type(value) == NAIVE_FALSE));
+    return *value->json == 't';
+}
+
+double naive_lazy_get_number(const NaiveLazyValue* value) {
+    NaiveContext context;
+    NaiveValue number;
+    assert(value != nullptr && naive_lazy_get_type(value) == NAIVE_NUMBER);
+    naive_context_init(&context, value->json, value->end - value->json, nullptr, 0);
+    if (naive_parse_number(&context, &number) != NAIVE_PARSE_OK)
+        return 0.0;
+    return naive_get_number(&number);
+}
+
+// the first element (or key) of the container at `value`, nullptr when it is empty
+static const char* naive_lazy_first(const NaiveLazyValue* value) {
+    const char* p = naive_skip_whitespace(value->json + 1, value->end);
+    return *p == ']' || *p == '}' ? nullptr : p;
+}
+
+// from the end of an element (or member) to the start of the next one, nullptr behind the last
+static const char* naive_lazy_next(const char* p, const char* end) {
+    p = naive_skip_whitespace(p, end);
+    return *p == ',' ? naive_skip_whitespace(p + 1, end) : nullptr;
+}
+
+size_t naive_lazy_get_array_size(const NaiveLazyValue* value) {
+    assert(value != nullptr && naive_lazy_get_type(value) == NAIVE_ARRAY);
+    size_t size = 0;
+    for (const char* p = naive_lazy_first(value); p; p = naive_lazy_next(naive_lazy_skip(p, value->end), value->end))
+        size++;
+    return size;
+}
+
+// skips the `index` elements in front, walking all of them is for naive_lazy_array_next
+bool naive_lazy_get_array_element(const NaiveLazyValue* value, size_t index, NaiveLazyValue* element) {
+    assert(value != nullptr && naive_lazy_get_type(value) == NAIVE_ARRAY && element != nullptr);
+    for (const char* p = naive_lazy_first(value); p; p = naive_lazy_next(naive_lazy_skip(p, value->end), value->end)) {
+        if (index-- == 0) {
+            element->json = p;
+            element->end = value->end;
+            return true;
+        }
+    }
+    return false;
+}
+
+// walks the elements in order without going back to the start: `element` is the cursor, its json is
+// nullptr before the first element
+bool naive_lazy_array_next(const NaiveLazyValue* value, NaiveLazyValue* element) {
+    assert(value != nullptr && naive_lazy_get_type(value) == NAIVE_ARRAY && element != nullptr);
+    const char* p = element->json == nullptr ? naive_lazy_first(value)
+                                             : naive_lazy_next(naive_lazy_skip(element->json, value->end), value->end);
+    if (p == nullptr)
+        return false;
+    element->json = p;
+    element->end = value->end;
+    return true;
+}
+
+size_t naive_lazy_get_object_size(const NaiveLazyValue* value) {
+    assert(value != nullptr && naive_lazy_get_type(value) == NAIVE_OBJECT);
+    size_t size = 0;
+    for (const char* p = naive_lazy_first(value); p; size++) {
+        p = naive_skip_whitespace(naive_lazy_skip_string(p + 1, value->end), value->end);
+        p = naive_lazy_next(naive_lazy_skip(naive_skip_whitespace(p + 1, value->end), value->end), value->end);
+    }
+    return size;
+}
+
+// compares the raw key [p, q) with `key`, keys holding escapes are decoded first
+static bool naive_lazy_key_equal(const char* p, const char* q, const char* key, size_t keylen) {
+    if (memchr(p, '\\', q - p) == nullptr)
+        return static_cast<size_t>(q - p) == keylen && memcmp(p, key, keylen) == 0;
+    NaiveContext context;
+    char* str;
+    size_t len;
+    naive_context_init(&context, p - 1, q - p + 2, nullptr, 0);
+    naive_parse_string_raw(&context, &str, &len);
+    bool equal = len == keylen && memcmp(str, key, keylen) == 0;
+    free(context.stack);
+    return equal;
+}
+
+bool naive_lazy_get_object_value(const NaiveLazyValue* value, const char* key, size_t keylen, NaiveLazyValue* member) {
+    assert(value != nullptr && naive_lazy_get_type(value) == NAIVE_OBJECT && member != nullptr);
+    assert(key != nullptr || keylen == 0);
+    for (const char* p = naive_lazy_first(value); p;) {
+        const char* q = naive_lazy_skip_string(p + 1, value->end);
+        bool found = naive_lazy_key_equal(p + 1, q - 1, key, keylen);
+        p = naive_skip_whitespace(naive_skip_whitespace(q, value->end) + 1, value->end); // behind ':'
+        if (found) {
+            member->json = p;
+            member->end = value->end;
+            return true;
+        }
+        p = naive_lazy_next(naive_lazy_skip(p, value->end), value->end);
+    }
+    return false;
+}
+
+// the same for members: `key` is the cursor, a string holding the raw key, and `member` its value
+bool naive_lazy_object_next(const NaiveLazyValue* value, NaiveLazyValue* key, NaiveLazyValue* member) {
+    assert(value != nullptr && naive_lazy_get_type(value) == NAIVE_OBJECT && key != nullptr && member != nullptr);
+    const char* p;
+    if (key->json == nullptr) {
+        p = naive_lazy_first(value);
+    } else {
+        p = naive_skip_whitespace(naive_lazy_skip_string(key->json + 1, value->end), value->end);
+        p = naive_lazy_next(naive_lazy_skip(naive_skip_whitespace(p + 1, value->end), value->end), value->end);
     }
+    if (p == nullptr)
+        return false;
+    key->json = p;
+    key->end = value->end;
+    p = naive_skip_whitespace(naive_lazy_skip_string(p + 1, value->end), value->end);
+    member->json = naive_skip_whitespace(p + 1, value->end); // behind ':'
+    member->end = value->end;
+    return true;
+}
+
+int naive_lazy_materialize(const NaiveLazyValue* value, NaiveValue* out) {
+    return naive_lazy_materialize(value, out, nullptr);
+}
+
+// decodes the value and everything below it into an ordinary tree
+int naive_lazy_materialize(const NaiveLazyValue* value, NaiveValue* out, NaiveArena* arena) {
+    assert(value != nullptr && value->json != nullptr);
+    return naive_parse_n(out, value->json, naive_lazy_skip(value->json, value->end) - value->json, arena);
 }
 
 // access interface
 NaiveType naive_get_type(const NaiveValue* value) {
     assert(value != nullptr);
-    return value->type;
+    return static_cast<NaiveType>(value->type);
+}
+
+// getters never write, so a raw number decodes on every read until it is decoded here for good, in place;
+// a raw string is copied into the arena the value lives in, which ends it with a '\0' and lets the source
+// text go. Anything else is left alone.
+void naive_materialize(NaiveValue* value) {
+    assert(value != nullptr);
+    if (value->flags & NAIVE_VALUE_RAW)
+        naive_decode_raw(value, value, naive_value_arena(value));
 }
 
 void naive_set_null(NaiveValue* value) {
@@ -435,6 +3939,12 @@ void naive_set_boolean(NaiveValue* value, bool flag) {
 
 double naive_get_number(const NaiveValue* value) {
     assert(value != nullptr && value->type == NAIVE_NUMBER);
+    NaiveValue scratch;
+    value = naive_decoded_number(value, &scratch);
+    if (value->flags & NAIVE_VALUE_INT64)
+        return static_cast<double>(value->i64);
+    if (value->flags & NAIVE_VALUE_UINT64)
+        return static_cast<double>(value->u64);
     return value->number;
 }
 
@@ -444,14 +3954,61 @@ void naive_set_number(NaiveValue* value, double number) {
     value->type = NAIVE_NUMBER;
 }
 
+// only numbers parsed from (or set as) integers qualify, doubles never do
+bool naive_is_int64(const NaiveValue* value) {
+    assert(value != nullptr);
+    NaiveValue scratch;
+    value = naive_decoded_number(value, &scratch);
+    return value->type == NAIVE_NUMBER && (value->flags & NAIVE_VALUE_INT64);
+}
+
+bool naive_is_uint64(const NaiveValue* value) {
+    assert(value != nullptr);
+    NaiveValue scratch;
+    value = naive_decoded_number(value, &scratch);
+    return value->type == NAIVE_NUMBER &&
+           ((value->flags & NAIVE_VALUE_UINT64) || ((value->flags & NAIVE_VALUE_INT64) && value->i64 >= 0));
+}
+
+int64_t naive_get_int64(const NaiveValue* value) {
+    assert(value != nullptr);
+    NaiveValue scratch;
+    value = naive_decoded_number(value, &scratch);
+    assert(naive_is_int64(value));
+    return value->i64;
+}
+
+void naive_set_int64(NaiveValue* value, int64_t number) {
+    naive_free(value);
+    value->i64 = number;
+    value->type = NAIVE_NUMBER;
+    value->flags = NAIVE_VALUE_INT64;
+}
+
+uint64_t naive_get_uint64(const NaiveValue* value) {
+    assert(value != nullptr);
+    NaiveValue scratch;
+    value = naive_decoded_number(value, &scratch);
+    assert(naive_is_uint64(value));
+    return value->u64;
+}
+
+void naive_set_uint64(NaiveValue* value, uint64_t number) {
+    naive_free(value);
+    value->u64 = number;
+    value->type = NAIVE_NUMBER;
+    value->flags = number <= INT64_MAX ? NAIVE_VALUE_INT64 : NAIVE_VALUE_UINT64;
+}
+
+// a raw string is its source text, which is not followed by a '\0'
 const char* naive_get_string(const NaiveValue* value) {
     assert(value != nullptr && value->type == NAIVE_STRING);
-    return value->str;
+    return naive_string_data(value);
 }
 
 size_t naive_get_string_length(const NaiveValue* value) {
     assert(value != nullptr && value->type == NAIVE_STRING);
-    return value->strlen;
+    return naive_string_size(value);
 }
 
 void naive_set_string(NaiveValue* value, const char* str, size_t len) {
@@ -459,12 +4016,8 @@ void naive_set_string(NaiveValue* value, const char* str, size_t len) {
     // zero length changes nothing
     assert(value != nullptr && (str != nullptr || len == 0));
     naive_free(value);
-    // string assignment
-    value->str = static_cast<char*>(malloc(len + 1));
-    memcpy(value->str, str, len);
-    value->str[len] = '\0';
-    value->strlen = len;
-    value->type = NAIVE_STRING;
+    // string assignment, values living in an arena keep their payload there
+    naive_assign_string(value, str, len, naive_value_arena(value));
 }
 
 size_t naive_get_array_size(const NaiveValue* value) {
@@ -481,40 +4034,52 @@ NaiveValue* naive_get_array_element(const NaiveValue* value, size_t index) {
 
 size_t naive_get_array_capacity(const NaiveValue* value) {
     assert(value != nullptr && value->type == NAIVE_ARRAY);
-    return value->arrcap;
+    return naive_block_capacity(value->arr);
 }
 
 void naive_set_array(NaiveValue* value, size_t capacity) {
     assert(value != nullptr);
     naive_free(value);
-    value->type = NAIVE_ARRAY;
-    value->arrlen = 0;
-    value->arrcap = capacity;
-    value->arr = capacity > 0 ? static_cast<NaiveValue*>(malloc(capacity * sizeof(NaiveValue))) : nullptr;
+    naive_assign_array(value, capacity, naive_value_arena(value));
 }
 
 void naive_reserve_array(NaiveValue* value, size_t capacity) {
     assert(value != nullptr && value->type == NAIVE_ARRAY);
-    if (value->arrcap < capacity) {
-        value->arrcap = capacity;
-        value->arr = static_cast<NaiveValue*>(realloc(value->arr, capacity * sizeof(NaiveValue)));
+    size_t arrcap = naive_block_capacity(value->arr);
+    if (arrcap < capacity) {
+        if (value->flags & NAIVE_VALUE_SHARED) {
+            // arena blocks cannot grow in place, a root value moves its elements to a heap block it owns
+            NaiveArena* arena = naive_value_arena(value);
+            NaiveValue* arr = naive_alloc_elements(arena, capacity);
+            naive_place_elements(arr, value->arr, value->arrlen);
+            value->arr = arr;
+            if (arena == nullptr)
+                value->flags &= ~NAIVE_VALUE_SHARED;
+        } else {
+            value->arr = static_cast<NaiveValue*>(naive_realloc_block(value->arr, capacity, capacity * sizeof(NaiveValue)));
+            for (size_t i = arrcap; i < capacity; i++)
+                value->arr[i].chunk = 0;
+        }
     }
 }
 
 void naive_shrink_array(NaiveValue* value) {
     assert(value != nullptr && value->type == NAIVE_ARRAY);
-    if (value->arrcap > value->arrlen) {
-        value->arrcap = value->arrlen;
-        value->arr = static_cast<NaiveValue*>(realloc(value->arr, value->arrlen * sizeof(NaiveValue)));
+    if (naive_block_capacity(value->arr) > value->arrlen) {
+        if (!(value->flags & NAIVE_VALUE_SHARED))
+            value->arr = static_cast<NaiveValue*>(naive_realloc_block(value->arr, value->arrlen, value->arrlen * sizeof(NaiveValue)));
+        else
+            naive_set_block_capacity(value->arr, value->arrlen);
     }
 }
 
 NaiveValue* naive_pushback_array(NaiveValue* value) {
     assert(value != nullptr && value->type == NAIVE_ARRAY);
-    if (value->arrlen == value->arrcap) {
-        naive_reserve_array(value, value->arrcap == 0 ? 1 : value->arrcap * 2);
+    size_t arrcap = naive_block_capacity(value->arr);
+    if (value->arrlen == arrcap) {
+        naive_reserve_array(value, arrcap == 0 ? 1 : arrcap * 2);
     }
-    naive_init(&value->arr[value->arrlen]);
+    naive_init_slot(&value->arr[value->arrlen]);
     return &value->arr[value->arrlen++];
 }
 
@@ -525,12 +4090,13 @@ void naive_popback_array(NaiveValue* value) {
 
 NaiveValue* naive_insert_array(NaiveValue* value, size_t index) {
     assert(value != nullptr && value->type == NAIVE_ARRAY && index < value->arrlen);
-    if (value->arrlen == value->arrcap) {
-        naive_reserve_array(value, value->arrcap == 0 ? 1 : value->arrcap * 2);
+    size_t arrcap = naive_block_capacity(value->arr);
+    if (value->arrlen == arrcap) {
+        naive_reserve_array(value, arrcap == 0 ? 1 : arrcap * 2);
     }
     memmove(value->arr + index + 1, value->arr + index, (value->arrlen - index) * sizeof(NaiveValue));
     value->arrlen++;
-    naive_init(&value->arr[index]);
+    naive_init_slot(&value->arr[index]);
     return &value->arr[index];
 }
 
@@ -560,7 +4126,7 @@ size_t naive_get_object_size(const NaiveValue* value) {
 
 size_t naive_get_object_capacity(const NaiveValue* value) {
     assert(value != nullptr && value->type == NAIVE_OBJECT);
-    return value->mapcap;
+    return naive_block_capacity(value->map);
 }
 
 const char* naive_get_object_key(const NaiveValue* value, size_t index) {
@@ -582,54 +4148,234 @@ NaiveValue* naive_get_object_value(const NaiveValue* value, size_t index) {
     return &value->map[index].value;
 }
 
-size_t naive_get_object_key_index(const NaiveValue* value, const char* key, size_t keylen) {
-    assert(value != nullptr && key != nullptr && value->type == NAIVE_OBJECT);
+// the slot pointing at member `index`
+static size_t naive_index_slot(const NaiveValue* value, size_t index) {
+    size_t mask;
+    NaiveIndexSlot* slots = naive_object_index(value, &mask);
+    size_t pos = naive_hash_key(value->map[index].key, value->map[index].keylen) & mask;
+    while (slots[pos].index != index + 1)
+        pos = (pos + 1) & mask;
+    return pos;
+}
+
+static void naive_index_erase(NaiveValue* value, size_t pos) {
+    size_t mask;
+    NaiveIndexSlot* slots = naive_object_index(value, &mask);
+    // shift back the rest of the cluster so that probing never stops early
+    for (size_t next = (pos + 1) & mask; slots[next].index != 0; next = (next + 1) & mask) {
+        if (((next - (slots[next].hash & mask)) & mask) >= ((next - pos) & mask)) {
+            slots[pos] = slots[next];
+            pos = next;
+        }
+    }
+    slots[pos].index = 0;
+}
+
+// `hash` is only read for objects with an index
+static size_t naive_find_key(const NaiveValue* value, const char* key, size_t keylen, uint32_t hash) {
     size_t i;
+    if (value->flags & NAIVE_VALUE_INDEXED) {
+        size_t mask;
+        const NaiveIndexSlot* slots = naive_object_index(value, &mask);
+        for (size_t pos = hash & mask; slots[pos].index != 0; pos = (pos + 1) & mask) {
+            i = slots[pos].index - 1;
+            if (slots[pos].hash == hash && value->map[i].keylen == keylen &&
+                (value->map[i].key == key || memcmp(value->map[i].key, key, keylen) == 0))
+                return i;
+        }
+        return NAIVE_KEY_NOT_EXIST;
+    }
+    // pooled keys are the same pointer in every document
     for (i = 0; i < value->maplen; ++i) {
-        if (value->map[i].keylen == keylen && memcmp(value->map[i].key, key, keylen) == 0)
+        if (value->map[i].keylen == keylen && (value->map[i].key == key || memcmp(value->map[i].key, key, keylen) == 0))
             return i;
     }
     return NAIVE_KEY_NOT_EXIST;
 }
 
+// lookups never write, so any number of threads may read one document
+size_t naive_get_object_key_index(const NaiveValue* value, const char* key, size_t keylen) {
+    assert(value != nullptr && key != nullptr && value->type == NAIVE_OBJECT);
+    return naive_find_key(value, key, keylen, (value->flags & NAIVE_VALUE_INDEXED) ? naive_hash_key(key, keylen) : 0);
+}
+
 NaiveValue* naive_get_object_value(const NaiveValue* value, const char* key, size_t keylen) {
     // get value by key
     size_t index = naive_get_object_key_index(value, key, keylen);
     return index == NAIVE_KEY_NOT_EXIST ? nullptr : &value->map[index].value;
 }
 
+// JSON Pointer (RFC 6901): the tokens are split, unescaped and hashed once so that evaluating the pointer
+// is one lookup per token
+bool naive_pointer_compile(NaivePointer* pointer, const char* text, size_t len) {
+    assert(pointer != nullptr && (text != nullptr || len == 0));
+    pointer->tokens = nullptr;
+    pointer->count = 0;
+    pointer->buffer = nullptr;
+    if (len == 0)
+        return true; // "" is the whole document
+    if (text[0] != '/')
+        return false;
+    size_t count = 0;
+    for (size_t i = 0; i < len; i++)
+        count += text[i] == '/';
+    // unescaping only shrinks, the buffer holds every token back to back
+    char* buffer = static_cast<char*>(malloc(len));
+    NaivePointerToken* tokens = static_cast<NaivePointerToken*>(malloc(count * sizeof(NaivePointerToken)));
+    if (buffer == nullptr || tokens == nullptr) {
+        free(buffer);
+        free(tokens);
+        throw std::bad_alloc();
+    }
+    const char* p = text + 1;
+    const char* end = text + len;
+    char* dst = buffer;
+    for (size_t t = 0; t < count; t++) {
+        NaivePointerToken* token = &tokens[t];
+        token->key = dst;
+        for (; p != end && *p != '/'; p++) {
+            if (*p != '~') {
+                *dst++ = *p;
+            } else if (p + 1 != end && (p[1] == '0' || p[1] == '1')) {
+                *dst++ = *++p == '0' ? '~' : '/';
+            } else {
+                free(buffer);
+                free(tokens);
+                return false;
+            }
+        }
+        p++; // the next '/'
+        token->keylen = dst - token->key;
+        token->hash = naive_hash_key(token->key, token->keylen);
+        // array indices are digits without leading zeros, "-" (past the end) never resolves
+        token->index = NAIVE_KEY_NOT_EXIST;
+        if (token->keylen > 0 && (token->key[0] != '0' || token->keylen == 1)) {
+            size_t index = 0;
+            size_t i;
+            for (i = 0; i < token->keylen && ISDIGIT(token->key[i]); i++) {
+                size_t digit = token->key[i] - '0';
+                if (index > (NAIVE_KEY_NOT_EXIST - 1 - digit) / 10)
+                    break;
+                index = index * 10 + digit;
+            }
+            if (i == token->keylen)
+                token->index = index;
+        }
+    }
+    pointer->tokens = tokens;
+    pointer->count = count;
+    pointer->buffer = buffer;
+    return true;
+}
+
+void naive_pointer_free(NaivePointer* pointer) {
+    assert(pointer != nullptr);
+    free(pointer->tokens);
+    free(pointer->buffer);
+    pointer->tokens = nullptr;
+    pointer->count = 0;
+    pointer->buffer = nullptr;
+}
+
+NaiveValue* naive_pointer_get(const NaivePointer* pointer, const NaiveValue* root) {
+    assert(pointer != nullptr && root != nullptr);
+    const NaiveValue* value = root;
+    for (size_t t = 0; t < pointer->count; t++) {
+        const NaivePointerToken* token = &pointer->tokens[t];
+        if (value->type == NAIVE_OBJECT) {
+            size_t index = naive_find_key(value, token->key, token->keylen, token->hash);
+            if (index == NAIVE_KEY_NOT_EXIST)
+                return nullptr;
+            value = &value->map[index].value;
+        } else if (value->type == NAIVE_ARRAY && token->index < value->arrlen) {
+            value = &value->arr[token->index];
+        } else {
+            return nullptr;
+        }
+    }
+    return const_cast<NaiveValue*>(value);
+}
+
+// the same walk over a lazy document, only the containers on the path are scanned
+bool naive_pointer_get(const NaivePointer* pointer, const NaiveLazyValue* root, NaiveLazyValue* out) {
+    assert(pointer != nullptr && root != nullptr && out != nullptr);
+    NaiveLazyValue value = *root;
+    for (size_t t = 0; t < pointer->count; t++) {
+        const NaivePointerToken* token = &pointer->tokens[t];
+        NaiveType type = naive_lazy_get_type(&value);
+        if (type == NAIVE_OBJECT) {
+            if (!naive_lazy_get_object_value(&value, token->key, token->keylen, &value))
+                return false;
+        } else if (type != NAIVE_ARRAY || token->index == NAIVE_KEY_NOT_EXIST ||
+                   !naive_lazy_get_array_element(&value, token->index, &value)) {
+            return false;
+        }
+    }
+    *out = value;
+    return true;
+}
+
 void naive_set_object(NaiveValue* value, size_t capacity) {
     assert(value != nullptr);
     naive_free(value);
-    value->type = NAIVE_OBJECT;
-    value->maplen = 0;
-    value->mapcap = capacity;
-    value->map = capacity > 0 ? static_cast<NaiveMember*>(malloc(capacity * sizeof(NaiveMember))) : nullptr;
+    naive_assign_object(value, capacity, naive_value_arena(value));
+}
+
+// moves the members of an arena object to a new block, a root value takes them to a heap block that
+// owns its keys
+static void naive_rebuild_object(NaiveValue* value, size_t capacity) {
+    NaiveArena* arena = naive_value_arena(value);
+    NaiveMember* map = naive_alloc_members(arena, capacity);
+    naive_place_members(map, value->map, value->maplen);
+    if (arena == nullptr) {
+        for (size_t i = 0; i < value->maplen; i++)
+            map[i].key = naive_alloc_string(nullptr, map[i].key, map[i].keylen);
+        value->flags &= ~(NAIVE_VALUE_SHARED | NAIVE_VALUE_BORROWED);
+    }
+    value->map = map;
+    naive_build_object_index(value);
 }
 
 void naive_reserve_object(NaiveValue* value, size_t capacity) {
     assert(value != nullptr && value->type == NAIVE_OBJECT);
-    if (value->mapcap < capacity) {
-        value->mapcap = capacity;
-        value->map = static_cast<NaiveMember*>(realloc(value->map, capacity * sizeof(NaiveMember)));
+    size_t mapcap = naive_block_capacity(value->map);
+    if (mapcap < capacity) {
+        if (value->flags & NAIVE_VALUE_SHARED) {
+            naive_rebuild_object(value, capacity);
+        } else {
+            value->map = static_cast<NaiveMember*>(naive_realloc_block(value->map, capacity, naive_members_size(capacity)));
+            for (size_t i = mapcap; i < capacity; i++)
+                value->map[i].value.chunk = 0;
+            naive_build_object_index(value);
+        }
     }
 }
 
 void naive_shrink_object(NaiveValue* value) {
     assert(value != nullptr && value->type == NAIVE_OBJECT);
-    if (value->mapcap > value->maplen) {
-        value->mapcap = value->maplen;
-        value->map = static_cast<NaiveMember*>(realloc(value->map, value->maplen * sizeof(NaiveMember)));
+    if (naive_block_capacity(value->map) > value->maplen) {
+        if (!(value->flags & NAIVE_VALUE_SHARED))
+            value->map = static_cast<NaiveMember*>(naive_realloc_block(value->map, value->maplen, naive_members_size(value->maplen)));
+        else
+            naive_set_block_capacity(value->map, value->maplen);
+        naive_build_object_index(value);
     }
 }
 
+// keys of arena objects belong to the arena, keys of in-situ objects to the input buffer
+static inline bool naive_owns_keys(const NaiveValue* value) {
+    return !(value->flags & (NAIVE_VALUE_SHARED | NAIVE_VALUE_BORROWED));
+}
+
 void naive_clear_object(NaiveValue* value) {
     assert(value != nullptr && value->type == NAIVE_OBJECT && value->maplen > 0);
     for (size_t i = 0; i < value->maplen; i++) {
-        free(value->map[i].key);
+        if (naive_owns_keys(value))
+            free(value->map[i].key);
         naive_free(&value->map[i].value);
     }
     value->maplen = 0;
+    naive_build_object_index(value);
 }
 
 // FIXME
@@ -639,16 +4385,26 @@ NaiveValue* naive_set_object_value(NaiveValue* value, const char* key, size_t ke
     // return if exist
     if (index != NAIVE_KEY_NOT_EXIST)
         return &value->map[index].value;
-    if (value->maplen == value->mapcap) {
-        naive_reserve_object(value, value->mapcap == 0 ? 1 : value->mapcap * 2);
+    size_t mapcap = naive_block_capacity(value->map);
+    if (value->maplen == mapcap) {
+        naive_reserve_object(value, mapcap == 0 ? 1 : mapcap * 2);
+    } else if ((value->flags & NAIVE_VALUE_SHARED) && naive_value_arena(value) == nullptr) {
+        // a root arena object has nowhere to put the new key but the heap, so it owns its block first
+        naive_rebuild_object(value, mapcap);
+    }
+    if ((value->flags & (NAIVE_VALUE_SHARED | NAIVE_VALUE_BORROWED)) == NAIVE_VALUE_BORROWED) {
+        // a heap object freeing its keys one by one cannot mix in-situ keys with its own
+        for (size_t i = 0; i < value->maplen; i++)
+            value->map[i].key = naive_alloc_string(nullptr, value->map[i].key, value->map[i].keylen);
+        value->flags &= ~NAIVE_VALUE_BORROWED;
     }
     index = value->maplen;
-    value->map[index].key = static_cast<char*>(malloc(keylen + 1));
-    memcpy(value->map[index].key, key, keylen);
-    value->map[index].key[keylen] = '\0';
-    naive_init(&value->map[index].value);
+    value->map[index].key = naive_alloc_string(naive_payload_arena(value), key, keylen);
+    naive_init_slot(&value->map[index].value);
     value->map[index].keylen = keylen;
     value->maplen++;
+    if (value->flags & NAIVE_VALUE_INDEXED)
+        naive_index_insert(value, index, naive_hash_key(key, keylen));
     return &value->map[index].value;
 }
 
@@ -656,73 +4412,389 @@ NaiveValue* naive_set_object_value(NaiveValue* value, const char* key, size_t ke
 void naive_remove_object_value(NaiveValue* value, size_t index) {
     assert(value != nullptr && value->type == NAIVE_OBJECT);
     assert(value->maplen > 0 && index < value->maplen);
-    // swap with the last member
-    // FIX DONE memmove share the same address of char* -> memory leakage
-    if (index != value->maplen - 1) {
-        memcpy(value->map[index].key, value->map[value->maplen - 1].key, value->map[value->maplen - 1].keylen);
-        memcpy(&value->map[index].value, &value->map[value->maplen - 1].value, sizeof(NaiveValue));
-        value->map[index].keylen = value->map[value->maplen - 1].keylen;
+    // swap with the last member, both slots are in the same block so the chunk stamp carries over
+    NaiveMember* member = &value->map[index];
+    if (value->flags & NAIVE_VALUE_INDEXED) {
+        size_t mask;
+        naive_index_erase(value, naive_index_slot(value, index));
+        if (index != value->maplen - 1) {
+            NaiveIndexSlot* slots = naive_object_index(value, &mask);
+            slots[naive_index_slot(value, value->maplen - 1)].index = static_cast<uint32_t>(index + 1);
+        }
     }
-    free(value->map[--value->maplen].key);
-    naive_free(&value->map[value->maplen].value);
+    if (naive_owns_keys(value))
+        free(member->key);
+    naive_free(&member->value);
+    if (index != value->maplen - 1)
+        memcpy(member, &value->map[value->maplen - 1], sizeof(NaiveMember));
+    value->maplen--;
 }
 
-static void naive_stringify_string(NaiveContext* context, const char* str, size_t len) {
+// Ryu (Ulf Adams, "Ryu: Fast Float-to-String Conversion"): finds the shortest decimal in the rounding
+// interval of a double, picking the closest one when several qualify.
+// 5^i and 2^k / 5^i are needed to 125 bits, which are the mantissas of 10^i and 10^-i in
+// naive_pow10_table shifted down by 3.
+static inline void naive_ryu_pow5(int i, uint64_t mul[2]) {
+    const uint64_t* pow10 = naive_pow10_table[i - NAIVE_POW10_MIN_EXP];
+    mul[0] = (pow10[1] >> 3) | (pow10[0] << 61);
+    mul[1] = pow10[0] >> 3;
+}
+
+static inline void naive_ryu_pow5_inv(int i, uint64_t mul[2]) {
+    if (i == 0) {
+        mul[0] = 1;
+        mul[1] = static_cast<uint64_t>(1) << 61;
+        return;
+    }
+    // rounded up
+    const uint64_t* pow10 = naive_pow10_table[-i - NAIVE_POW10_MIN_EXP];
+    mul[0] = ((pow10[1] >> 3) | (pow10[0] << 61)) + 1;
+    mul[1] = (pow10[0] >> 3) + (mul[0] == 0);
+}
+
+// (m * mul) >> j for j >= 64, mul being a 125-bit factor stored as {low, high}
+static inline uint64_t naive_ryu_mul_shift(uint64_t m, const uint64_t mul[2], int j) {
+    uint64_t high0, high1, low1 = naive_mul64(m, mul[1], &high1);
+    naive_mul64(m, mul[0], &high0);
+    uint64_t sum = high0 + low1;
+    if (sum < high0)
+        high1++;
+    // 64 <= j < 128
+    return (high1 << (128 - j)) | (sum >> (j - 64));
+}
+
+static inline int naive_ryu_pow5_factor(uint64_t value) {
+    int count = 0;
+    while (value % 5 == 0) {
+        value /= 5;
+        count++;
+    }
+    return count;
+}
+
+// ceil(log2(5^e)), and 1 for e == 0
+static inline int naive_ryu_pow5_bits(int e) {
+    return static_cast<int>((static_cast<uint32_t>(e) * 1217359) >> 19) + 1;
+}
+
+// digits of a positive finite double: value == *output * 10^*exp10, *output has no trailing zeros
+// beyond what is needed to be the closest shortest representation
+static void naive_ryu(double value, uint64_t* output, int* exp10) {
+    uint64_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    const uint64_t ieee_mantissa = bits & 0x000FFFFFFFFFFFFF;
+    const int ieee_exponent = static_cast<int>((bits >> 52) & 0x7FF);
+    int e2;
+    uint64_t m2;
+    if (ieee_exponent == 0) {
+        e2 = 1 - 1023 - 52 - 2;
+        m2 = ieee_mantissa;
+    } else {
+        e2 = ieee_exponent - 1023 - 52 - 2;
+        m2 = (static_cast<uint64_t>(1) << 52) | ieee_mantissa;
+    }
+    const bool accept_bounds = (m2 & 1) == 0;
+
+    // the interval is [mm, mp] around mv = 4 * m2, scaled by 2^e2; mm is closer for powers of two
+    const uint64_t mv = 4 * m2;
+    const uint64_t mm_shift = ieee_mantissa != 0 || ieee_exponent <= 1;
+    uint64_t vr, vp, vm, mul[2];
+    int e10;
+    bool vm_trailing_zeros = false, vr_trailing_zeros = false;
+    if (e2 >= 0) {
+        // q = floor(log10(2^e2)) minus one when e2 > 3
+        const int q = static_cast<int>((static_cast<uint32_t>(e2) * 78913) >> 18) - (e2 > 3);
+        e10 = q;
+        const int j = -e2 + q + 125 + naive_ryu_pow5_bits(q) - 1;
+        naive_ryu_pow5_inv(q, mul);
+        vr = naive_ryu_mul_shift(mv, mul, j);
+        vp = naive_ryu_mul_shift(mv + 2, mul, j);
+        vm = naive_ryu_mul_shift(mv - 1 - mm_shift, mul, j);
+        if (q <= 21) {
+            // only one of mp, mv and mm can be a multiple of 5
+            if (mv % 5 == 0)
+                vr_trailing_zeros = naive_ryu_pow5_factor(mv) >= q;
+            else if (accept_bounds)
+                vm_trailing_zeros = naive_ryu_pow5_factor(mv - 1 - mm_shift) >= q;
+            else
+                vp -= naive_ryu_pow5_factor(mv + 2) >= q;
+        }
+    } else {
+        // q = floor(log10(5^-e2)) minus one when -e2 > 1
+        const int q = static_cast<int>((static_cast<uint32_t>(-e2) * 732923) >> 20) - (-e2 > 1);
+        e10 = q + e2;
+        const int i = -e2 - q;
+        const int j = q - (naive_ryu_pow5_bits(i) - 125);
+        naive_ryu_pow5(i, mul);
+        vr = naive_ryu_mul_shift(mv, mul, j);
+        vp = naive_ryu_mul_shift(mv + 2, mul, j);
+        vm = naive_ryu_mul_shift(mv - 1 - mm_shift, mul, j);
+        if (q <= 1) {
+            // mv = 4 * m2 always has at least two trailing zero bits
+            vr_trailing_zeros = true;
+            if (accept_bounds)
+                vm_trailing_zeros = mm_shift == 1;
+            else
+                vp--;
+        } else if (q < 63) {
+            vr_trailing_zeros = (mv & ((static_cast<uint64_t>(1) << q) - 1)) == 0;
+        }
+    }
+
+    // drop digits while the interval still holds a shorter candidate
+    int removed = 0;
+    unsigned last_removed = 0;
+    if (vm_trailing_zeros || vr_trailing_zeros) {
+        // rare, the bounds or the exact value end in zeros
+        while (vp / 10 > vm / 10) {
+            vm_trailing_zeros &= vm % 10 == 0;
+            vr_trailing_zeros &= last_removed == 0;
+            last_removed = static_cast<unsigned>(vr % 10);
+            vr /= 10;
+            vp /= 10;
+            vm /= 10;
+            removed++;
+        }
+        if (vm_trailing_zeros) {
+            while (vm % 10 == 0) {
+                vr_trailing_zeros &= last_removed == 0;
+                last_removed = static_cast<unsigned>(vr % 10);
+                vr /= 10;
+                vp /= 10;
+                vm /= 10;
+                removed++;
+            }
+        }
+        // exactly .5 rounds to even
+        if (vr_trailing_zeros && last_removed == 5 && vr % 2 == 0)
+            last_removed = 4;
+        *output = vr + ((vr == vm && (!accept_bounds || !vm_trailing_zeros)) || last_removed >= 5);
+    } else {
+        bool round_up = false;
+        if (vp / 100 > vm / 100) {
+            round_up = vr % 100 >= 50;
+            vr /= 100;
+            vp /= 100;
+            vm /= 100;
+            removed += 2;
+        }
+        while (vp / 10 > vm / 10) {
+            round_up = vr % 10 >= 5;
+            vr /= 10;
+            vp /= 10;
+            vm /= 10;
+            removed++;
+        }
+        *output = vr + (vr == vm || round_up);
+    }
+    *exp10 = e10 + removed;
+}
+
+static char* naive_write_exponent(char* p, int exp) {
+    *p++ = 'e';
+    if (exp < 0) {
+        *p++ = '-';
+        exp = -exp;
+    } else {
+        *p++ = '+';
+    }
+    // at least two digits like printf, e.g. 1e-07
+    if (exp >= 100) {
+        *p++ = static_cast<char>('0' + exp / 100);
+        exp %= 100;
+    }
+    *p++ = static_cast<char>('0' + exp / 10);
+    *p++ = static_cast<char>('0' + exp % 10);
+    return p;
+}
+
+static char* naive_write_uint64(char* p, uint64_t n) {
+    // two digits per division, filled from the back
+    static const char pairs[] =
+            "00010203040506070809101112131415161718192021222324252627282930313233343536373839"
+            "40414243444546474849505152535455565758596061626364656667686970717273747576777879"
+            "8081828384858687888990919293949596979899";
+    char digits[20];
+    char* q = digits + sizeof(digits);
+    while (n >= 100) {
+        q -= 2;
+        memcpy(q, pairs + n % 100 * 2, 2);
+        n /= 100;
+    }
+    if (n >= 10) {
+        q -= 2;
+        memcpy(q, pairs + n * 2, 2);
+    } else {
+        *--q = static_cast<char>('0' + n);
+    }
+    const size_t len = digits + sizeof(digits) - q;
+    memcpy(p, q, len);
+    return p + len;
+}
+
+// writes the shortest representation that parses back to `number`, laid out like "%.17g"
+// (fixed notation for decimal exponents in [-4, 17), scientific otherwise); returns the end
+static char* naive_write_number(char* p, double number) {
+    char digits[20];
+    uint64_t output;
+    int len, k;
+    if (std::signbit(number)) {
+        *p++ = '-';
+        number = -number;
+    }
+    if (number == 0.0) {
+        *p++ = '0';
+        return p;
+    }
+    // integral doubles below 2^53 are exact as integers
+    if (number < 9007199254740992.0 && number == static_cast<double>(static_cast<uint64_t>(number)))
+        return naive_write_uint64(p, static_cast<uint64_t>(number));
+    naive_ryu(number, &output, &k);
+    len = static_cast<int>(naive_write_uint64(digits, output) - digits);
+    // decimal exponent of the leading digit
+    const int exp = len + k - 1;
+    if (exp >= -4 && exp < 17) {
+        if (k >= 0) {
+            memcpy(p, digits, len);
+            p += len;
+            memset(p, '0', k);
+            p += k;
+        } else if (exp >= 0) {
+            memcpy(p, digits, exp + 1);
+            p += exp + 1;
+            *p++ = '.';
+            memcpy(p, digits + exp + 1, len - exp - 1);
+            p += len - exp - 1;
+        } else {
+            *p++ = '0';
+            *p++ = '.';
+            memset(p, '0', -exp - 1);
+            p += -exp - 1;
+            memcpy(p, digits, len);
+            p += len;
+        }
+        return p;
+    }
+    *p++ = digits[0];
+    if (len > 1) {
+        *p++ = '.';
+        memcpy(p, digits + 1, len - 1);
+        p += len - 1;
+    }
+    return naive_write_exponent(p, exp);
+}
+
+// a NAIVE_NUMBER of any representation, at most 25 bytes
+static char* naive_write_number(char* p, const NaiveValue* value) {
+    if (value->flags & NAIVE_VALUE_INT64) {
+        if (value->i64 >= 0)
+            return naive_write_uint64(p, value->u64);
+        *p++ = '-';
+        return naive_write_uint64(p, ~value->u64 + 1);
+    }
+    if (value->flags & NAIVE_VALUE_UINT64)
+        return naive_write_uint64(p, value->u64);
+    return naive_write_number(p, value->number);
+}
+
+// the escape sequence for a byte naive_scan_string stops at
+static char* naive_escape_char(char* p, unsigned char ch) {
     static const char hex_digits[] = {'0', '1', '2', '3', '4', '5', '6', '7', '8', '9', 'A', 'B', 'C', 'D', 'E', 'F'};
-    size_t size;
-    char* head, * p;
+    *p++ = '\\';
+    switch (ch) {
+        case '\"':
+            *p++ = '\"';
+            break;
+        case '\\':
+            *p++ = '\\';
+            break;
+        case '\b':
+            *p++ = 'b';
+            break;
+        case '\f':
+            *p++ = 'f';
+            break;
+        case '\n':
+            *p++ = 'n';
+            break;
+        case '\r':
+            *p++ = 'r';
+            break;
+        case '\t':
+            *p++ = 't';
+            break;
+        default:
+            *p++ = 'u';
+            *p++ = '0';
+            *p++ = '0';
+            *p++ = hex_digits[ch >> 4];
+            *p++ = hex_digits[ch & 15];
+    }
+    return p;
+}
+
+struct NaiveSinkAborted {};
+
+// hands the stack to the sink, followed by `run` (written as is, without a copy) if there is one
+static void naive_sink_flush(NaiveContext* context, const char* run, size_t runlen) {
+    NaiveSlice slices[2];
+    size_t count = 0;
+    if (context->top > 0) {
+        slices[count].data = context->stack;
+        slices[count++].len = context->top;
+    }
+    if (runlen > 0) {
+        slices[count].data = run;
+        slices[count++].len = runlen;
+    }
+    context->top = 0;
+    if (count > 0 && !context->sink->write(context->sink->user, slices, count))
+        throw NaiveSinkAborted();
+}
+
+static inline void naive_sink_spill(NaiveContext* context) {
+    if (context->sink != nullptr && context->top >= NAIVE_SINK_BUFFER_SIZE)
+        naive_sink_flush(context, nullptr, 0);
+}
+
+// runs that need no escaping are found with naive_scan_string and copied whole, so the stack grows by
+// what is actually written. Bound for a sink, long runs skip the stack altogether and go out as a slice
+// of their own.
+static void naive_stringify_string(NaiveContext* context, const char* str, size_t len) {
+    const char* end = str + len;
     assert(str != NULL);
-    // pre alloc space
-    p = head = static_cast<char*>(naive_context_push(context, size = len * 6 + 2)); /* "\u00xx..." */
-    *p++ = '"';
-    for (size_t i = 0; i < len; i++) {
-        unsigned char ch = static_cast<unsigned char >(str[i]);
-        switch (ch) {
-            case '\"':
-                *p++ = '\\';
-                *p++ = '\"';
-                break;
-            case '\\':
-                *p++ = '\\';
-                *p++ = '\\';
-                break;
-            case '\b':
-                *p++ = '\\';
-                *p++ = 'b';
-                break;
-            case '\f':
-                *p++ = '\\';
-                *p++ = 'f';
-                break;
-            case '\n':
-                *p++ = '\\';
-                *p++ = 'n';
-                break;
-            case '\r':
-                *p++ = '\\';
-                *p++ = 'r';
-                break;
-            case '\t':
-                *p++ = '\\';
-                *p++ = 't';
-                break;
-            default:
-                if (ch < 0x20) {
-                    *p++ = '\\';
-                    *p++ = 'u';
-                    *p++ = '0';
-                    *p++ = '0';
-                    *p++ = hex_digits[ch >> 4];
-                    *p++ = hex_digits[ch & 15];
-                } else
-                    *p++ = str[i];
+    const char* run = naive_scan_string(str, end);
+    if (run == end && (context->sink == nullptr || len < NAIVE_SINK_BUFFER_SIZE / 8)) {
+        // the common case, one push of exactly the output
+        char* head = static_cast<char*>(naive_context_push(context, len + 2));
+        head[0] = '"';
+        memcpy(head + 1, str, len);
+        head[len + 1] = '"';
+        return;
+    }
+    PUTC(context, '"');
+    for (;;) {
+        size_t runlen = run - str;
+        if (context->sink != nullptr && runlen >= NAIVE_SINK_BUFFER_SIZE / 8) {
+            naive_sink_flush(context, str, runlen);
+        } else if (runlen > 0) {
+            PUTS(context, str, runlen);
+            naive_sink_spill(context);
+        }
+        for (str = run; str != end && naive_is_string_special(*str); str++) {
+            char* head = static_cast<char*>(naive_context_push(context, 6)); /* \u00xx */
+            context->top -= 6 - (naive_escape_char(head, static_cast<unsigned char>(*str)) - head);
+            naive_sink_spill(context);
         }
+        if (str == end)
+            break;
+        run = naive_scan_string(str, end);
     }
-    *p++ = '"';
-    context->top -= size - (p - head);
+    PUTC(context, '"');
 }
 
 static void naive_stringify_value(NaiveContext* context, const NaiveValue* value) {
+    naive_sink_spill(context);
     switch (value->type) {
         case NAIVE_NULL:
             PUTS(context, "null", 4);
@@ -733,11 +4805,21 @@ static void naive_stringify_value(NaiveContext* context, const NaiveValue* value
         case NAIVE_FALSE:
             PUTS(context, "false", 5);
             break;
-        case NAIVE_NUMBER:
-            context->top -= 32 - sprintf(static_cast<char*>(naive_context_push(context, 32)), "%.17g", value->number);
+        case NAIVE_NUMBER: {
+            if (value->flags & NAIVE_VALUE_RAW) {
+                // a long literal goes to a sink as a slice of its own, like a long string run
+                if (context->sink != nullptr && value->strlen >= NAIVE_SINK_BUFFER_SIZE / 8)
+                    naive_sink_flush(context, value->str, value->strlen);
+                else
+                    PUTS(context, value->str, value->strlen);
+                break;
+            }
+            char* head = static_cast<char*>(naive_context_push(context, 32));
+            context->top -= 32 - (naive_write_number(head, value) - head);
             break;
+        }
         case NAIVE_STRING:
-            naive_stringify_string(context, value->str, value->strlen);
+            naive_stringify_string(context, naive_string_data(value), naive_string_size(value));
             break;
         case NAIVE_ARRAY:
             PUTC(context, '[');
@@ -762,6 +4844,7 @@ static void naive_stringify_value(NaiveContext* context, const NaiveValue* value
         default:
             throw std::runtime_error("invalid type");
     }
+    naive_sink_spill(context);
 }
 
 char* naive_stringify(const NaiveValue* value, size_t* len) {
@@ -770,6 +4853,9 @@ char* naive_stringify(const NaiveValue* value, size_t* len) {
     context.size = NAIVE_PARSE_STRINGIFY_INI_SIZE;
     context.stack = static_cast<char*>(malloc(context.size));
     context.top = 0;
+    context.arena = nullptr;
+    context.flags = 0;
+    context.sink = nullptr;
     naive_stringify_value(&context, value);
     if (len)
         *len = context.top;
@@ -777,64 +4863,356 @@ char* naive_stringify(const NaiveValue* value, size_t* len) {
     return context.stack;
 }
 
+static size_t naive_stringify_string_size(const char* str, size_t len) {
+    const char* end = str + len;
+    size_t size = len + 2;
+    for (const char* p = naive_scan_string(str, end); p != end; p = naive_scan_string(p + 1, end)) {
+        unsigned char ch = static_cast<unsigned char>(*p);
+        // \" \\ \b \f \n \r \t take one more byte, other control characters \u00xx five
+        size += ch == '"' || ch == '\\' || ch == '\b' || ch == '\f' || ch == '\n' || ch == '\r' || ch == '\t' ? 1 : 5;
+    }
+    return size;
+}
+
+// the exact length of what naive_stringify writes, without the terminator
+size_t naive_stringify_size(const NaiveValue* value) {
+    assert(value != nullptr);
+    switch (value->type) {
+        case NAIVE_NULL:
+        case NAIVE_TRUE:
+            return 4;
+        case NAIVE_FALSE:
+            return 5;
+        case NAIVE_NUMBER: {
+            if (value->flags & NAIVE_VALUE_RAW)
+                return value->strlen;
+            char buffer[32];
+            return naive_write_number(buffer, value) - buffer;
+        }
+        case NAIVE_STRING:
+            return naive_stringify_string_size(naive_string_data(value), naive_string_size(value));
+        case NAIVE_ARRAY: {
+            size_t size = value->arrlen > 0 ? value->arrlen + 1 : 2; // brackets and commas
+            for (size_t i = 0; i < value->arrlen; ++i)
+                size += naive_stringify_size(&value->arr[i]);
+            return size;
+        }
+        case NAIVE_OBJECT: {
+            size_t size = value->maplen > 0 ? 2 * value->maplen + 1 : 2; // braces, colons and commas
+            for (size_t j = 0; j < value->maplen; ++j) {
+                size += naive_stringify_string_size(value->map[j].key, value->map[j].keylen);
+                size += naive_stringify_size(&value->map[j].value);
+            }
+            return size;
+        }
+        default:
+            throw std::runtime_error("invalid type");
+    }
+}
+
+// the naive_write_* functions write into [p, limit) and return the end, or nullptr once it is full
+static char* naive_write_bytes(char* p, const char* limit, const char* s, size_t len) {
+    if (static_cast<size_t>(limit - p) < len)
+        return nullptr;
+    memcpy(p, s, len);
+    return p + len;
+}
+
+static char* naive_write_string(char* p, const char* limit, const char* str, size_t len) {
+    const char* end = str + len;
+    if (p == limit)
+        return nullptr;
+    *p++ = '"';
+    while (str != end) {
+        const char* run = naive_scan_string(str, end);
+        if ((p = naive_write_bytes(p, limit, str, run - str)) == nullptr)
+            return nullptr;
+        for (str = run; str != end && naive_is_string_special(*str); str++) {
+            char escape[6];
+            if ((p = naive_write_bytes(p, limit, escape,
+                                       naive_escape_char(escape, static_cast<unsigned char>(*str)) - escape)) == nullptr)
+                return nullptr;
+        }
+    }
+    return naive_write_bytes(p, limit, "\"", 1);
+}
+
+static char* naive_write_value(char* p, const char* limit, const NaiveValue* value) {
+    switch (value->type) {
+        case NAIVE_NULL:
+            return naive_write_bytes(p, limit, "null", 4);
+        case NAIVE_TRUE:
+            return naive_write_bytes(p, limit, "true", 4);
+        case NAIVE_FALSE:
+            return naive_write_bytes(p, limit, "false", 5);
+        case NAIVE_NUMBER: {
+            if (value->flags & NAIVE_VALUE_RAW)
+                return naive_write_bytes(p, limit, value->str, value->strlen);
+            if (limit - p >= 32)
+                return naive_write_number(p, value);
+            char buffer[32];
+            return naive_write_bytes(p, limit, buffer, naive_write_number(buffer, value) - buffer);
+        }
+        case NAIVE_STRING:
+            return naive_write_string(p, limit, naive_string_data(value), naive_string_size(value));
+        case NAIVE_ARRAY:
+            if ((p = naive_write_bytes(p, limit, "[", 1)) == nullptr)
+                return nullptr;
+            for (size_t i = 0; i < value->arrlen; ++i) {
+                if (i > 0 && (p = naive_write_bytes(p, limit, ",", 1)) == nullptr)
+                    return nullptr;
+                if ((p = naive_write_value(p, limit, &value->arr[i])) == nullptr)
+                    return nullptr;
+            }
+            return naive_write_bytes(p, limit, "]", 1);
+        case NAIVE_OBJECT:
+            if ((p = naive_write_bytes(p, limit, "{", 1)) == nullptr)
+                return nullptr;
+            for (size_t j = 0; j < value->maplen; ++j) {
+                if (j > 0 && (p = naive_write_bytes(p, limit, ",", 1)) == nullptr)
+                    return nullptr;
+                if ((p = naive_write_string(p, limit, value->map[j].key, value->map[j].keylen)) == nullptr ||
+                    (p = naive_write_bytes(p, limit, ":", 1)) == nullptr ||
+                    (p = naive_write_value(p, limit, &value->map[j].value)) == nullptr)
+                    return nullptr;
+            }
+            return naive_write_bytes(p, limit, "}", 1);
+        default:
+            throw std::runtime_error("invalid type");
+    }
+}
+
+// writes into a buffer the caller owns in one pass, allocating nothing. Returns the length of the output,
+// which is not terminated; when that is more than `cap` the buffer holds a truncated prefix and the caller
+// can retry with one of the returned size
+size_t naive_stringify_into(const NaiveValue* value, char* buf, size_t cap) {
+    assert(value != nullptr && (buf != nullptr || cap == 0));
+    char* end = naive_write_value(buf, buf + cap, value);
+    return end != nullptr ? static_cast<size_t>(end - buf) : naive_stringify_size(value);
+}
+
+// the output goes to `sink` NAIVE_SINK_BUFFER_SIZE bytes or so at a time, so memory stays constant
+// whatever the size of the document; false when the sink stopped the stringify
+bool naive_stringify_sink(const NaiveValue* value, const NaiveSink* sink) {
+    NaiveContext context;
+    assert(value != nullptr && sink != nullptr && sink->write != nullptr);
+    naive_context_init(&context, nullptr, 0, nullptr, 0);
+    context.sink = sink;
+    // room for the largest push made below the spill threshold, so the buffer is never reallocated
+    context.size = NAIVE_SINK_BUFFER_SIZE + NAIVE_SINK_BUFFER_SIZE / 8 + 64;
+    context.stack = static_cast<char*>(malloc(context.size));
+    if (context.stack == nullptr)
+        throw std::bad_alloc();
+    bool ok = true;
+    try {
+        naive_stringify_value(&context, value);
+        naive_sink_flush(&context, nullptr, 0);
+    } catch (const NaiveSinkAborted&) {
+        ok = false;
+    } catch (...) {
+        free(context.stack);
+        throw;
+    }
+    free(context.stack);
+    return ok;
+}
+
+static bool naive_file_write(void* user, const NaiveSlice* slices, size_t count) {
+    FILE* fp = static_cast<FILE*>(user);
+    for (size_t i = 0; i < count; i++) {
+        if (fwrite(slices[i].data, 1, slices[i].len, fp) != slices[i].len)
+            return false;
+    }
+    return true;
+}
+
+bool naive_stringify_file(const NaiveValue* value, FILE* fp) {
+    assert(fp != nullptr);
+    NaiveSink sink = {fp, naive_file_write};
+    return naive_stringify_sink(value, &sink);
+}
+
+// both slices in one writev, resumed after short writes
+static bool naive_fd_write(void* user, const NaiveSlice* slices, size_t count) {
+    int fd = *static_cast<int*>(user);
+#if !defined(_WIN32)
+    struct iovec iov[2];
+    for (size_t i = 0; i < count; i++) {
+        iov[i].iov_base = const_cast<char*>(slices[i].data);
+        iov[i].iov_len = slices[i].len;
+    }
+    struct iovec* v = iov;
+    while (count > 0) {
+        ssize_t n = writev(fd, v, static_cast<int>(count));
+        if (n < 0) {
+            if (errno == EINTR)
+                continue;
+            return false;
+        }
+        size_t written = static_cast<size_t>(n);
+        while (count > 0 && written >= v->iov_len) {
+            written -= v->iov_len;
+            v++;
+            count--;
+        }
+        if (count > 0) {
+            v->iov_base = static_cast<char*>(v->iov_base) + written;
+            v->iov_len -= written;
+        }
+    }
+#else
+    for (size_t i = 0; i < count; i++) {
+        const char* p = slices[i].data;
+        size_t len = slices[i].len;
+        while (len > 0) {
+            int n = _write(fd, p, static_cast<unsigned>(len < 0x40000000 ? len : 0x40000000));
+            if (n < 0)
+                return false;
+            p += n;
+            len -= n;
+        }
+    }
+#endif
+    return true;
+}
+
+bool naive_stringify_fd(const NaiveValue* value, int fd) {
+    assert(fd >= 0);
+    NaiveSink sink = {&fd, naive_fd_write};
+    return naive_stringify_sink(value, &sink);
+}
+
 void naive_copy(NaiveValue* dst, const NaiveValue* src) {
     assert(dst != nullptr && src != nullptr && src != dst);
+    if (src->flags & NAIVE_VALUE_RAW) {
+        // copies are decoded, they must not depend on the source text
+        naive_free(dst);
+        naive_decode_raw(src, dst, naive_value_arena(dst));
+        return;
+    }
     switch (src->type) {
         case NAIVE_STRING:
-            naive_set_string(dst, src->str, src->strlen);
+            naive_set_string(dst, naive_string_data(src), naive_string_size(src));
             break;
         case NAIVE_ARRAY:
             naive_set_array(dst, src->arrlen);
             for (size_t i = 0; i < src->arrlen; ++i) {
+                naive_init_slot(&dst->arr[i]);
                 naive_copy(&dst->arr[i], &src->arr[i]);
             }
             dst->arrlen = src->arrlen;
             break;
-        case NAIVE_OBJECT:
-            naive_free(dst);
+        case NAIVE_OBJECT: {
             naive_set_object(dst, src->maplen);
+            NaiveArena* arena = naive_payload_arena(dst);
             for (size_t i = 0; i < src->maplen; ++i) {
-                dst->map[i].key = static_cast<char*>(malloc(src->map[i].keylen + 1));
-                memcpy(dst->map[i].key, src->map[i].key, src->map[i].keylen);
-                dst->map[i].key[src->map[i].keylen] = '\0';
+                dst->map[i].key = naive_alloc_string(arena, src->map[i].key, src->map[i].keylen);
                 dst->map[i].keylen = src->map[i].keylen;
-                naive_free(&dst->map[i].value);
+                naive_init_slot(&dst->map[i].value);
                 naive_copy(&dst->map[i].value, &src->map[i].value);
             }
             dst->maplen = src->maplen;
+            naive_build_object_index(dst);
             break;
+        }
         default:
             naive_free(dst);
-            memcpy(dst, src, sizeof(NaiveValue));
+            dst->u64 = src->u64;
+            dst->type = src->type;
+            dst->flags = src->flags;
             break;
     }
 }
 
+// true when `value` owns heap memory, which must never be handed to a slot inside an arena
+static inline bool naive_owns_heap(const NaiveValue* value) {
+    return !(value->flags & (NAIVE_VALUE_SHARED | NAIVE_VALUE_INLINE)) &&
+           (value->type == NAIVE_STRING || value->type == NAIVE_ARRAY || value->type == NAIVE_OBJECT);
+}
+
 void naive_move(NaiveValue* dst, NaiveValue* src) {
     assert(dst != nullptr && src != nullptr && src != dst);
     naive_free(dst);
-    memcpy(dst, src, sizeof(NaiveValue));
-    naive_init(src);
+    if (dst->chunk != 0 && naive_owns_heap(src)) {
+        naive_copy(dst, src);
+        naive_free(src);
+    } else {
+        unsigned char chunk = dst->chunk;
+        memcpy(dst, src, sizeof(NaiveValue));
+        dst->chunk = chunk;
+    }
+    naive_init_slot(src);
 }
 
 void naive_swap(NaiveValue* lhs, NaiveValue* rhs) {
     assert(lhs != nullptr && rhs != nullptr);
-    if (lhs != rhs) {
+    if (lhs == rhs)
+        return;
+    if ((lhs->chunk == 0 || !naive_owns_heap(rhs)) && (rhs->chunk == 0 || !naive_owns_heap(lhs))) {
         NaiveValue temp;
         memcpy(&temp, lhs, sizeof(NaiveValue));
         memcpy(lhs, rhs, sizeof(NaiveValue));
         memcpy(rhs, &temp, sizeof(NaiveValue));
+        rhs->chunk = lhs->chunk;
+        lhs->chunk = temp.chunk;
+    } else {
+        NaiveValue temp;
+        naive_init(&temp);
+        naive_move(&temp, lhs);
+        naive_move(lhs, rhs);
+        naive_move(rhs, &temp);
     }
 }
 
+// integers compare exactly, also against doubles, which only equal the integer they hold
+static bool naive_is_equal_number(const NaiveValue* lhs, const NaiveValue* rhs) {
+    const unsigned integer = NAIVE_VALUE_INT64 | NAIVE_VALUE_UINT64;
+    const unsigned l = lhs->flags & integer, r = rhs->flags & integer;
+    if (l == r)
+        return l ? lhs->u64 == rhs->u64 : lhs->number == rhs->number;
+    if (l && r)
+        return false;
+    if (l)
+        std::swap(lhs, rhs);
+    const double number = lhs->number;
+    if (number != std::floor(number))
+        return false;
+    if (rhs->flags & NAIVE_VALUE_INT64)
+        return number >= -9223372036854775808.0 && number < 9223372036854775808.0 &&
+               static_cast<int64_t>(number) == rhs->i64;
+    return number >= 9223372036854775808.0 && number < 18446744073709551616.0 &&
+           static_cast<uint64_t>(number) == rhs->u64;
+}
+
 bool naive_is_equal(const NaiveValue* lhs, const NaiveValue* rhs) {
     assert(lhs != nullptr && rhs != nullptr);
     if (lhs->type != rhs->type) return false;
+    if (lhs->type == NAIVE_NUMBER && ((lhs->flags | rhs->flags) & NAIVE_VALUE_RAW)) {
+        // the same source text is the same value, anything else is compared decoded; raw strings compare
+        // like any other
+        if ((lhs->flags & rhs->flags & NAIVE_VALUE_RAW) && lhs->strlen == rhs->strlen &&
+            memcmp(lhs->str, rhs->str, lhs->strlen) == 0)
+            return true;
+        NaiveValue l, r;
+        if (lhs->flags & NAIVE_VALUE_RAW)
+            naive_decode_raw(lhs, &l, nullptr);
+        if (rhs->flags & NAIVE_VALUE_RAW)
+            naive_decode_raw(rhs, &r, nullptr);
+        bool equal = naive_is_equal((lhs->flags & NAIVE_VALUE_RAW) ? &l : lhs,
+                                    (rhs->flags & NAIVE_VALUE_RAW) ? &r : rhs);
+        if (lhs->flags & NAIVE_VALUE_RAW)
+            naive_free(&l);
+        if (rhs->flags & NAIVE_VALUE_RAW)
+            naive_free(&r);
+        return equal;
+    }
     switch (lhs->type) {
         case NAIVE_STRING:
-            return lhs->strlen == rhs->strlen && memcmp(lhs->str, rhs->str, lhs->strlen) == 0;
+            return naive_string_size(lhs) == naive_string_size(rhs) &&
+                   (naive_string_data(lhs) == naive_string_data(rhs) ||
+                    memcmp(naive_string_data(lhs), naive_string_data(rhs), naive_string_size(lhs)) == 0);
         case NAIVE_NUMBER:
-            return lhs->number == rhs->number;
+            return naive_is_equal_number(lhs, rhs);
         case NAIVE_ARRAY:
             if (lhs->arrlen != rhs->arrlen) return false;
             for (size_t i = 0; i < lhs->arrlen; i++) {
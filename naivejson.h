@@ -6,6 +6,7 @@
 #define NAIVEJSON_H
 
 #include <cstddef> // size_t
+#include <cstdint>
 #include <cassert>
 #include <cstdlib>
 #include <cerrno>
@@ -17,6 +18,9 @@
 const int NAIVE_STACK_INIT_SIZE = 256;
 const int NAIVE_PARSE_STRINGIFY_INI_SIZE = 256;
 const size_t NAIVE_KEY_NOT_EXIST = static_cast<size_t>(-1);
+const size_t NAIVE_ARENA_CHUNK_SIZE = 64 * 1024;
+const size_t NAIVE_SINK_BUFFER_SIZE = 16 * 1024;
+const size_t NAIVE_PARSE_MAX_DEPTH = 1024; // how deep a parse lets containers nest unless told otherwise
 
 enum NaiveType {
     NAIVE_NULL = 0, //! null
@@ -42,31 +46,77 @@ enum {
     NAIVE_PARSE_MISS_COMMA_OR_SQUARE_BRACKET,
     NAIVE_PARSE_MISS_KEY,
     NAIVE_PARSE_MISS_COLON,
-    NAIVE_PARSE_MISS_COMMA_OR_CURLY_BRACKET
+    NAIVE_PARSE_MISS_COMMA_OR_CURLY_BRACKET,
+    NAIVE_PARSE_IO_ERROR,
+    NAIVE_PARSE_HANDLER_ABORTED,
+    NAIVE_PARSE_TOO_DEEP,
+    NAIVE_PARSE_INVALID_ARGUMENT
+};
+
+// NaiveValue::flags
+enum {
+    NAIVE_VALUE_SHARED = 0x01, // payload belongs to an arena, naive_free leaves it alone
+    NAIVE_VALUE_INDEXED = 0x02, // the block of a large object carries a key index behind its members
+    NAIVE_VALUE_BORROWED = 0x04, // the keys of an object point into an in-situ parsed buffer
+    NAIVE_VALUE_INLINE = 0x08,   // a short string kept in the value itself, see NaiveValue::inlen
+    NAIVE_VALUE_INT64 = 0x10,    // a number held exactly in NaiveValue::i64
+    NAIVE_VALUE_UINT64 = 0x20,   // a number above INT64_MAX held exactly in NaiveValue::u64
+    NAIVE_VALUE_RAW = 0x40       // a string without escapes or a number still in its source text
+};
+
+// NaiveContext::flags and naive_parse_file flags
+enum {
+    NAIVE_PARSE_INSITU = 0x01,       // unescape strings and keys in place, values point into the input
+    NAIVE_PARSE_KEEP_MAPPING = 0x02, // naive_parse_file: keep the file mapped for the arena's lifetime
+    NAIVE_PARSE_RAW = 0x04           // strings and numbers point at their source text, see naive_parse_raw
 };
 
 struct NaiveValue;
 struct NaiveMember;
 struct NaiveContext;
+struct NaiveArenaChunk;
+struct NaiveArenaMapping;
+
+// bump allocator for whole documents, everything carved from it is released at once by naive_arena_reset
+struct NaiveArena {
+    NaiveArenaChunk* chunks; // newest first, the head is the one being carved
+    NaiveArenaMapping* mappings;
+    char* cursor;
+    char* limit;
+    size_t chunk_size;       // power of two
+};
+
+struct NaiveInternSlot;
+
+// keys, and string values of up to `max_string` bytes, parsed with a pool are stored in it once and shared
+// by every document parsed with it; the pool has to outlive them and serves one parse at a time
+struct NaiveInternPool {
+    NaiveArena arena; // the pooled bytes
+    NaiveInternSlot* slots;
+    size_t count, mask;
+    size_t max_string;           // 0 to pool keys only
+    const NaiveInternPool* base; // looked up first and never written, nullptr for none
+};
 
+// 16 bytes: a payload word, a 32-bit length and four tag bytes
 struct NaiveValue {
     union {
         double number;
-        struct {
-            char* str;
-            size_t strlen;
-        };
-        struct {
-            NaiveValue* arr;
-            size_t arrlen, arrcap; // element count
-        };
-        struct {
-            NaiveMember* map;
-            size_t maplen, mapcap;
-        };
-
+        int64_t i64;      // integer literals that fit 64 bits, see NAIVE_VALUE_INT64 and NAIVE_VALUE_UINT64
+        uint64_t u64;
+        char* str;        // NAIVE_VALUE_RAW: the source text, for a string the part between the quotes
+        NaiveValue* arr;  // arrays and objects keep their capacity in front of the block
+        NaiveMember* map;
     };
-    NaiveType type;
+    union {
+        uint32_t strlen;
+        uint32_t arrlen; // element count
+        uint32_t maplen;
+    };
+    unsigned char type;  // NaiveType
+    unsigned char flags;
+    unsigned char chunk = 0; // log2 size of the arena chunk this value lives in, 0 outside any arena
+    unsigned char inlen; // NAIVE_VALUE_INLINE: the string length, its bytes and a '\0' fill the value up to `type`
 };
 
 struct NaiveMember {
@@ -77,8 +127,83 @@ struct NaiveMember {
 
 struct NaiveContext {
     const char* json;
+    const char* end;
     char* stack;
     size_t size, top;
+    NaiveArena* arena; // where parsed payloads go, nullptr for the heap
+    unsigned flags;
+    const struct NaiveSink* sink;    // naive_stringify_sink: where the stack goes once it fills, nullptr otherwise
+    NaiveInternPool* intern;         // where keys and short strings go, nullptr to copy each one
+    char* frames;                    // the containers open in the parse, innermost last
+    size_t depth, frames_size;
+    size_t max_depth;                // opening a container at this depth fails with NAIVE_PARSE_TOO_DEEP
+};
+
+struct NaiveSlice {
+    const char* data;
+    size_t len;
+};
+
+// naive_stringify_sink output: `count` slices to be written in order, returning false stops the stringify
+struct NaiveSink {
+    void* user;
+    bool (*write)(void* user, const NaiveSlice* slices, size_t count);
+};
+
+// naive_parse_sax events, callbacks left null are skipped and returning false stops the parse with
+// NAIVE_PARSE_HANDLER_ABORTED. Strings and keys come decoded but unterminated and only live for the call.
+struct NaiveHandler {
+    void* user;
+    bool (*on_null)(void* user);
+    bool (*on_boolean)(void* user, bool flag);
+    bool (*on_number)(void* user, double number);
+    bool (*on_string)(void* user, const char* str, size_t len);
+    bool (*on_start_object)(void* user);
+    bool (*on_key)(void* user, const char* key, size_t keylen);
+    bool (*on_end_object)(void* user, size_t count);
+    bool (*on_start_array)(void* user);
+    bool (*on_end_array)(void* user, size_t count);
+    bool (*on_int64)(void* user, int64_t number);   // integers that fit, on_number gets them when left null
+    bool (*on_uint64)(void* user, uint64_t number); // integers above INT64_MAX
+};
+
+// incremental parser, chunks go in with naive_stream_feed and naive_stream_finish ends the input
+struct NaiveStream {
+    NaiveContext context;        // children of the open containers wait on its stack, the containers are its frames
+    NaiveValue* value;           // the document, nullptr when the events go to `handler`
+    const NaiveHandler* handler;
+    char* token;                 // a token split across chunks, collected until it is complete
+    size_t tokenlen, tokencap;
+    unsigned char state, pending, escaped;
+    int error;                   // the first error, every later call returns it
+};
+
+// one line of an NDJSON buffer, see naive_parse_ndjson
+struct NaiveRecord {
+    NaiveValue value;
+    size_t offset, len; // the line within the buffer, without its '\n'
+    int error;          // what naive_parse_n returned for the line
+};
+
+// a value of a document checked by naive_lazy_parse, nothing of it is decoded until asked for
+struct NaiveLazyValue {
+    const char* json; // where the value starts
+    const char* end;  // the end of the document
+};
+
+// one reference token of a compiled JSON Pointer
+struct NaivePointerToken {
+    const char* key;  // unescaped, "~0" and "~1" are gone
+    size_t keylen;
+    size_t index;     // the token as an array index, NAIVE_KEY_NOT_EXIST when it is none
+    uint32_t hash;    // of the key, for objects with an index
+};
+
+// an RFC 6901 JSON Pointer compiled by naive_pointer_compile
+struct NaivePointer {
+    NaivePointerToken* tokens;
+    size_t count;
+    char* buffer; // the unescaped keys
 };
 
 inline void EXPECT(NaiveContext* context, char ch) {
@@ -86,6 +211,11 @@ inline void EXPECT(NaiveContext* context, char ch) {
     context->json++;
 }
 
+// the current character, with a virtual '\0' at the end of the input
+inline char naive_peek(const NaiveContext* context) {
+    return context->json != context->end ? *context->json : '\0';
+}
+
 inline bool ISDIGIT(char ch) {
     return ((ch) >= '0' && (ch) <= '9');
 }
@@ -94,10 +224,30 @@ inline bool ISDIGIT1TO9(char ch) {
     return ((ch) >= '1' && (ch) <= '9');
 }
 
+inline bool ISWHITESPACE(char ch) {
+    return ch == ' ' || ch == '\t' || ch == '\n' || ch == '\r';
+}
+
+// a fresh value outside any arena; naive_set_null empties a slot of an arena document and keeps it there
 inline void naive_init(NaiveValue* value) {
     value->type = NAIVE_NULL;
+    value->flags = 0;
+    value->chunk = 0;
 }
 
+// arena interface
+void naive_arena_init(NaiveArena* arena, size_t chunk_size = NAIVE_ARENA_CHUNK_SIZE);
+
+void* naive_arena_alloc(NaiveArena* arena, size_t size);
+
+void naive_arena_reset(NaiveArena* arena);
+
+void naive_arena_destroy(NaiveArena* arena);
+
+void naive_intern_init(NaiveInternPool* pool, size_t max_string = 0);
+
+void naive_intern_destroy(NaiveInternPool* pool);
+
 void* naive_context_push(NaiveContext* context, size_t size);
 
 void* naive_context_pop(NaiveContext* context, size_t size);
@@ -108,7 +258,7 @@ inline void PUTC(NaiveContext* c, char ch) {
     *static_cast<char*>(naive_context_push(c, sizeof(char))) = ch;
 }
 
-inline void PUTS(NaiveContext* context, char* s, size_t len) {
+inline void PUTS(NaiveContext* context, const char* s, size_t len) {
     memcpy(naive_context_push(context, len), s, len);
 }
 
@@ -135,9 +285,87 @@ int naive_parse_value(NaiveContext* context, NaiveValue* value);
 
 int naive_parse(NaiveValue* value, const char* json);
 
+int naive_parse(NaiveValue* value, const char* json, NaiveArena* arena);
+
+int naive_parse_n(NaiveValue* value, const char* json, size_t len);
+
+int naive_parse_n(NaiveValue* value, const char* json, size_t len, NaiveArena* arena);
+
+int naive_parse_n(NaiveValue* value, const char* json, size_t len, NaiveArena* arena, NaiveInternPool* pool,
+                  size_t max_depth = NAIVE_PARSE_MAX_DEPTH);
+
+int naive_parse_insitu(NaiveValue* value, char* json, size_t len);
+
+int naive_parse_insitu(NaiveValue* value, char* json, size_t len, NaiveArena* arena);
+
+int naive_parse_raw(NaiveValue* value, const char* json, size_t len);
+
+int naive_parse_raw(NaiveValue* value, const char* json, size_t len, NaiveArena* arena);
+
+int naive_parse_file(const char* path, NaiveValue* value, unsigned flags);
+
+int naive_parse_file(const char* path, NaiveValue* value, unsigned flags, NaiveArena* arena);
+
+int naive_parse_indexed(NaiveValue* value, const char* json, size_t len, unsigned threads);
+
+int naive_parse_indexed(NaiveValue* value, const char* json, size_t len, unsigned threads, NaiveArena* arena);
+
+int naive_parse_sax(const NaiveHandler* handler, const char* json, size_t len,
+                    size_t max_depth = NAIVE_PARSE_MAX_DEPTH);
+
+void naive_stream_init(NaiveStream* stream, NaiveValue* value);
+
+void naive_stream_init(NaiveStream* stream, NaiveValue* value, NaiveArena* arena,
+                       size_t max_depth = NAIVE_PARSE_MAX_DEPTH);
+
+void naive_stream_init(NaiveStream* stream, const NaiveHandler* handler, size_t max_depth = NAIVE_PARSE_MAX_DEPTH);
+
+int naive_stream_feed(NaiveStream* stream, const char* chunk, size_t len);
+
+int naive_stream_finish(NaiveStream* stream);
+
+void naive_stream_destroy(NaiveStream* stream);
+
+size_t naive_parse_ndjson(const char* json, size_t len, NaiveRecord** records, unsigned threads);
+
+size_t naive_parse_ndjson(const char* json, size_t len, NaiveRecord** records, unsigned threads,
+                          NaiveInternPool* pool);
+
+size_t naive_parse_ndjson(const char* json, size_t len, NaiveRecord** records, unsigned threads,
+                          NaiveInternPool* pool, NaiveArena* arena);
+
+void naive_free_records(NaiveRecord* records, size_t count);
+
+// lazy document interface
+int naive_lazy_parse(NaiveLazyValue* root, const char* json, size_t len);
+
+NaiveType naive_lazy_get_type(const NaiveLazyValue* value);
+
+bool naive_lazy_get_boolean(const NaiveLazyValue* value);
+
+double naive_lazy_get_number(const NaiveLazyValue* value);
+
+size_t naive_lazy_get_array_size(const NaiveLazyValue* value);
+
+bool naive_lazy_get_array_element(const NaiveLazyValue* value, size_t index, NaiveLazyValue* element);
+
+bool naive_lazy_array_next(const NaiveLazyValue* value, NaiveLazyValue* element);
+
+size_t naive_lazy_get_object_size(const NaiveLazyValue* value);
+
+bool naive_lazy_get_object_value(const NaiveLazyValue* value, const char* key, size_t keylen, NaiveLazyValue* member);
+
+bool naive_lazy_object_next(const NaiveLazyValue* value, NaiveLazyValue* key, NaiveLazyValue* member);
+
+int naive_lazy_materialize(const NaiveLazyValue* value, NaiveValue* out);
+
+int naive_lazy_materialize(const NaiveLazyValue* value, NaiveValue* out, NaiveArena* arena);
+
 // access interface
 NaiveType naive_get_type(const NaiveValue* value);
 
+void naive_materialize(NaiveValue* value);
+
 void naive_set_null(NaiveValue* value);
 
 bool naive_get_boolean(const NaiveValue* value);
@@ -148,6 +376,18 @@ double naive_get_number(const NaiveValue* value);
 
 void naive_set_number(NaiveValue* value, double number);
 
+bool naive_is_int64(const NaiveValue* value);
+
+bool naive_is_uint64(const NaiveValue* value);
+
+int64_t naive_get_int64(const NaiveValue* value);
+
+void naive_set_int64(NaiveValue* value, int64_t number);
+
+uint64_t naive_get_uint64(const NaiveValue* value);
+
+void naive_set_uint64(NaiveValue* value, uint64_t number);
+
 const char* naive_get_string(const NaiveValue* value);
 
 size_t naive_get_string_length(const NaiveValue* value);
@@ -190,6 +430,15 @@ NaiveValue* naive_get_object_value(const NaiveValue* value, const char* key, siz
 
 size_t naive_get_object_key_index(const NaiveValue* value, const char* key, size_t keylen);
 
+// JSON Pointer interface
+bool naive_pointer_compile(NaivePointer* pointer, const char* text, size_t len);
+
+void naive_pointer_free(NaivePointer* pointer);
+
+NaiveValue* naive_pointer_get(const NaivePointer* pointer, const NaiveValue* root);
+
+bool naive_pointer_get(const NaivePointer* pointer, const NaiveLazyValue* root, NaiveLazyValue* out);
+
 // TODO object interface
 void naive_set_object(NaiveValue* value, size_t capacity);
 
@@ -208,6 +457,16 @@ static void naive_stringify_value(NaiveContext* context, const NaiveValue* value
 
 char* naive_stringify(const NaiveValue* value, size_t* len);
 
+size_t naive_stringify_size(const NaiveValue* value);
+
+size_t naive_stringify_into(const NaiveValue* value, char* buf, size_t cap);
+
+bool naive_stringify_sink(const NaiveValue* value, const NaiveSink* sink);
+
+bool naive_stringify_file(const NaiveValue* value, FILE* fp);
+
+bool naive_stringify_fd(const NaiveValue* value, int fd);
+
 // copy control and resource management
 void naive_copy(NaiveValue* dst, const NaiveValue* src);
 
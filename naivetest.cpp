@@ -36,6 +36,11 @@ static int test_pass = 0;
 #define EXPECT_TRUE(actual) EXPECT_EQ_BASE((actual) != 0, "true", "false", "%s")
 #define EXPECT_FALSE(actual) EXPECT_EQ_BASE((actual) == 0, "false", "true", "%s")
 #define EXPECT_EQ_DOUBLE(expect, actual) EXPECT_EQ_BASE((expect) == (actual), expect, actual, "%.17g")
+#define EXPECT_EQ_INT64(expect, actual)\
+    EXPECT_EQ_BASE((expect) == (actual), static_cast<long long>(expect), static_cast<long long>(actual), "%lld")
+#define EXPECT_EQ_UINT64(expect, actual)\
+    EXPECT_EQ_BASE((expect) == (actual), static_cast<unsigned long long>(expect),\
+                   static_cast<unsigned long long>(actual), "%llu")
 #define EXPECT_EQ_SIZE_T(expect, actual)\
     EXPECT_EQ_BASE((expect) == (actual), static_cast<size_t>(expect), static_cast<size_t>(actual), "%zu")
 #define EXPECT_EQ_STRING(expect, actual, alength)\
@@ -49,6 +54,8 @@ static int test_pass = 0;
         EXPECT_EQ_INT(NAIVE_NUMBER, naive_get_type(&v));\
         EXPECT_EQ_DOUBLE(expect, naive_get_number(&v));\
         naive_free(&v);\
+        check_indexed(json);\
+        check_raw(json, NULL);\
     } while(0)
 
 #define TEST_STRING(expect, json)\
@@ -59,6 +66,8 @@ static int test_pass = 0;
         EXPECT_EQ_INT(NAIVE_STRING, naive_get_type(&v));\
         EXPECT_EQ_STRING(expect, naive_get_string(&v), naive_get_string_length(&v));\
         naive_free(&v);\
+        check_indexed(json);\
+        check_raw(json, NULL);\
     } while(0)
 
 #define TEST_ERROR(error, json)\
@@ -68,6 +77,8 @@ static int test_pass = 0;
         EXPECT_EQ_INT(error, naive_parse(&v, json));\
         EXPECT_EQ_INT(NAIVE_NULL, naive_get_type(&v));\
         naive_free(&v);\
+        check_indexed(json);\
+        check_raw(json, NULL);\
     } while(0)
 
 #define TEST_ROUNDTRIP(json)\
@@ -79,10 +90,55 @@ static int test_pass = 0;
         EXPECT_EQ_INT(NAIVE_PARSE_OK, naive_parse(&v, json));\
         json2 = naive_stringify(&v, &length);\
         EXPECT_EQ_STRING(json, json2, length);\
+        check_stringify_into(&v, json2, length);\
         naive_free(&v);\
         free(json2);\
+        check_indexed(json);\
+        check_raw(json, json);\
     } while(0)
 
+/* exactly what naive_stringify wrote, into a buffer of that size and no smaller */
+static void check_stringify_into(const NaiveValue* v, const char* expect, size_t length) {
+    std::string buf(length + 1, '#');
+    EXPECT_EQ_SIZE_T(length, naive_stringify_size(v));
+    EXPECT_EQ_SIZE_T(length, naive_stringify_into(v, &buf[0], length));
+    EXPECT_TRUE(memcmp(buf.data(), expect, length) == 0 && buf[length] == '#');
+    if (length > 0) {
+        buf.assign(length + 1, '#');
+        EXPECT_EQ_SIZE_T(length, naive_stringify_into(v, &buf[0], length - 1));
+        EXPECT_TRUE(buf[length - 1] == '#');
+    }
+}
+
+/* the two-stage engine gives the same result and tree as naive_parse */
+static void check_indexed(const char* json) {
+    NaiveValue v, e;
+    naive_init(&e);
+    int expect = naive_parse(&e, json);
+    EXPECT_EQ_INT(expect, naive_parse_indexed(&v, json, strlen(json), 1));
+    EXPECT_TRUE(naive_is_equal(&v, &e));
+    naive_free(&v);
+    naive_free(&e);
+}
+
+/* naive_parse_raw accepts and rejects the same documents; untouched, an accepted one stringifies as
+   `expect` unless that is NULL, and decoded it equals the naive_parse tree */
+static void check_raw(const char* json, const char* expect) {
+    NaiveValue v, e;
+    naive_init(&e);
+    int ret = naive_parse(&e, json);
+    EXPECT_EQ_INT(ret, naive_parse_raw(&v, json, strlen(json)));
+    if (ret == NAIVE_PARSE_OK && expect != NULL) {
+        size_t length;
+        char* out = naive_stringify(&v, &length);
+        EXPECT_TRUE(length == strlen(expect) && memcmp(out, expect, length) == 0);
+        check_stringify_into(&v, out, length);
+        free(out);
+    }
+    EXPECT_TRUE(naive_is_equal(&v, &e));
+    naive_free(&v);
+    naive_free(&e);
+}
 
 static void test_parse_null() {
     NaiveValue v;
@@ -142,6 +198,71 @@ static void test_parse_number() {
     TEST_NUMBER(-2.2250738585072014e-308, "-2.2250738585072014e-308");
     TEST_NUMBER(1.7976931348623157e+308, "1.7976931348623157e+308");  /* Max double */
     TEST_NUMBER(-1.7976931348623157e+308, "-1.7976931348623157e+308");
+
+    TEST_NUMBER(1e-7, "1e-07");     /* leading zeros in the exponent */
+    TEST_NUMBER(1.5e6, "1.5E+006");
+    TEST_NUMBER(9007199254740992.0, "9007199254740993");  /* 2^53 + 1 rounds to even */
+    TEST_NUMBER(18446744073709551616.0, "18446744073709551615");  /* more than 19 significant digits */
+    TEST_NUMBER(1e23, "1e23");
+    TEST_NUMBER(1e23, "100000000000000000000000");
+    TEST_NUMBER(0.1, "0.1000000000000000000000000000000000000000001");
+    TEST_NUMBER(1.0, "1.00000000000000011102230246251565404236316680908203125");  /* halfway, rounds to even */
+    TEST_NUMBER(1.0000000000000002, "1.00000000000000011102230246251565404236316680908203126");
+    TEST_NUMBER(4.9406564584124654e-324, "2.4703282292062328e-324");  /* just above half the minimum denormal */
+    TEST_NUMBER(0.0, "2.4703282292062327e-324");
+}
+
+#define TEST_INTEGER(expect, json)\
+    do {\
+        NaiveValue v;\
+        naive_init(&v);\
+        EXPECT_EQ_INT(NAIVE_PARSE_OK, naive_parse(&v, json));\
+        EXPECT_EQ_INT(NAIVE_NUMBER, naive_get_type(&v));\
+        EXPECT_TRUE(naive_is_int64(&v));\
+        EXPECT_EQ_INT64(expect, naive_get_int64(&v));\
+        EXPECT_EQ_DOUBLE(static_cast<double>(expect), naive_get_number(&v));\
+        naive_free(&v);\
+        check_indexed(json);\
+        check_raw(json, NULL);\
+    } while(0)
+
+static void test_parse_integer() {
+    TEST_INTEGER(0, "0");
+    TEST_INTEGER(1, "1");
+    TEST_INTEGER(-1, "-1");
+    TEST_INTEGER(1234567890, "1234567890");
+    TEST_INTEGER(INT64_C(9007199254740993), "9007199254740993");  /* 2^53 + 1, no longer rounded */
+    TEST_INTEGER(INT64_C(1000000000000000000), "1000000000000000000");
+    TEST_INTEGER(INT64_MAX, "9223372036854775807");
+    TEST_INTEGER(INT64_MIN, "-9223372036854775808");
+
+    NaiveValue v;
+    naive_init(&v);
+    /* above INT64_MAX only uint64 holds them */
+    EXPECT_EQ_INT(NAIVE_PARSE_OK, naive_parse(&v, "9223372036854775808"));
+    EXPECT_FALSE(naive_is_int64(&v));
+    EXPECT_TRUE(naive_is_uint64(&v));
+    EXPECT_EQ_UINT64(UINT64_C(9223372036854775808), naive_get_uint64(&v));
+    EXPECT_EQ_INT(NAIVE_PARSE_OK, naive_parse(&v, "18446744073709551615"));
+    EXPECT_EQ_UINT64(UINT64_MAX, naive_get_uint64(&v));
+    EXPECT_EQ_INT(NAIVE_PARSE_OK, naive_parse(&v, "[12345678901234567890]"));
+    EXPECT_EQ_UINT64(UINT64_C(12345678901234567890), naive_get_uint64(naive_get_array_element(&v, 0)));
+    naive_free(&v);
+    EXPECT_EQ_INT(NAIVE_PARSE_OK, naive_parse(&v, "42"));
+    EXPECT_TRUE(naive_is_uint64(&v));
+    EXPECT_EQ_UINT64(42, naive_get_uint64(&v));
+
+    /* out of range, fractions, exponents and -0 stay doubles */
+    static const char* doubles[] = {
+            "18446744073709551616", "99999999999999999999", "-9223372036854775809", "-0", "1.0", "1e2", "-1E0"
+    };
+    for (size_t i = 0; i < sizeof(doubles) / sizeof(doubles[0]); i++) {
+        EXPECT_EQ_INT(NAIVE_PARSE_OK, naive_parse(&v, doubles[i]));
+        EXPECT_EQ_INT(NAIVE_NUMBER, naive_get_type(&v));
+        EXPECT_FALSE(naive_is_int64(&v));
+        EXPECT_FALSE(naive_is_uint64(&v));
+    }
+    naive_free(&v);
 }
 
 static void test_parse_string() {
@@ -154,6 +275,14 @@ static void test_parse_string() {
     TEST_STRING("\xE2\x82\xAC", "\"\\u20AC\""); /* Euro sign U+20AC */
     TEST_STRING("\xF0\x9D\x84\x9E", "\"\\uD834\\uDD1E\"");  /* G clef sign U+1D11E */
     TEST_STRING("\xF0\x9D\x84\x9E", "\"\\ud834\\udd1e\"");  /* G clef sign U+1D11E */
+
+    /* runs longer than one vector, with escapes on both sides of a block boundary */
+    TEST_STRING("0123456789abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ",
+                "\"0123456789abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ\"");
+    TEST_STRING("0123456789abcde\n0123456789abcdef\"0123456789abcdefghijklmnopqrstuvwxyz\\",
+                "\"0123456789abcde\\n0123456789abcdef\\\"0123456789abcdefghijklmnopqrstuvwxyz\\\\\"");
+    TEST_STRING("\xE4\xBD\xA0\xE5\xA5\xBD\xE4\xBD\xA0\xE5\xA5\xBD\xE4\xBD\xA0\xE5\xA5\xBD\xE4\xBD\xA0\xE5\xA5\xBD",
+                "\"\xE4\xBD\xA0\xE5\xA5\xBD\xE4\xBD\xA0\xE5\xA5\xBD\xE4\xBD\xA0\xE5\xA5\xBD\xE4\xBD\xA0\xE5\xA5\xBD\"");
 }
 
 static void test_parse_array() {
@@ -276,6 +405,8 @@ static void test_parse_invalid_value() {
     TEST_ERROR(NAIVE_PARSE_INVALID_VALUE, "+1");
     TEST_ERROR(NAIVE_PARSE_INVALID_VALUE, ".123"); /* at least one digit before '.' */
     TEST_ERROR(NAIVE_PARSE_INVALID_VALUE, "1.");   /* at least one digit after '.' */
+    TEST_ERROR(NAIVE_PARSE_INVALID_VALUE, "1e");   /* at least one digit in the exponent */
+    TEST_ERROR(NAIVE_PARSE_INVALID_VALUE, "1e+");
     TEST_ERROR(NAIVE_PARSE_INVALID_VALUE, "INF");
     TEST_ERROR(NAIVE_PARSE_INVALID_VALUE, "inf");
     TEST_ERROR(NAIVE_PARSE_INVALID_VALUE, "NAN");
@@ -290,6 +421,8 @@ static void test_parse_invalid_value() {
 static void test_parse_number_too_big() {
     TEST_ERROR(NAIVE_PARSE_NUMBER_TOO_BIG, "1e309");
     TEST_ERROR(NAIVE_PARSE_NUMBER_TOO_BIG, "-1e309");
+    TEST_ERROR(NAIVE_PARSE_NUMBER_TOO_BIG, "1.7976931348623159e308");
+    TEST_ERROR(NAIVE_PARSE_NUMBER_TOO_BIG, "1e100000000000");
 }
 
 static void test_parse_root_not_singular() {
@@ -305,6 +438,7 @@ static void test_parse_root_not_singular() {
 static void test_parse_missing_quotation_mark() {
     TEST_ERROR(NAIVE_PARSE_MISS_QUOTATION_MARK, "\"");
     TEST_ERROR(NAIVE_PARSE_MISS_QUOTATION_MARK, "\"abc");
+    TEST_ERROR(NAIVE_PARSE_MISS_QUOTATION_MARK, "\"0123456789abcdefghijklmnopqrstuvwxyz");
 }
 
 static void test_parse_invalid_string_escape() {
@@ -318,6 +452,7 @@ static void test_parse_invalid_string_char() {
 #if 1
     TEST_ERROR(NAIVE_PARSE_INVALID_STRING_CHAR, "\"\x01\"");
     TEST_ERROR(NAIVE_PARSE_INVALID_STRING_CHAR, "\"\x1F\"");
+    TEST_ERROR(NAIVE_PARSE_INVALID_STRING_CHAR, "\"0123456789abcdefghijklmnopqrstuvwxyz\x01\"");
 #endif
 }
 
@@ -403,7 +538,38 @@ static void test_access_number() {
     EXPECT_EQ_DOUBLE(1.0, naive_get_number(&v));
     naive_set_number(&v, -1.3e2);
     EXPECT_EQ_DOUBLE(-1.3e2, naive_get_number(&v));
+    EXPECT_FALSE(naive_is_int64(&v));
+
+    NaiveValue w, c;
+    naive_init(&w);
+    naive_init(&c);
+    naive_set_int64(&v, INT64_MIN);
+    EXPECT_EQ_INT64(INT64_MIN, naive_get_int64(&v));
+    EXPECT_FALSE(naive_is_uint64(&v));
+    naive_set_uint64(&v, UINT64_MAX);
+    EXPECT_EQ_UINT64(UINT64_MAX, naive_get_uint64(&v));
+    naive_copy(&c, &v);
+    EXPECT_EQ_UINT64(UINT64_MAX, naive_get_uint64(&c));
+    naive_set_uint64(&v, 7);
+    EXPECT_TRUE(naive_is_int64(&v));
+
+    /* integers and doubles are equal only when the double holds that exact integer */
+    naive_set_number(&w, 7.0);
+    EXPECT_TRUE(naive_is_equal(&v, &w));
+    EXPECT_TRUE(naive_is_equal(&w, &v));
+    naive_set_number(&w, 7.5);
+    EXPECT_FALSE(naive_is_equal(&v, &w));
+    naive_set_int64(&v, INT64_C(9007199254740993));
+    naive_set_number(&w, 9007199254740992.0);
+    EXPECT_FALSE(naive_is_equal(&v, &w));
+    naive_set_number(&w, 18446744073709551616.0);
+    EXPECT_FALSE(naive_is_equal(&c, &w));
+    naive_set_int64(&v, -1);
+    naive_set_uint64(&w, UINT64_MAX);
+    EXPECT_FALSE(naive_is_equal(&v, &w));
     naive_free(&v);
+    naive_free(&w);
+    naive_free(&c);
 }
 
 static void test_access_string() {
@@ -414,6 +580,38 @@ static void test_access_string() {
     naive_set_string(&v, "Hello", 5);
     EXPECT_EQ_STRING("Hello", naive_get_string(&v), naive_get_string_length(&v));
     naive_free(&v);
+
+    /* short strings live inside the value, longer ones on the heap; both look the same */
+    const char* text = "0123456789abcdefghijklmnopqrstuvwxyz";
+    for (size_t len = 0; len < 36; len++) {
+        NaiveValue c, m, a;
+        naive_init(&v);
+        naive_set_string(&v, text, len);
+        const char* s = naive_get_string(&v);
+        bool inside = s >= reinterpret_cast<const char*>(&v) && s < reinterpret_cast<const char*>(&v + 1);
+        EXPECT_TRUE(inside == (len < offsetof(NaiveValue, type)));
+        EXPECT_TRUE(naive_get_string_length(&v) == len && memcmp(s, text, len) == 0 && s[len] == '\0');
+
+        naive_init(&c);
+        naive_copy(&c, &v);
+        EXPECT_TRUE(naive_is_equal(&c, &v));
+        naive_init(&m);
+        naive_move(&m, &c);
+        EXPECT_TRUE(naive_get_string_length(&m) == len && memcmp(naive_get_string(&m), text, len) == 0);
+        naive_swap(&m, &v);
+        EXPECT_TRUE(naive_is_equal(&m, &v));
+
+        /* growing an array moves its elements */
+        naive_init(&a);
+        naive_set_array(&a, 1);
+        for (size_t i = 0; i < 40; i++)
+            naive_copy(naive_pushback_array(&a), &v);
+        for (size_t i = 0; i < 40; i++)
+            EXPECT_TRUE(naive_is_equal(naive_get_array_element(&a, i), &v));
+        naive_free(&a);
+        naive_free(&m);
+        naive_free(&v);
+    }
 }
 
 static void test_access_array() {
@@ -569,6 +767,76 @@ static void test_access_object() {
 #endif
 }
 
+static void test_access_object_index() {
+    NaiveValue o, r;
+    size_t i, index;
+    char key[16];
+
+    naive_init(&o);
+    naive_set_object(&o, 0);
+    for (i = 0; i < 1000; i++) {
+        snprintf(key, sizeof(key), "key%zu", i);
+        naive_set_number(naive_set_object_value(&o, key, strlen(key)), (double) i);
+    }
+    EXPECT_EQ_SIZE_T(1000, naive_get_object_size(&o));
+    for (i = 0; i < 1000; i++) {
+        snprintf(key, sizeof(key), "key%zu", i);
+        index = naive_get_object_key_index(&o, key, strlen(key));
+        EXPECT_TRUE(index != NAIVE_KEY_NOT_EXIST);
+        EXPECT_EQ_DOUBLE((double) i, naive_get_number(naive_get_object_value(&o, index)));
+    }
+    EXPECT_TRUE(naive_get_object_key_index(&o, "key1000", 7) == NAIVE_KEY_NOT_EXIST);
+
+    /* removal moves the last member, the index has to follow */
+    for (i = 0; i < 1000; i += 2) {
+        snprintf(key, sizeof(key), "key%zu", i);
+        naive_remove_object_value(&o, naive_get_object_key_index(&o, key, strlen(key)));
+    }
+    EXPECT_EQ_SIZE_T(500, naive_get_object_size(&o));
+    for (i = 0; i < 1000; i++) {
+        snprintf(key, sizeof(key), "key%zu", i);
+        NaiveValue* pv = naive_get_object_value(&o, key, strlen(key));
+        if (i % 2) {
+            EXPECT_TRUE(pv != NULL);
+            if (pv)
+                EXPECT_EQ_DOUBLE((double) i, naive_get_number(pv));
+        } else
+            EXPECT_TRUE(pv == NULL);
+    }
+
+    /* equality looks every key up in the other object */
+    std::string json = "{";
+    for (i = 1000; i-- > 0;) {
+        if (i % 2 == 0)
+            continue;
+        json += json.size() > 1 ? ",\"key" : "\"key";
+        json += std::to_string(i) + "\":" + std::to_string(i);
+    }
+    json += "}";
+    naive_init(&r);
+    EXPECT_EQ_INT(NAIVE_PARSE_OK, naive_parse(&r, json.c_str()));
+    /* writers build the index, const lookups only read it */
+    EXPECT_TRUE((o.flags & NAIVE_VALUE_INDEXED) != 0);
+    EXPECT_TRUE((r.flags & NAIVE_VALUE_INDEXED) != 0);
+    EXPECT_TRUE(naive_is_equal(&o, &r));
+    naive_set_null(naive_get_object_value(&r, "key1", 4));
+    EXPECT_FALSE(naive_is_equal(&o, &r));
+
+    naive_shrink_object(&o);
+    EXPECT_EQ_SIZE_T(500, naive_get_object_capacity(&o));
+    EXPECT_TRUE((o.flags & NAIVE_VALUE_INDEXED) != 0);
+    EXPECT_TRUE(naive_get_object_value(&o, "key999", 6) != NULL);
+    naive_copy(&r, &o);
+    EXPECT_TRUE((r.flags & NAIVE_VALUE_INDEXED) != 0);
+    EXPECT_TRUE(naive_get_object_value(&r, "key999", 6) != NULL);
+    naive_clear_object(&o);
+    EXPECT_TRUE(naive_get_object_value(&o, "key999", 6) == NULL);
+    naive_set_number(naive_set_object_value(&o, "key999", 6), 999.0);
+    EXPECT_TRUE(naive_get_object_value(&o, "key999", 6) != NULL);
+    naive_free(&o);
+    naive_free(&r);
+}
+
 static void test_stringify_number() {
     TEST_ROUNDTRIP("0");
     TEST_ROUNDTRIP("-0");
@@ -580,16 +848,32 @@ static void test_stringify_number() {
     TEST_ROUNDTRIP("1e+20");
     TEST_ROUNDTRIP("1.234e+20");
     TEST_ROUNDTRIP("1.234e-20");
+    TEST_ROUNDTRIP("1234567890123");
+    TEST_ROUNDTRIP("9007199254740993");
+    TEST_ROUNDTRIP("9223372036854775807");
+    TEST_ROUNDTRIP("-9223372036854775808");
+    TEST_ROUNDTRIP("18446744073709551615");
 
     TEST_ROUNDTRIP("1.0000000000000002");       /* the smallest number > 1 */
-    TEST_ROUNDTRIP("4.9406564584124654e-324");  /* minimum denormal */
-    TEST_ROUNDTRIP("-4.9406564584124654e-324");
-    TEST_ROUNDTRIP("2.2250738585072009e-308");  /* Max subnormal double */
-    TEST_ROUNDTRIP("-2.2250738585072009e-308");
+    TEST_ROUNDTRIP("5e-324");                   /* minimum denormal */
+    TEST_ROUNDTRIP("-5e-324");
+    TEST_ROUNDTRIP("2.225073858507201e-308");   /* Max subnormal double */
+    TEST_ROUNDTRIP("-2.225073858507201e-308");
     TEST_ROUNDTRIP("2.2250738585072014e-308");  /* Min normal positive double */
     TEST_ROUNDTRIP("-2.2250738585072014e-308");
     TEST_ROUNDTRIP("1.7976931348623157e+308");  /* Max double */
     TEST_ROUNDTRIP("-1.7976931348623157e+308");
+
+    /* shortest digits that read back to the same double */
+    TEST_ROUNDTRIP("0.1");
+    TEST_ROUNDTRIP("0.3");
+    TEST_ROUNDTRIP("1e-05");
+    TEST_ROUNDTRIP("0.0001");
+    TEST_ROUNDTRIP("123456.789");
+    TEST_ROUNDTRIP("9007199254740991");
+    TEST_ROUNDTRIP("10000000000000000");
+    TEST_ROUNDTRIP("1e+17");
+    TEST_ROUNDTRIP("5.960464477539063e-08");
 }
 
 static void test_stringify_string() {
@@ -598,6 +882,22 @@ static void test_stringify_string() {
     TEST_ROUNDTRIP("\"Hello\\nWorld\"");
     TEST_ROUNDTRIP("\"\\\" \\\\ / \\b \\f \\n \\r \\t\"");
     TEST_ROUNDTRIP("\"Hello\\u0000World\"");
+    /* escapes at every offset within and across vector blocks */
+    std::string json = "\"";
+    for (int i = 0; i < 100; i++) {
+        json.append(i % 37, 'x');
+        json += i % 3 ? "\\n" : "\\u001F";
+    }
+    json += "\"";
+    NaiveValue v;
+    size_t length;
+    naive_init(&v);
+    EXPECT_EQ_INT(NAIVE_PARSE_OK, naive_parse(&v, json.c_str()));
+    char* json2 = naive_stringify(&v, &length);
+    EXPECT_TRUE(json == std::string(json2, length));
+    check_stringify_into(&v, json2, length);
+    naive_free(&v);
+    free(json2);
 }
 
 static void test_stringify_array() {
@@ -611,6 +911,104 @@ static void test_stringify_object() {
             "{\"n\":null,\"f\":false,\"t\":true,\"i\":123,\"s\":\"abc\",\"a\":[1,2,3],\"o\":{\"1\":1,\"2\":2,\"3\":3}}");
 }
 
+struct SinkBuffer {
+    std::string out;
+    size_t max_slice; /* the largest slice that came from the stringify buffer */
+    size_t calls, stop_after;
+};
+
+static bool sink_buffer_write(void* user, const NaiveSlice* slices, size_t count) {
+    SinkBuffer* buffer = static_cast<SinkBuffer*>(user);
+    if (buffer->calls++ == buffer->stop_after)
+        return false;
+    EXPECT_TRUE(count == 1 || count == 2);
+    for (size_t i = 0; i < count; i++) {
+        buffer->out.append(slices[i].data, slices[i].len);
+        if (i + 1 < count || count == 1)
+            buffer->max_slice = slices[i].len > buffer->max_slice ? slices[i].len : buffer->max_slice;
+    }
+    return true;
+}
+
+static std::string read_stream(FILE* fp) {
+    std::string out;
+    char block[4096];
+    size_t n;
+    rewind(fp);
+    while ((n = fread(block, 1, sizeof(block), fp)) > 0)
+        out.append(block, n);
+    return out;
+}
+
+static void test_stringify_sink() {
+    /* many small values, plus long strings with and without escapes */
+    NaiveValue v;
+    std::string plain(100000, 'x'), escaped;
+    for (int i = 0; i < 20000; i++)
+        escaped += i % 7 ? 'a' : '\n';
+    naive_init(&v);
+    naive_set_array(&v, 0);
+    for (int i = 0; i < 20000; i++) {
+        NaiveValue* o = naive_pushback_array(&v);
+        naive_set_object(o, 0);
+        naive_set_number(naive_set_object_value(o, "id", 2), i);
+        naive_set_string(naive_set_object_value(o, "name", 4), "na\"ive", 6);
+    }
+    naive_set_string(naive_pushback_array(&v), plain.data(), plain.size());
+    naive_set_string(naive_pushback_array(&v), escaped.data(), escaped.size());
+    naive_set_string(naive_pushback_array(&v), (escaped + plain).data(), escaped.size() + plain.size());
+    size_t length;
+    char* expect = naive_stringify(&v, &length);
+    check_stringify_into(&v, expect, length);
+
+    SinkBuffer buffer = {std::string(), 0, 0, static_cast<size_t>(-1)};
+    NaiveSink sink = {&buffer, sink_buffer_write};
+    EXPECT_TRUE(naive_stringify_sink(&v, &sink));
+    EXPECT_EQ_SIZE_T(length, buffer.out.size());
+    EXPECT_TRUE(buffer.out == std::string(expect, length));
+    EXPECT_TRUE(buffer.calls > length / NAIVE_SINK_BUFFER_SIZE / 2);
+    EXPECT_TRUE(buffer.max_slice < 2 * NAIVE_SINK_BUFFER_SIZE);
+
+    /* the sink can stop it */
+    SinkBuffer stopped = {std::string(), 0, 0, 2};
+    sink.user = &stopped;
+    EXPECT_FALSE(naive_stringify_sink(&v, &sink));
+    EXPECT_EQ_SIZE_T(3, stopped.calls);
+
+    FILE* fp = tmpfile();
+    EXPECT_TRUE(naive_stringify_file(&v, fp));
+    fflush(fp);
+    EXPECT_TRUE(read_stream(fp) == std::string(expect, length));
+    fclose(fp);
+
+    fp = tmpfile();
+    EXPECT_TRUE(naive_stringify_fd(&v, fileno(fp)));
+    EXPECT_TRUE(read_stream(fp) == std::string(expect, length));
+    fclose(fp);
+
+    free(expect);
+    naive_free(&v);
+
+    /* long raw spans go out in slices of their own too */
+    std::string raw = "[\"" + plain + "\",0." + std::string(100000, '0') + "1]";
+    EXPECT_EQ_INT(NAIVE_PARSE_OK, naive_parse_raw(&v, raw.data(), raw.size()));
+    SinkBuffer spans = {std::string(), 0, 0, static_cast<size_t>(-1)};
+    sink.user = &spans;
+    EXPECT_TRUE(naive_stringify_sink(&v, &sink));
+    EXPECT_TRUE(spans.out == raw);
+    EXPECT_TRUE(spans.max_slice < 2 * NAIVE_SINK_BUFFER_SIZE);
+    naive_free(&v);
+
+    /* scalars and empty containers come out whole */
+    naive_init(&v);
+    EXPECT_EQ_INT(NAIVE_PARSE_OK, naive_parse(&v, "[1.5,\"a\",{}]"));
+    buffer.out.clear();
+    sink.user = &buffer;
+    EXPECT_TRUE(naive_stringify_sink(&v, &sink));
+    EXPECT_TRUE(buffer.out == "[1.5,\"a\",{}]");
+    naive_free(&v);
+}
+
 static void test_copy() {
     NaiveValue v1, v2;
     naive_init(&v1);
@@ -651,6 +1049,83 @@ static void test_swap() {
 }
 
 
+static void test_arena() {
+    NaiveArena arena;
+    NaiveValue v, e, * pv;
+    size_t i;
+    const char* json = "{\"n\":null,\"s\":\"abc\",\"a\":[1,2,3],\"o\":{\"1\":1,\"2\":[\"x\"]}}";
+    naive_arena_init(&arena, 4096);
+
+    naive_init(&v);
+    EXPECT_EQ_INT(NAIVE_PARSE_OK, naive_parse(&v, json, &arena));
+    naive_init(&e);
+    EXPECT_EQ_INT(NAIVE_PARSE_OK, naive_parse(&e, json));
+    EXPECT_TRUE(naive_is_equal(&v, &e));
+
+    /* values inside the arena keep working with the mutation interface */
+    naive_set_string(naive_get_object_value(&v, "s", 1), "Hello, World!", 13);
+    pv = naive_get_object_value(&v, "a", 1);
+    for (i = 0; i < 100; i++)
+        naive_set_number(naive_pushback_array(pv), (double) i);
+    EXPECT_EQ_SIZE_T(103, naive_get_array_size(pv));
+    EXPECT_EQ_DOUBLE(99.0, naive_get_number(naive_get_array_element(pv, 102)));
+    pv = naive_get_object_value(&v, "o", 1);
+    naive_set_string(naive_set_object_value(pv, "3", 1), "three", 5);
+    naive_remove_object_value(pv, naive_get_object_key_index(pv, "1", 1));
+    EXPECT_EQ_SIZE_T(2, naive_get_object_size(pv));
+
+    /* heap values moved into the arena are copied there, arena values moved out stay shared */
+    naive_move(naive_get_object_value(&v, "n", 1), &e);
+    EXPECT_EQ_INT(NAIVE_NULL, naive_get_type(&e));
+    EXPECT_EQ_INT(NAIVE_OBJECT, naive_get_type(naive_get_object_value(&v, "n", 1)));
+    naive_set_string(&e, "heap", 4);
+    naive_swap(&e, naive_get_object_value(&v, "s", 1));
+    EXPECT_EQ_STRING("Hello, World!", naive_get_string(&e), naive_get_string_length(&e));
+    EXPECT_EQ_STRING("heap", naive_get_string(naive_get_object_value(&v, "s", 1)), 4);
+    naive_free(&e);
+
+    /* the root is not inside the arena, it takes its members to the heap when it grows */
+    naive_set_boolean(naive_set_object_value(&v, "b", 1), true);
+    EXPECT_EQ_SIZE_T(5, naive_get_object_size(&v));
+    naive_copy(&e, &v);
+    EXPECT_TRUE(naive_is_equal(&e, &v));
+    naive_free(&e);
+    naive_free(&v);
+
+    /* elements larger than a chunk get a chunk of their own */
+    std::string big = "[";
+    for (i = 0; i < 1000; i++)
+        big += i ? ",[0]" : "[0]";
+    big += "]";
+    EXPECT_EQ_INT(NAIVE_PARSE_OK, naive_parse(&v, big.c_str(), &arena));
+    pv = naive_get_array_element(&v, 999);
+    naive_set_string(naive_pushback_array(pv), "tail", 4);
+    EXPECT_EQ_SIZE_T(2, naive_get_array_size(pv));
+
+    /* a slot emptied with naive_set_null still belongs to the arena, its next payload goes there too */
+    const char* text = "a string too long to be kept inline";
+    pv = naive_get_array_element(&v, 998);
+    naive_set_null(pv);
+    naive_set_string(pv, text, strlen(text));
+    EXPECT_EQ_STRING("a string too long to be kept inline", naive_get_string(pv), naive_get_string_length(pv));
+
+    /* naive_init makes a fresh value of any memory, whatever stamp it held */
+    NaiveValue* fresh = static_cast<NaiveValue*>(malloc(sizeof(NaiveValue)));
+    memset(static_cast<void*>(fresh), 0xff, sizeof(NaiveValue));
+    naive_init(fresh);
+    naive_set_string(fresh, text, strlen(text));
+    naive_free(fresh);
+    free(fresh);
+    naive_free(&v);
+
+    naive_arena_reset(&arena);
+    EXPECT_EQ_INT(NAIVE_PARSE_OK, naive_parse(&v, json, &arena));
+    EXPECT_EQ_SIZE_T(4, naive_get_object_size(&v));
+    naive_free(&v);
+    naive_arena_destroy(&arena);
+}
+
+
 #define TEST_EQUAL(json1, json2, equality) \
     do {\
         NaiveValue v1, v2;\
@@ -690,11 +1165,960 @@ static void test_equal() {
 }
 
 
+/* parses a copy of the first len bytes that has nothing readable after it */
+static int parse_unterminated(NaiveValue* v, const char* json, size_t len) {
+    char* buffer = static_cast<char*>(malloc(len > 0 ? len : 1));
+    memcpy(buffer, json, len);
+    naive_init(v);
+    int ret = naive_parse_n(v, buffer, len);
+    if (ret == NAIVE_PARSE_OK) {
+        /* the document must not point into the buffer */
+        memset(buffer, 'x', len);
+    }
+    free(buffer);
+    return ret;
+}
+
+#define TEST_PARSE_N(error, json)\
+    do {\
+        NaiveValue v;\
+        EXPECT_EQ_INT(error, parse_unterminated(&v, json, sizeof(json) - 1));\
+        naive_free(&v);\
+    } while(0)
+
+static void test_parse_n() {
+    NaiveValue v;
+    TEST_PARSE_N(NAIVE_PARSE_OK, "null");
+    TEST_PARSE_N(NAIVE_PARSE_OK, " [1, 2.5e3, \"abc\", {\"k\": true}] ");
+    TEST_PARSE_N(NAIVE_PARSE_EXPECT_VALUE, "");
+    TEST_PARSE_N(NAIVE_PARSE_EXPECT_VALUE, "   ");
+    TEST_PARSE_N(NAIVE_PARSE_INVALID_VALUE, "nul");
+    TEST_PARSE_N(NAIVE_PARSE_INVALID_VALUE, "-");
+    TEST_PARSE_N(NAIVE_PARSE_INVALID_VALUE, "1.");
+    TEST_PARSE_N(NAIVE_PARSE_INVALID_VALUE, "1e");
+    TEST_PARSE_N(NAIVE_PARSE_INVALID_VALUE, "1e-");
+    TEST_PARSE_N(NAIVE_PARSE_MISS_QUOTATION_MARK, "\"abc");
+    TEST_PARSE_N(NAIVE_PARSE_MISS_QUOTATION_MARK, "\"a long string without its closing quotation mark");
+    TEST_PARSE_N(NAIVE_PARSE_INVALID_STRING_ESCAPE, "\"\\");
+    TEST_PARSE_N(NAIVE_PARSE_INVALID_UNICODE_HEX, "\"\\u12");
+    TEST_PARSE_N(NAIVE_PARSE_INVALID_UNICODE_SURROGATE, "\"\\uD800");
+    TEST_PARSE_N(NAIVE_PARSE_INVALID_UNICODE_SURROGATE, "\"\\uD800\\");
+    TEST_PARSE_N(NAIVE_PARSE_INVALID_UNICODE_HEX, "\"\\uD800\\uDC");
+    TEST_PARSE_N(NAIVE_PARSE_MISS_COMMA_OR_SQUARE_BRACKET, "[1,2");
+    TEST_PARSE_N(NAIVE_PARSE_EXPECT_VALUE, "[1,");
+    TEST_PARSE_N(NAIVE_PARSE_MISS_KEY, "{");
+    TEST_PARSE_N(NAIVE_PARSE_MISS_COLON, "{\"a\"");
+    TEST_PARSE_N(NAIVE_PARSE_MISS_COMMA_OR_CURLY_BRACKET, "{\"a\":1");
+
+    /* '\0' is an ordinary (invalid) character inside the span */
+    TEST_PARSE_N(NAIVE_PARSE_INVALID_STRING_CHAR, "\"a\0b\"");
+    TEST_PARSE_N(NAIVE_PARSE_ROOT_NOT_SINGULAR, "1 \0");
+
+    /* only the span is parsed */
+    naive_init(&v);
+    EXPECT_EQ_INT(NAIVE_PARSE_OK, naive_parse_n(&v, "[1,2]tail", 5));
+    EXPECT_EQ_SIZE_T(2, naive_get_array_size(&v));
+    naive_free(&v);
+    EXPECT_EQ_INT(NAIVE_PARSE_OK, naive_parse_n(&v, "\"abc\"def\"", 5));
+    EXPECT_EQ_STRING("abc", naive_get_string(&v), naive_get_string_length(&v));
+    naive_free(&v);
+    EXPECT_EQ_INT(NAIVE_PARSE_OK, naive_parse_n(&v, "12345", 3));
+    EXPECT_EQ_DOUBLE(123.0, naive_get_number(&v));
+    naive_free(&v);
+    EXPECT_EQ_INT(NAIVE_PARSE_INVALID_VALUE, naive_parse_n(&v, "true", 3));
+
+    /* the vector scans stop at the end of an exactly sized buffer, whatever its length */
+    for (size_t n = 0; n < 100; n++) {
+        std::string text = "[\"" + std::string(n, 'x') + "\"" + std::string(n, ' ') + "]" + std::string(n, ' ');
+        for (size_t len = text.size() - n; len <= text.size(); len++) {
+            char* json = static_cast<char*>(malloc(len));
+            memcpy(json, text.data(), len);
+            EXPECT_EQ_INT(NAIVE_PARSE_OK, naive_parse_n(&v, json, len));
+            EXPECT_EQ_SIZE_T(n, naive_get_string_length(naive_get_array_element(&v, 0)));
+            naive_free(&v);
+            free(json);
+        }
+        char* json = static_cast<char*>(malloc(n + 1));
+        memset(json, 'x', n + 1);
+        json[0] = '\"';
+        EXPECT_EQ_INT(NAIVE_PARSE_MISS_QUOTATION_MARK, naive_parse_n(&v, json, n + 1));
+        free(json);
+    }
+}
+
+static void test_parse_insitu() {
+    NaiveValue v, e, * pv;
+    char json[] = "{\"plain\":\"abc\",\"esc\\taped\":\"\\\"\\\\\\/\\b\\f\\n\\r\\t\",\"unicode\":\"\\u20AC\\uD834\\uDD1E\","
+                  "\"array\":[\"x\",1,true,{\"k\":\"v\"}]}";
+    const char* begin = json;
+    const char* end = json + sizeof(json);
+    naive_init(&e);
+    EXPECT_EQ_INT(NAIVE_PARSE_OK, naive_parse(&e, json));
+    naive_init(&v);
+    EXPECT_EQ_INT(NAIVE_PARSE_OK, naive_parse_insitu(&v, json, sizeof(json) - 1));
+    EXPECT_TRUE(naive_is_equal(&v, &e));
+
+    /* strings and keys live in the buffer, terminated */
+    pv = naive_get_object_value(&v, "esc\taped", 8);
+    EXPECT_TRUE(pv != NULL);
+    if (pv) {
+        EXPECT_TRUE(naive_get_string(pv) >= begin && naive_get_string(pv) < end);
+        EXPECT_EQ_STRING("\"\\/\b\f\n\r\t", naive_get_string(pv), naive_get_string_length(pv));
+        EXPECT_EQ_INT('\0', naive_get_string(pv)[naive_get_string_length(pv)]);
+    }
+    EXPECT_TRUE(naive_get_object_key(&v, 1) >= begin && naive_get_object_key(&v, 1) < end);
+    EXPECT_EQ_STRING("esc\taped", naive_get_object_key(&v, 1), naive_get_object_key_length(&v, 1));
+    pv = naive_get_object_value(&v, "unicode", 7);
+    EXPECT_TRUE(pv != NULL);
+    if (pv)
+        EXPECT_EQ_STRING("\xE2\x82\xAC\xF0\x9D\x84\x9E", naive_get_string(pv), naive_get_string_length(pv));
+
+    /* mutation takes the keys over before mixing in its own */
+    naive_set_string(naive_set_object_value(&v, "new", 3), "value", 5);
+    naive_remove_object_value(&v, naive_get_object_key_index(&v, "plain", 5));
+    naive_set_string(naive_get_object_value(&v, "esc\taped", 8), "copied", 6);
+    EXPECT_EQ_SIZE_T(4, naive_get_object_size(&v));
+    naive_free(&v);
+    naive_free(&e);
+
+    char error[] = "[\"abc\", \"\\x\"]";
+    EXPECT_EQ_INT(NAIVE_PARSE_INVALID_STRING_ESCAPE, naive_parse_insitu(&v, error, sizeof(error) - 1));
+    EXPECT_EQ_INT(NAIVE_NULL, naive_get_type(&v));
+}
+
+/* a handler that builds its own tree through the access interface */
+struct SaxTree {
+    NaiveValue root;
+    NaiveValue* stack[32];
+    size_t depth;
+    NaiveValue* pending; /* slot opened by on_key */
+    size_t events;
+};
+
+static NaiveValue* sax_slot(SaxTree* t) {
+    NaiveValue* slot = t->pending;
+    t->events++;
+    t->pending = NULL;
+    if (slot)
+        return slot;
+    if (t->depth == 0)
+        return &t->root;
+    return naive_pushback_array(t->stack[t->depth - 1]);
+}
+
+static bool sax_null(void* user) {
+    naive_set_null(sax_slot(static_cast<SaxTree*>(user)));
+    return true;
+}
+
+static bool sax_boolean(void* user, bool flag) {
+    naive_set_boolean(sax_slot(static_cast<SaxTree*>(user)), flag);
+    return true;
+}
+
+static bool sax_number(void* user, double number) {
+    naive_set_number(sax_slot(static_cast<SaxTree*>(user)), number);
+    return true;
+}
+
+static bool sax_int64(void* user, int64_t number) {
+    naive_set_int64(sax_slot(static_cast<SaxTree*>(user)), number);
+    return true;
+}
+
+static bool sax_uint64(void* user, uint64_t number) {
+    naive_set_uint64(sax_slot(static_cast<SaxTree*>(user)), number);
+    return true;
+}
+
+static bool sax_string(void* user, const char* str, size_t len) {
+    naive_set_string(sax_slot(static_cast<SaxTree*>(user)), str, len);
+    return true;
+}
+
+static bool sax_start_object(void* user) {
+    SaxTree* t = static_cast<SaxTree*>(user);
+    NaiveValue* v = sax_slot(t);
+    naive_set_object(v, 0);
+    t->stack[t->depth++] = v;
+    return true;
+}
+
+static bool sax_key(void* user, const char* key, size_t keylen) {
+    SaxTree* t = static_cast<SaxTree*>(user);
+    t->pending = naive_set_object_value(t->stack[t->depth - 1], key, keylen);
+    return true;
+}
+
+static bool sax_start_array(void* user) {
+    SaxTree* t = static_cast<SaxTree*>(user);
+    NaiveValue* v = sax_slot(t);
+    naive_set_array(v, 0);
+    t->stack[t->depth++] = v;
+    return true;
+}
+
+static bool sax_end(void* user, size_t count) {
+    SaxTree* t = static_cast<SaxTree*>(user);
+    NaiveValue* v = t->stack[--t->depth];
+    return count == (v->type == NAIVE_ARRAY ? naive_get_array_size(v) : naive_get_object_size(v));
+}
+
+static bool sax_abort_number(void* user, double) {
+    return ++static_cast<SaxTree*>(user)->events < 3;
+}
+
+static bool sax_throw_string(void*, const char*, size_t) {
+    throw std::runtime_error("naivetest: thrown from a handler");
+}
+
+static void sax_tree_handler(NaiveHandler* handler, SaxTree* t) {
+    memset(handler, 0, sizeof(*handler));
+    handler->user = t;
+    handler->on_null = sax_null;
+    handler->on_boolean = sax_boolean;
+    handler->on_number = sax_number;
+    handler->on_int64 = sax_int64;
+    handler->on_uint64 = sax_uint64;
+    handler->on_string = sax_string;
+    handler->on_start_object = sax_start_object;
+    handler->on_key = sax_key;
+    handler->on_end_object = sax_end;
+    handler->on_start_array = sax_start_array;
+    handler->on_end_array = sax_end;
+    t->depth = 0;
+    t->pending = NULL;
+    naive_init(&t->root);
+}
+
+static void test_parse_sax() {
+    static const char* documents[] = {
+            "null", " true ", "-1.5e3", "\"esc\\u20AC\\n\"",
+            "[]", "{}", "[1,[2,[3,[]]],{\"a\":{\"b\":[null,false]}}]",
+            "{\"name\":\"naive\\tjson\",\"list\":[1,2,3],\"nested\":{\"k\":\"v\",\"e\":{}}}",
+            "[-9223372036854775808,18446744073709551615,9007199254740993,0.5]"
+    };
+    static const char* errors[] = {
+            "", "nul", "[1,]", "{\"a\" 1}", "{1:1}", "[\"\\x\"]", "[1 2]", "{\"a\":1", "1 2", "1e309"
+    };
+    NaiveHandler handler;
+    SaxTree t;
+    NaiveValue e;
+    sax_tree_handler(&handler, &t);
+    for (size_t i = 0; i < sizeof(documents) / sizeof(documents[0]); i++) {
+        naive_init(&t.root);
+        t.depth = 0;
+        t.pending = NULL;
+        naive_init(&e);
+        EXPECT_EQ_INT(NAIVE_PARSE_OK, naive_parse_sax(&handler, documents[i], strlen(documents[i])));
+        EXPECT_EQ_INT(NAIVE_PARSE_OK, naive_parse(&e, documents[i]));
+        EXPECT_EQ_SIZE_T(0, t.depth);
+        EXPECT_TRUE(naive_is_equal(&t.root, &e));
+        naive_free(&t.root);
+        naive_free(&e);
+    }
+
+    /* the same errors as the tree parser */
+    for (size_t i = 0; i < sizeof(errors) / sizeof(errors[0]); i++) {
+        naive_init(&t.root);
+        t.depth = 0;
+        t.pending = NULL;
+        naive_init(&e);
+        EXPECT_EQ_INT(naive_parse(&e, errors[i]), naive_parse_sax(&handler, errors[i], strlen(errors[i])));
+        naive_free(&t.root);
+    }
+
+    /* unset callbacks are skipped, a false return stops the parse */
+    memset(&handler, 0, sizeof(handler));
+    handler.user = &t;
+    handler.on_number = sax_abort_number;
+    t.events = 0;
+    const char* numbers = "[\"a\",{\"b\":1},2,3,4]";
+    EXPECT_EQ_INT(NAIVE_PARSE_HANDLER_ABORTED, naive_parse_sax(&handler, numbers, strlen(numbers)));
+    EXPECT_EQ_SIZE_T(3, t.events);
+    t.events = 0;
+    const char* single = "[null,\"x\",{\"b\":[]},1]";
+    EXPECT_EQ_INT(NAIVE_PARSE_OK, naive_parse_sax(&handler, single, strlen(single)));
+    EXPECT_EQ_SIZE_T(1, t.events);
+
+    /* a throwing handler unwinds the parse, the frames of a deep document and the stack go back */
+    memset(&handler, 0, sizeof(handler));
+    handler.on_string = sax_throw_string;
+    std::string deep = std::string(100, '[') + "{\"k\\n\":[1,\"\\u20AC\"]}" + std::string(100, ']');
+    bool thrown = false;
+    try {
+        naive_parse_sax(&handler, deep.data(), deep.size());
+    } catch (const std::runtime_error&) {
+        thrown = true;
+    }
+    EXPECT_TRUE(thrown);
+}
+
+/* feeds [0, split) and then pieces of `step` bytes, each from its own allocation */
+static int feed_stream(NaiveStream* stream, const char* json, size_t split, size_t step) {
+    size_t len = strlen(json), i = 0, n = split;
+    int ret = NAIVE_PARSE_OK;
+    while (i < len && ret == NAIVE_PARSE_OK) {
+        if (n > len - i)
+            n = len - i;
+        char* chunk = static_cast<char*>(malloc(n ? n : 1));
+        memcpy(chunk, json + i, n);
+        ret = naive_stream_feed(stream, chunk, n);
+        free(chunk);
+        i += n;
+        n = step;
+    }
+    return ret == NAIVE_PARSE_OK ? naive_stream_finish(stream) : ret;
+}
+
+static void test_parse_stream() {
+    static const char* documents[] = {
+            "null", " false ", "true", "0", "-0.0", "1.5e-10", "123456789012345678901", "1E+308",
+            "\"\"", "\"Hello\\nWorld\"", "\"\\\" \\\\ \\/ \\b \\f \\n \\r \\t\"",
+            "\"\\u20AC\\uD834\\uDD1E \\u0024\"", "[ ]", "{ }",
+            "[ null , false , true , 123 , \"abc\", [ 1 , [ ] ] ]",
+            " { \"n\" : null , \"f\" : false , \"t\" : true , \"i\" : 123 , \"s\" : \"abc\", "
+            "\"a\" : [ 1, 2, 3 ], \"o\" : { \"1\" : 1, \"2\" : 2, \"3\" : {\"\\u00e9\\\"\":[-1e-3]} } } ",
+            /* errors */
+            "", " ", "nul", "nulx", "nullx", "?", "+0", "0123", "1.", "1e", "-", "1e309", "[1,]", "[1", "[",
+            "[1 2]", "[\"a\" 2]", "{", "{1:1}", "{\"a\"", "{\"a\" 1}", "{\"a\":", "{\"a\":1", "{\"a\":1,",
+            "{\"a\":1,}", "{\"a\":1 \"b\"}", "[\"abc", "\"\\", "\"\\x\"", "\"\\u12\"", "\"\\uD800\"",
+            "\"\\uD800\\uE000\"", "\"a\x01\"", "[] x", "1 2", "\"a\"b"
+    };
+    NaiveStream stream;
+    NaiveHandler handler;
+    SaxTree t;
+    NaiveValue v, e;
+    for (size_t i = 0; i < sizeof(documents) / sizeof(documents[0]); i++) {
+        const char* json = documents[i];
+        size_t len = strlen(json);
+        naive_init(&e);
+        int expect = naive_parse_n(&e, json, len);
+        for (size_t split = 0; split <= len; split++) {
+            naive_stream_init(&stream, &v);
+            EXPECT_EQ_INT(expect, feed_stream(&stream, json, split, len));
+            naive_stream_destroy(&stream);
+            if (expect == NAIVE_PARSE_OK)
+                EXPECT_TRUE(naive_is_equal(&v, &e));
+            else
+                EXPECT_EQ_INT(NAIVE_NULL, naive_get_type(&v));
+            naive_free(&v);
+        }
+        /* a byte at a time, as a tree and as events */
+        naive_stream_init(&stream, &v);
+        EXPECT_EQ_INT(expect, feed_stream(&stream, json, 1, 1));
+        naive_stream_destroy(&stream);
+        EXPECT_TRUE(expect != NAIVE_PARSE_OK || naive_is_equal(&v, &e));
+        naive_free(&v);
+        sax_tree_handler(&handler, &t);
+        naive_stream_init(&stream, &handler);
+        EXPECT_EQ_INT(expect, feed_stream(&stream, json, 1, 1));
+        naive_stream_destroy(&stream);
+        EXPECT_TRUE(expect != NAIVE_PARSE_OK || naive_is_equal(&t.root, &e));
+        naive_free(&t.root);
+        naive_free(&e);
+    }
+
+    /* errors stick, abandoned documents are released */
+    naive_stream_init(&stream, &v);
+    EXPECT_EQ_INT(NAIVE_PARSE_OK, naive_stream_feed(&stream, "[\"abc\", {\"k\": [1, \"x", 20));
+    EXPECT_EQ_INT(NAIVE_PARSE_MISS_COLON, naive_stream_feed(&stream, "\"]}, {\"a\" 1}]", 13));
+    EXPECT_EQ_INT(NAIVE_PARSE_MISS_COLON, naive_stream_feed(&stream, "", 0));
+    EXPECT_EQ_INT(NAIVE_PARSE_MISS_COLON, naive_stream_finish(&stream));
+    naive_stream_destroy(&stream);
+    naive_stream_init(&stream, &v);
+    EXPECT_EQ_INT(NAIVE_PARSE_OK, naive_stream_feed(&stream, "{\"key\": [\"value\", {\"k\": \"v", 26));
+    naive_stream_destroy(&stream);
+    EXPECT_EQ_INT(NAIVE_NULL, naive_get_type(&v));
+}
+
+/* `depth` arrays, or objects keyed "a", around a 0 */
+static char* nest_json(size_t depth, bool object) {
+    char* json = static_cast<char*>(malloc(depth * 6 + 2));
+    char* p = json;
+    for (size_t i = 0; i < depth; i++) {
+        if (object) {
+            memcpy(p, "{\"a\":", 5);
+            p += 5;
+        } else
+            *p++ = '[';
+    }
+    *p++ = '0';
+    for (size_t i = 0; i < depth; i++)
+        *p++ = object ? '}' : ']';
+    *p = '\0';
+    return json;
+}
+
+static void test_parse_too_deep() {
+    NaiveValue v;
+    NaiveStream stream;
+    NaiveHandler handler;
+    char* json;
+    memset(&handler, 0, sizeof(handler));
+    for (int object = 0; object <= 1; object++) {
+        /* up to the limit, then one more */
+        json = nest_json(NAIVE_PARSE_MAX_DEPTH, object);
+        EXPECT_EQ_INT(NAIVE_PARSE_OK, naive_parse(&v, json));
+        naive_free(&v);
+        free(json);
+        json = nest_json(NAIVE_PARSE_MAX_DEPTH + 1, object);
+        v.type = NAIVE_FALSE;
+        EXPECT_EQ_INT(NAIVE_PARSE_TOO_DEEP, naive_parse(&v, json));
+        EXPECT_EQ_INT(NAIVE_NULL, naive_get_type(&v));
+        free(json);
+
+        /* every parser stops a hostile document at the same depth */
+        json = nest_json(100000, object);
+        EXPECT_EQ_INT(NAIVE_PARSE_TOO_DEEP, naive_parse(&v, json));
+        EXPECT_EQ_INT(NAIVE_PARSE_TOO_DEEP, naive_parse_indexed(&v, json, strlen(json), 1));
+        EXPECT_EQ_INT(NAIVE_PARSE_TOO_DEEP, naive_parse_sax(&handler, json, strlen(json)));
+        naive_stream_init(&stream, &v);
+        EXPECT_EQ_INT(NAIVE_PARSE_TOO_DEEP, feed_stream(&stream, json, 4096, 4096));
+        naive_stream_destroy(&stream);
+        EXPECT_EQ_INT(NAIVE_NULL, naive_get_type(&v));
+
+        /* events have no limit when asked for none, the depth only costs heap */
+        EXPECT_EQ_INT(NAIVE_PARSE_OK, naive_parse_sax(&handler, json, strlen(json), 0));
+        naive_stream_init(&stream, &handler, 0);
+        EXPECT_EQ_INT(NAIVE_PARSE_OK, feed_stream(&stream, json, 4096, 4096));
+        naive_stream_destroy(&stream);
+        free(json);
+
+        /* a tree may go deeper than the default when the parse asks for it */
+        json = nest_json(5000, object);
+        EXPECT_EQ_INT(NAIVE_PARSE_TOO_DEEP, naive_parse(&v, json));
+        EXPECT_EQ_INT(NAIVE_PARSE_OK, naive_parse_n(&v, json, strlen(json), NULL, NULL, 5000));
+        char* json2 = naive_stringify(&v, NULL);
+        EXPECT_TRUE(strcmp(json, json2) == 0);
+        free(json2);
+        naive_free(&v);
+        naive_stream_init(&stream, &v, NULL, 5000);
+        EXPECT_EQ_INT(NAIVE_PARSE_OK, feed_stream(&stream, json, 4096, 4096));
+        naive_stream_destroy(&stream);
+        naive_free(&v);
+        free(json);
+    }
+
+    /* a lower limit for one parse only, and errors past it still free what was built */
+    const char* shallow = "[{\"a\":1},[\"b\"],{\"c\":[]}]";
+    const char* deeper[] = {"[\"abcdefghijklmnopq\",{\"a\":[[]]}]", "{\"abcdefghijklmnopq\":{\"b\":{\"c\":{}}}}"};
+    EXPECT_EQ_INT(NAIVE_PARSE_OK, naive_parse_n(&v, shallow, strlen(shallow), NULL, NULL, 3));
+    naive_free(&v);
+    for (size_t i = 0; i < 2; i++) {
+        EXPECT_EQ_INT(NAIVE_PARSE_TOO_DEEP, naive_parse_n(&v, deeper[i], strlen(deeper[i]), NULL, NULL, 3));
+        EXPECT_EQ_INT(NAIVE_PARSE_OK, naive_parse(&v, deeper[i]));
+        naive_free(&v);
+    }
+    EXPECT_EQ_INT(NAIVE_PARSE_MISS_COMMA_OR_SQUARE_BRACKET,
+                  naive_parse_n(&v, "[[\"abcdefghijklmnopq\" 1]]", 25, NULL, NULL, 2));
+}
+
+static void test_parse_intern() {
+    const char* json1 = "{\"name\":\"a string of some length\",\"tag\":\"ok\",\"list\":[{\"name\":\"x\"}],"
+                        "\"long\":\"a string longer than the pooled ones\"}";
+    const char* json2 = "{\"tag\":\"ko\",\"name\":\"a string of some length\",\"x\":[1,{\"x\":2}]}";
+    NaiveInternPool pool;
+    NaiveValue v1, v2, e;
+    naive_intern_init(&pool, 30);
+    EXPECT_EQ_INT(NAIVE_PARSE_OK, naive_parse_n(&v1, json1, strlen(json1), nullptr, &pool));
+    EXPECT_EQ_INT(NAIVE_PARSE_OK, naive_parse_n(&v2, json2, strlen(json2), nullptr, &pool));
+    naive_init(&e);
+    EXPECT_EQ_INT(NAIVE_PARSE_OK, naive_parse(&e, json1));
+    EXPECT_TRUE(naive_is_equal(&v1, &e));
+    naive_free(&e);
+
+    /* one copy of each key and of each pooled string, whatever document it came from */
+    EXPECT_TRUE(naive_get_object_key(&v1, 0) == naive_get_object_key(&v2, 1));
+    EXPECT_TRUE(naive_get_object_key(&v1, 1) == naive_get_object_key(&v2, 0));
+    NaiveValue* inner = naive_get_object_value(naive_get_array_element(naive_get_object_value(&v1, "list", 4), 0), 0);
+    EXPECT_TRUE(naive_get_object_key(naive_get_array_element(naive_get_object_value(&v1, "list", 4), 0), 0) ==
+                naive_get_object_key(&v1, 0));
+    EXPECT_EQ_STRING("x", naive_get_string(inner), naive_get_string_length(inner));
+    EXPECT_TRUE(naive_get_string(naive_get_object_value(&v1, 0)) == naive_get_string(naive_get_object_value(&v2, 1)));
+    /* strings over max_string are copied */
+    NaiveValue* s = naive_get_object_value(&v1, "long", 4);
+    EXPECT_EQ_SIZE_T(36, naive_get_string_length(s));
+    EXPECT_EQ_SIZE_T(6, pool.count); /* name, tag, list, long, x and the pooled value */
+
+    /* documents with pooled keys and strings are edited, copied and freed like any other */
+    naive_set_number(naive_set_object_value(&v2, "added", 5), 1.0);
+    naive_set_string(naive_get_object_value(&v2, "name", 4), "replaced", 8);
+    naive_remove_object_value(&v2, naive_get_object_key_index(&v2, "tag", 3));
+    naive_init(&e);
+    naive_copy(&e, &v2);
+    EXPECT_TRUE(naive_is_equal(&e, &v2));
+    EXPECT_EQ_SIZE_T(3, naive_get_object_size(&e));
+    naive_free(&e);
+    naive_free(&v1);
+    naive_free(&v2);
+
+    /* a failed parse leaves the pooled keys alone */
+    EXPECT_EQ_INT(NAIVE_PARSE_MISS_COMMA_OR_CURLY_BRACKET, naive_parse_n(&v1, "{\"tag\":1 \"x\":2}", 15, nullptr, &pool));
+
+    /* the workers of naive_parse_ndjson pool what they miss on their own, merged once they are done */
+    std::string big;
+    char line[64];
+    for (int i = 0; i < 30000; i++) {
+        snprintf(line, sizeof(line), "{\"seq\":%d,\"kind\":\"%s\"}\n", i, i % 2 ? "even-numbered-record" : "odd-numbered-record");
+        big += line;
+    }
+    NaiveRecord* records;
+    size_t count = naive_parse_ndjson(big.data(), big.size(), &records, 3, &pool);
+    EXPECT_EQ_SIZE_T(30000, count);
+    bool same = true;
+    for (size_t i = 0; i < count && same; i++) {
+        same = records[i].error == NAIVE_PARSE_OK && naive_get_object_key_length(&records[i].value, 0) == 3 &&
+               memcmp(naive_get_object_key(&records[i].value, 0), "seq", 3) == 0;
+    }
+    EXPECT_TRUE(same);
+    EXPECT_EQ_SIZE_T(10, pool.count);
+
+    /* once the pool holds them, every worker hands out the same copies */
+    NaiveRecord* again;
+    size_t count2 = naive_parse_ndjson(big.data(), big.size(), &again, 3, &pool);
+    EXPECT_EQ_SIZE_T(30000, count2);
+    bool shared = true;
+    for (size_t i = 0; i < count2 && shared; i++) {
+        shared = again[i].error == NAIVE_PARSE_OK &&
+                 naive_get_object_key(&again[i].value, 0) == naive_get_object_key(&again[0].value, 0) &&
+                 naive_get_string(naive_get_object_value(&again[i].value, 1)) ==
+                 naive_get_string(naive_get_object_value(&again[i % 2].value, 1));
+    }
+    EXPECT_TRUE(shared);
+    EXPECT_EQ_SIZE_T(10, pool.count);
+    naive_free_records(again, count2);
+    naive_free_records(records, count);
+    naive_intern_destroy(&pool);
+}
+
+static void test_parse_ndjson() {
+    const char* json = "{\"a\":1}\n[1,2]\r\n\n  \n\"s\"\n{\"a\":}\ntrue false\n3";
+    NaiveRecord* records;
+    NaiveValue e;
+    size_t count = naive_parse_ndjson(json, strlen(json), &records, 4);
+    EXPECT_EQ_SIZE_T(6, count);
+    if (count == 6) {
+        EXPECT_EQ_INT(NAIVE_PARSE_OK, records[0].error);
+        EXPECT_EQ_SIZE_T(0, records[0].offset);
+        EXPECT_EQ_SIZE_T(7, records[0].len);
+        EXPECT_EQ_INT(NAIVE_OBJECT, naive_get_type(&records[0].value));
+        EXPECT_EQ_SIZE_T(6, records[1].len);
+        EXPECT_EQ_SIZE_T(2, naive_get_array_size(&records[1].value));
+        EXPECT_EQ_STRING("s", naive_get_string(&records[2].value), naive_get_string_length(&records[2].value));
+        EXPECT_EQ_INT(NAIVE_PARSE_INVALID_VALUE, records[3].error);
+        EXPECT_EQ_INT(NAIVE_NULL, naive_get_type(&records[3].value));
+        EXPECT_EQ_INT(NAIVE_PARSE_ROOT_NOT_SINGULAR, records[4].error);
+        EXPECT_EQ_DOUBLE(3.0, naive_get_number(&records[5].value));
+    }
+    naive_free_records(records, count);
+    EXPECT_EQ_SIZE_T(0, naive_parse_ndjson("\n \n", 3, &records, 0));
+    naive_free_records(records, 0);
+
+    /* large enough to be split, every thread count gives the same records in the same order */
+    std::string big;
+    char line[64];
+    for (int i = 0; i < 30000; i++) {
+        snprintf(line, sizeof(line), i % 1000 == 999 ? "{\"seq\":%d,}\n" : "{\"seq\":%d,\"tags\":[\"x\"]}\n", i);
+        big += line;
+    }
+    unsigned threads[] = {1, 2, 3, 8};
+    for (size_t t = 0; t < sizeof(threads) / sizeof(threads[0]); t++) {
+        count = naive_parse_ndjson(big.data(), big.size(), &records, threads[t]);
+        EXPECT_EQ_SIZE_T(30000, count);
+        bool ordered = true;
+        for (size_t i = 0; i < count && ordered; i++) {
+            naive_init(&e);
+            int error = naive_parse_n(&e, big.data() + records[i].offset, records[i].len);
+            ordered = error == records[i].error && naive_is_equal(&e, &records[i].value) &&
+                      (error != NAIVE_PARSE_OK ||
+                       naive_get_number(naive_get_object_value(&records[i].value, "seq", 3)) == static_cast<double>(i));
+            naive_free(&e);
+        }
+        EXPECT_TRUE(ordered);
+
+        /* with an arena the records are the same, the workers' arenas end up in it */
+        NaiveArena arena;
+        NaiveRecord* in_arena;
+        naive_arena_init(&arena, 4096);
+        EXPECT_EQ_SIZE_T(count, naive_parse_ndjson(big.data(), big.size(), &in_arena, threads[t], nullptr, &arena));
+        bool equal = true;
+        for (size_t i = 0; i < count && equal; i++)
+            equal = in_arena[i].error == records[i].error && naive_is_equal(&in_arena[i].value, &records[i].value);
+        EXPECT_TRUE(equal);
+        /* arena containers keep growing inside it */
+        NaiveValue* tags = naive_get_object_value(&in_arena[count - 2].value, "tags", 4);
+        for (int i = 0; i < 100; i++)
+            naive_set_number(naive_pushback_array(tags), i);
+        EXPECT_EQ_SIZE_T(101, naive_get_array_size(tags));
+        naive_free_records(in_arena, count);
+        naive_arena_destroy(&arena);
+        naive_free_records(records, count);
+    }
+}
+
+static void test_parse_indexed() {
+    static const char* documents[] = {
+            " [ 1 , \"a\\\\\" , { \"k\\\"\" :\t[ ] } ,\n\"\\\\\\\"\" ] ", "\"a\"  x", "[1  x]", "[1\"a\"]",
+            "{\"a\"  1}", "[\"a\\u0022  \",  \"b\"  ]", "\"abc", "  ", "[ \"\\\\\" ,  1]",
+            /* tokens that run on into bytes stage 1 does not index, or offsets in the wrong place */
+            "1x", "[truex]", "[1 2]", "[1,]", "{\"a\":1,}", "{\"a\" \"b\"}", "{,}", "[] x", "{\"a\"x:1}",
+            "[{\"a\":[]},{}]", "-0.5e+2 ", "\"\\u00e9\"x"
+    };
+    for (size_t i = 0; i < sizeof(documents) / sizeof(documents[0]); i++)
+        check_indexed(documents[i]);
+
+    /* several megabytes, so that stage 1 runs in parts: backslash runs, escaped quotes and whitespace
+       land on the part boundaries for some thread count */
+    std::string big = "[";
+    char item[128];
+    for (int i = 0; i < 40000; i++) {
+        int run = i % 7;
+        snprintf(item, sizeof(item), "%s{ \"id\" :  %d, \"s\": \"%.*s\\\"q\\\\\",\n  \"x\" : [ true ,  null, -%d.5e-3 ] }",
+                 i ? " ,\n  " : "", i, run * 2, "\\\\\\\\\\\\\\\\\\\\\\\\", i);
+        big += item;
+        if (i % 3 == 0)
+            big.append(static_cast<size_t>(i % 97), ' ');
+    }
+    big += "]";
+    NaiveValue v, e;
+    naive_init(&e);
+    EXPECT_EQ_INT(NAIVE_PARSE_OK, naive_parse_n(&e, big.data(), big.size()));
+    unsigned threads[] = {1, 2, 3, 4, 7};
+    for (size_t t = 0; t < sizeof(threads) / sizeof(threads[0]); t++) {
+        EXPECT_EQ_INT(NAIVE_PARSE_OK, naive_parse_indexed(&v, big.data(), big.size(), threads[t]));
+        EXPECT_TRUE(naive_is_equal(&v, &e));
+        naive_free(&v);
+    }
+    naive_free(&e);
+    big[big.size() / 2 + 3] = '?';
+    EXPECT_EQ_INT(naive_parse_n(&e, big.data(), big.size()), naive_parse_indexed(&v, big.data(), big.size(), 4));
+    naive_free(&e);
+    naive_free(&v);
+}
+
+static void test_lazy() {
+    const char* json = " {\"skip\": [1, \"]}\\\"[{\", {\"a\": [[], {}]}], \"n\": -1.5e3, \"t\": true, \"z\": null,"
+                       " \"k\\u00e9y\\n\": \"v\\u20AC\", \"list\": [10, [20], {\"x\": 30}, \"40\"], \"e\": {}} ";
+    NaiveLazyValue root, v, w;
+    NaiveValue e, m;
+    naive_init(&e);
+    EXPECT_EQ_INT(NAIVE_PARSE_OK, naive_parse(&e, json));
+    EXPECT_EQ_INT(NAIVE_PARSE_OK, naive_lazy_parse(&root, json, strlen(json)));
+    EXPECT_EQ_INT(NAIVE_OBJECT, naive_lazy_get_type(&root));
+    EXPECT_EQ_SIZE_T(7, naive_lazy_get_object_size(&root));
+
+    EXPECT_TRUE(naive_lazy_get_object_value(&root, "n", 1, &v));
+    EXPECT_EQ_INT(NAIVE_NUMBER, naive_lazy_get_type(&v));
+    EXPECT_EQ_DOUBLE(-1500.0, naive_lazy_get_number(&v));
+    EXPECT_TRUE(naive_lazy_get_object_value(&root, "t", 1, &v));
+    EXPECT_TRUE(naive_lazy_get_boolean(&v));
+    EXPECT_TRUE(naive_lazy_get_object_value(&root, "z", 1, &v));
+    EXPECT_EQ_INT(NAIVE_NULL, naive_lazy_get_type(&v));
+    EXPECT_FALSE(naive_lazy_get_object_value(&root, "missing", 7, &v));
+    EXPECT_FALSE(naive_lazy_get_object_value(&root, "k", 1, &v));
+
+    /* keys are compared decoded, strings decode when materialized */
+    EXPECT_TRUE(naive_lazy_get_object_value(&root, "k\xC3\xA9y\n", 5, &v));
+    naive_init(&m);
+    EXPECT_EQ_INT(NAIVE_PARSE_OK, naive_lazy_materialize(&v, &m));
+    EXPECT_EQ_STRING("v\xE2\x82\xAC", naive_get_string(&m), naive_get_string_length(&m));
+    naive_free(&m);
+
+    EXPECT_TRUE(naive_lazy_get_object_value(&root, "list", 4, &v));
+    EXPECT_EQ_SIZE_T(4, naive_lazy_get_array_size(&v));
+    EXPECT_TRUE(naive_lazy_get_array_element(&v, 2, &w));
+    EXPECT_EQ_INT(NAIVE_OBJECT, naive_lazy_get_type(&w));
+    EXPECT_TRUE(naive_lazy_get_object_value(&w, "x", 1, &w));
+    EXPECT_EQ_DOUBLE(30.0, naive_lazy_get_number(&w));
+    EXPECT_FALSE(naive_lazy_get_array_element(&v, 4, &w));
+    EXPECT_TRUE(naive_lazy_get_object_value(&root, "e", 1, &v));
+    EXPECT_EQ_SIZE_T(0, naive_lazy_get_object_size(&v));
+
+    /* cursors visit every child once, in order */
+    NaiveLazyValue k;
+    EXPECT_TRUE(naive_lazy_get_object_value(&root, "list", 4, &v));
+    w.json = NULL;
+    size_t count = 0;
+    while (naive_lazy_array_next(&v, &w)) {
+        EXPECT_EQ_INT(count == 0 ? NAIVE_NUMBER : count == 1 ? NAIVE_ARRAY : count == 2 ? NAIVE_OBJECT : NAIVE_STRING,
+                      naive_lazy_get_type(&w));
+        count++;
+    }
+    EXPECT_EQ_SIZE_T(4, count);
+    EXPECT_TRUE(naive_lazy_get_object_value(&root, "e", 1, &v));
+    k.json = NULL;
+    EXPECT_FALSE(naive_lazy_object_next(&v, &k, &w));
+    k.json = NULL;
+    count = 0;
+    while (naive_lazy_object_next(&root, &k, &w)) {
+        naive_init(&m);
+        EXPECT_EQ_INT(NAIVE_PARSE_OK, naive_lazy_materialize(&k, &m));
+        EXPECT_TRUE(naive_get_string_length(&m) == naive_get_object_key_length(&e, count) &&
+                    memcmp(naive_get_string(&m), naive_get_object_key(&e, count), naive_get_string_length(&m)) == 0);
+        naive_free(&m);
+        naive_init(&m);
+        EXPECT_EQ_INT(NAIVE_PARSE_OK, naive_lazy_materialize(&w, &m));
+        EXPECT_TRUE(naive_is_equal(&m, naive_get_object_value(&e, count)));
+        naive_free(&m);
+        count++;
+    }
+    EXPECT_EQ_SIZE_T(7, count);
+
+    /* subtrees materialize to what the tree parser builds for them */
+    for (size_t i = 0; i < naive_get_object_size(&e); i++) {
+        EXPECT_TRUE(naive_lazy_get_object_value(&root, naive_get_object_key(&e, i), naive_get_object_key_length(&e, i), &v));
+        naive_init(&m);
+        EXPECT_EQ_INT(NAIVE_PARSE_OK, naive_lazy_materialize(&v, &m));
+        EXPECT_TRUE(naive_is_equal(&m, naive_get_object_value(&e, i)));
+        naive_free(&m);
+    }
+    naive_init(&m);
+    EXPECT_EQ_INT(NAIVE_PARSE_OK, naive_lazy_materialize(&root, &m));
+    EXPECT_TRUE(naive_is_equal(&m, &e));
+    naive_free(&m);
+    naive_free(&e);
+
+    /* the whole document is still validated */
+    EXPECT_EQ_INT(NAIVE_PARSE_INVALID_STRING_ESCAPE, naive_lazy_parse(&root, "[1, {\"a\": \"\\x\"}]", 16));
+    EXPECT_EQ_INT(NAIVE_PARSE_ROOT_NOT_SINGULAR, naive_lazy_parse(&root, "[] []", 5));
+    EXPECT_EQ_INT(NAIVE_PARSE_INVALID_UNICODE_SURROGATE, naive_lazy_parse(&root, "{\"\\ud800\": 1}", 13));
+    EXPECT_EQ_INT(NAIVE_PARSE_MISS_COLON, naive_lazy_parse(&root, "{\"a\" 1}", 7));
+    EXPECT_EQ_INT(NAIVE_PARSE_INVALID_VALUE, naive_lazy_parse(&root, "[-]", 3));
+    EXPECT_EQ_INT(NAIVE_PARSE_NUMBER_TOO_BIG, naive_lazy_parse(&root, "[1e309]", 7));
+    EXPECT_EQ_INT(NAIVE_PARSE_MISS_COMMA_OR_SQUARE_BRACKET, naive_lazy_parse(&root, "[[1}]", 5));
+
+    /* nothing is built, so the depth is not limited */
+    std::string deep = std::string(NAIVE_PARSE_MAX_DEPTH * 4, '[') + std::string(NAIVE_PARSE_MAX_DEPTH * 4, ']');
+    EXPECT_EQ_INT(NAIVE_PARSE_OK, naive_lazy_parse(&root, deep.data(), deep.size()));
+    EXPECT_EQ_SIZE_T(1, naive_lazy_get_array_size(&root));
+}
+
+static void test_pointer() {
+    /* the example document of RFC 6901 */
+    const char* json = "{\"foo\": [\"bar\", \"baz\"], \"\": 0, \"a/b\": 1, \"c%d\": 2, \"e^f\": 3, \"g|h\": 4,"
+                       " \"i\\\\j\": 5, \"k\\\"l\": 6, \" \": 7, \"m~n\": 8}";
+    const char* pointers[] = {"/foo/0", "/", "/a~1b", "/c%d", "/e^f", "/g|h", "/i\\j", "/k\"l", "/ ", "/m~0n"};
+    const double expects[] = {0, 0, 1, 2, 3, 4, 5, 6, 7, 8};
+    NaivePointer p;
+    NaiveLazyValue root, lv;
+    NaiveValue v, m;
+    naive_init(&v);
+    EXPECT_EQ_INT(NAIVE_PARSE_OK, naive_parse(&v, json));
+    EXPECT_EQ_INT(NAIVE_PARSE_OK, naive_lazy_parse(&root, json, strlen(json)));
+
+    EXPECT_TRUE(naive_pointer_compile(&p, "", 0));
+    EXPECT_EQ_SIZE_T(0, p.count);
+    EXPECT_TRUE(naive_pointer_get(&p, &v) == &v);
+    naive_pointer_free(&p);
+
+    for (size_t i = 0; i < sizeof(pointers) / sizeof(pointers[0]); i++) {
+        EXPECT_TRUE(naive_pointer_compile(&p, pointers[i], strlen(pointers[i])));
+        NaiveValue* found = naive_pointer_get(&p, &v);
+        EXPECT_TRUE(found != nullptr);
+        EXPECT_TRUE(naive_pointer_get(&p, &root, &lv));
+        if (i == 0) {
+            EXPECT_EQ_STRING("bar", naive_get_string(found), naive_get_string_length(found));
+            naive_init(&m);
+            EXPECT_EQ_INT(NAIVE_PARSE_OK, naive_lazy_materialize(&lv, &m));
+            EXPECT_TRUE(naive_is_equal(&m, found));
+            naive_free(&m);
+        } else {
+            EXPECT_EQ_DOUBLE(expects[i], naive_get_number(found));
+            EXPECT_EQ_DOUBLE(expects[i], naive_lazy_get_number(&lv));
+        }
+        naive_pointer_free(&p);
+    }
+
+    /* what does not resolve */
+    const char* missing[] = {"/missing", "/foo/2", "/foo/-", "/foo/01", "/foo/1/x", "/foo/", "/a~1b/0",
+                             "/foo/18446744073709551616"};
+    for (size_t i = 0; i < sizeof(missing) / sizeof(missing[0]); i++) {
+        EXPECT_TRUE(naive_pointer_compile(&p, missing[i], strlen(missing[i])));
+        EXPECT_TRUE(naive_pointer_get(&p, &v) == nullptr);
+        EXPECT_FALSE(naive_pointer_get(&p, &root, &lv));
+        naive_pointer_free(&p);
+    }
+
+    /* malformed pointers do not compile */
+    EXPECT_FALSE(naive_pointer_compile(&p, "foo", 3));
+    EXPECT_FALSE(naive_pointer_compile(&p, "/m~2n", 5));
+    EXPECT_FALSE(naive_pointer_compile(&p, "/m~", 3));
+    naive_free(&v);
+
+    /* one compiled pointer over many documents, through an object with a hash index */
+    EXPECT_TRUE(naive_pointer_compile(&p, "/k40/1", 6));
+    EXPECT_EQ_SIZE_T(2, p.count);
+    EXPECT_EQ_SIZE_T(1, p.tokens[1].index);
+    for (int n = 0; n < 3; n++) {
+        char key[16];
+        naive_init(&v);
+        naive_set_object(&v, 0);
+        for (int i = 0; i < 64; i++) {
+            int keylen = sprintf(key, "k%d", i);
+            NaiveValue* arr = naive_set_object_value(&v, key, keylen);
+            naive_set_array(arr, 2);
+            naive_set_number(naive_pushback_array(arr), i);
+            naive_set_number(naive_pushback_array(arr), i * 10 + n);
+        }
+        NaiveValue* found = naive_pointer_get(&p, &v);
+        EXPECT_TRUE(found != nullptr);
+        EXPECT_EQ_DOUBLE(400.0 + n, naive_get_number(found));
+        naive_free(&v);
+    }
+    naive_pointer_free(&p);
+}
+
+static void write_file(const char* path, const char* content) {
+    FILE* fp = fopen(path, "wb");
+    fputs(content, fp);
+    fclose(fp);
+}
+
+static void test_parse_file() {
+    const char* path = "naivetest.tmp.json";
+    const char* json = " {\"name\":\"naive\\njson\",\"list\":[1,2,3],\"nested\":{\"key\":\"value\"}}\n";
+    NaiveArena arena;
+    NaiveValue v, e;
+    naive_init(&e);
+    EXPECT_EQ_INT(NAIVE_PARSE_OK, naive_parse(&e, json));
+
+    write_file(path, json);
+    naive_init(&v);
+    EXPECT_EQ_INT(NAIVE_PARSE_OK, naive_parse_file(path, &v, 0));
+    EXPECT_TRUE(naive_is_equal(&v, &e));
+    naive_free(&v);
+
+    /* strings point into the mapping, which goes with the arena */
+    naive_arena_init(&arena);
+    EXPECT_EQ_INT(NAIVE_PARSE_OK, naive_parse_file(path, &v, NAIVE_PARSE_KEEP_MAPPING, &arena));
+    EXPECT_TRUE(naive_is_equal(&v, &e));
+    naive_set_string(naive_set_object_value(&v, "added", 5), "x", 1);
+    EXPECT_EQ_SIZE_T(4, naive_get_object_size(&v));
+    naive_free(&v);
+    naive_arena_reset(&arena);
+
+    /* a kept mapping needs an arena to release it */
+    EXPECT_EQ_INT(NAIVE_PARSE_INVALID_ARGUMENT, naive_parse_file(path, &v, NAIVE_PARSE_KEEP_MAPPING));
+    EXPECT_EQ_INT(NAIVE_PARSE_INVALID_ARGUMENT, naive_parse_file(path, &v, NAIVE_PARSE_INSITU, NULL));
+    EXPECT_EQ_INT(NAIVE_PARSE_INVALID_ARGUMENT, naive_parse_file(path, &v, NAIVE_PARSE_RAW));
+    EXPECT_EQ_INT(NAIVE_NULL, naive_get_type(&v));
+
+    write_file(path, "[1,2");
+    EXPECT_EQ_INT(NAIVE_PARSE_MISS_COMMA_OR_SQUARE_BRACKET, naive_parse_file(path, &v, NAIVE_PARSE_KEEP_MAPPING, &arena));
+    write_file(path, "");
+    EXPECT_EQ_INT(NAIVE_PARSE_EXPECT_VALUE, naive_parse_file(path, &v, 0));
+    remove(path);
+    EXPECT_EQ_INT(NAIVE_PARSE_IO_ERROR, naive_parse_file(path, &v, 0));
+    EXPECT_EQ_INT(NAIVE_NULL, naive_get_type(&v));
+    naive_arena_destroy(&arena);
+    naive_free(&e);
+}
+
+static void test_parse_raw() {
+    const char* json = " [\"plain\", \"esc\\u00e9\\n\", 1.50, -0, 12345678901234567890123, 1E2, \"a long string past the inline limit\","
+                       " {\"k\\t\": [\"v\", 0.1e1]}] ";
+    /* strings with escapes are decoded during the parse */
+    const char* canonical = "[\"plain\",\"esc\xC3\xA9\\n\",1.50,-0,12345678901234567890123,1E2,"
+                            "\"a long string past the inline limit\",{\"k\\t\":[\"v\",0.1e1]}]";
+    NaiveArena arena;
+    NaiveValue v, e, c;
+    char* out;
+    size_t length;
+    naive_init(&e);
+    EXPECT_EQ_INT(NAIVE_PARSE_OK, naive_parse(&e, json));
+
+    /* untouched scalars go out exactly as they came in, only the whitespace between tokens is gone */
+    naive_init(&v);
+    EXPECT_EQ_INT(NAIVE_PARSE_OK, naive_parse_raw(&v, json, strlen(json)));
+    out = naive_stringify(&v, &length);
+    EXPECT_TRUE(length == strlen(canonical) && memcmp(out, canonical, length) == 0);
+    free(out);
+    EXPECT_EQ_SIZE_T(strlen(canonical), naive_stringify_size(&v));
+
+    /* getters decode without writing, the value still stringifies as its source text */
+    EXPECT_EQ_DOUBLE(1.5, naive_get_number(naive_get_array_element(&v, 2)));
+    EXPECT_TRUE(naive_is_int64(naive_get_array_element(&v, 3)) == false);
+    EXPECT_EQ_STRING("plain", naive_get_string(naive_get_array_element(&v, 0)),
+                     naive_get_string_length(naive_get_array_element(&v, 0)));
+    EXPECT_EQ_STRING("esc\xC3\xA9\n", naive_get_string(naive_get_array_element(&v, 1)),
+                     naive_get_string_length(naive_get_array_element(&v, 1)));
+    EXPECT_EQ_STRING("a long string past the inline limit", naive_get_string(naive_get_array_element(&v, 6)),
+                     naive_get_string_length(naive_get_array_element(&v, 6)));
+    EXPECT_TRUE(naive_is_int64(naive_get_array_element(&v, 5)) == false);
+    EXPECT_EQ_DOUBLE(100.0, naive_get_number(naive_get_array_element(&v, 5)));
+    EXPECT_TRUE(naive_is_equal(&v, &e));
+    out = naive_stringify(&v, &length);
+    EXPECT_TRUE(length == strlen(canonical) && memcmp(out, canonical, length) == 0);
+    free(out);
+
+    /* materialized values are decoded for good and stringify like any other */
+    NaiveValue* pv = naive_get_array_element(&v, 6);
+    naive_materialize(pv);
+    EXPECT_EQ_STRING("a long string past the inline limit", naive_get_string(pv), naive_get_string_length(pv));
+    EXPECT_EQ_INT('\0', naive_get_string(pv)[naive_get_string_length(pv)]);
+    naive_materialize(naive_get_array_element(&v, 2));
+    naive_materialize(naive_get_array_element(&v, 5));
+    naive_materialize(naive_get_array_element(&v, 5));
+    naive_materialize(&v);
+    out = naive_stringify(&v, &length);
+    const char* touched = "[\"plain\",\"esc\xC3\xA9\\n\",1.5,-0,12345678901234567890123,100,"
+                          "\"a long string past the inline limit\",{\"k\\t\":[\"v\",0.1e1]}]";
+    EXPECT_TRUE(length == strlen(touched) && memcmp(out, touched, length) == 0);
+    free(out);
+    EXPECT_TRUE(naive_is_equal(&v, &e));
+    naive_free(&v);
+
+    /* copies are decoded and outlive the input, setters replace raw values like any other */
+    char* buffer = static_cast<char*>(malloc(strlen(json)));
+    memcpy(buffer, json, strlen(json));
+    EXPECT_EQ_INT(NAIVE_PARSE_OK, naive_parse_raw(&v, buffer, strlen(json)));
+    naive_init(&c);
+    naive_copy(&c, &v);
+    naive_set_number(naive_get_array_element(&v, 0), 2.0);
+    naive_set_string(naive_get_array_element(&v, 6), "x", 1);
+    naive_free(&v);
+    memset(buffer, ' ', strlen(json));
+    free(buffer);
+    EXPECT_TRUE(naive_is_equal(&c, &e));
+    naive_free(&c);
+
+    /* values in an arena decode into it */
+    naive_arena_init(&arena);
+    EXPECT_EQ_INT(NAIVE_PARSE_OK, naive_parse_raw(&v, json, strlen(json), &arena));
+    pv = naive_get_array_element(&v, 6);
+    naive_materialize(pv);
+    EXPECT_EQ_STRING("a long string past the inline limit", naive_get_string(pv), naive_get_string_length(pv));
+    EXPECT_TRUE(naive_is_equal(&v, &e));
+    naive_free(&v);
+    naive_arena_reset(&arena);
+
+    /* files stay mapped for the spans */
+    const char* path = "naivetest.tmp.json";
+    write_file(path, json);
+    EXPECT_EQ_INT(NAIVE_PARSE_OK, naive_parse_file(path, &v, NAIVE_PARSE_RAW, &arena));
+    remove(path);
+    out = naive_stringify(&v, &length);
+    EXPECT_TRUE(length == strlen(canonical) && memcmp(out, canonical, length) == 0);
+    free(out);
+    EXPECT_TRUE(naive_is_equal(&v, &e));
+    naive_arena_destroy(&arena);
+    naive_free(&e);
+
+    /* numbers that may overflow are still checked during the parse */
+    EXPECT_EQ_INT(NAIVE_PARSE_NUMBER_TOO_BIG, naive_parse_raw(&v, "[1e309]", 7));
+    EXPECT_EQ_INT(NAIVE_PARSE_NUMBER_TOO_BIG, naive_parse_raw(&v, "-100e307", 8));
+    EXPECT_EQ_INT(NAIVE_PARSE_OK, naive_parse_raw(&v, "0.001e310", 9));
+    EXPECT_EQ_DOUBLE(1e307, naive_get_number(&v));
+    naive_free(&v);
+}
+
 static void test_parse() {
     test_parse_null();
     test_parse_true();
     test_parse_false();
     test_parse_number();
+    test_parse_integer();
     test_parse_string();
     test_parse_array();
     test_parse_object();
@@ -703,6 +2127,7 @@ static void test_parse() {
     test_parse_invalid_value();
     test_parse_root_not_singular();
     test_parse_number_too_big();
+    test_parse_missing_quotation_mark();
     test_parse_invalid_string_escape();
     test_parse_invalid_string_char();
     test_parse_invalid_unicode_hex();
@@ -711,6 +2136,16 @@ static void test_parse() {
     test_parse_miss_key();
     test_parse_miss_colon();
     test_parse_miss_comma_or_curly_bracket();
+    test_parse_n();
+    test_parse_insitu();
+    test_parse_file();
+    test_parse_raw();
+    test_parse_sax();
+    test_parse_stream();
+    test_parse_too_deep();
+    test_parse_ndjson();
+    test_parse_intern();
+    test_parse_indexed();
 }
 
 static void test_access() {
@@ -720,6 +2155,9 @@ static void test_access() {
     test_access_string();
     test_access_array();
     test_access_object();
+    test_access_object_index();
+    test_lazy();
+    test_pointer();
 }
 
 static void test_stringify() {
@@ -730,6 +2168,7 @@ static void test_stringify() {
     test_stringify_string();
     test_stringify_array();
     test_stringify_object();
+    test_stringify_sink();
 }
 
 int main() {
@@ -749,6 +2188,7 @@ int main() {
     test_move();
     test_swap();
     test_equal();
+    test_arena();
     printf("%d/%d (%3.2f%%) passed\n", test_pass, test_count, test_pass * 100.0 / test_count);
 #ifdef _WINDOWS
     _CrtDumpMemoryLeaks();